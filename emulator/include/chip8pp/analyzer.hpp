@@ -0,0 +1,98 @@
+#pragma once
+#include <chip8pp/instructions.hpp>
+#include <chip8pp/memory.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace chip8pp {
+
+// result of the static analysis of a rom, every address is a cpu address
+struct Analysis {
+	enum class EdgeKind {
+		// next instruction, also the return site of a call
+		Fallthrough,
+		Jump,
+		// instruction after the one skipped by SE/SNE/SKP/SKNP
+		Skip,
+		Call,
+	};
+	struct Edge {
+		std::uint16_t to;
+		EdgeKind kind;
+	};
+	// instructions run in sequence, entered only at start
+	struct Block {
+		std::uint16_t start;
+		// past the last instruction
+		std::uint16_t end;
+		std::vector<Instruction> instructions;
+		std::vector<Edge> successors;
+	};
+	enum class RegionKind {
+		// never reached nor referenced
+		Unknown,
+		Code,
+		// drawn by DRW
+		Sprite,
+		// loaded or stored by FX33/FX55/FX65
+		Data,
+	};
+	// [start, end) rom bytes of the same kind
+	struct Region {
+		std::uint16_t start;
+		std::uint16_t end;
+		RegionKind kind;
+	};
+
+	std::uint16_t origin{0};
+	std::size_t size{0};
+	// sorted by start
+	std::vector<Block> blocks;
+	// subroutines, sorted
+	std::vector<std::uint16_t> callTargets;
+	// targets of LD I, NNN, sorted
+	std::vector<std::uint16_t> references;
+	// cover the whole rom, sorted
+	std::vector<Region> regions;
+
+	// addresses of the instructions that defeat the analysis, sorted
+	// - JP V0, NNN, the targets are not followed
+	std::vector<std::uint16_t> computedJumps;
+	// - FX33/FX55 writing over reachable code
+	std::vector<std::uint16_t> selfModifyingStores;
+	// - FX33/FX55 with an index the analysis could not follow
+	std::vector<std::uint16_t> unknownStores;
+	// - opcodes that do not decode, execution would trap
+	std::vector<std::uint16_t> invalidInstructions;
+	// jump, call or fallthrough targets outside of the rom, sorted
+	std::vector<std::uint16_t> externalTargets;
+
+	// every reachable instruction is known and never written, so the rom can
+	// be translated ahead of time
+	bool isStatic() const;
+	const Block *findBlock(std::uint16_t start) const;
+};
+
+// recover the control flow graph of a rom loaded at origin
+// - follows every path from origin by recursive descent, JP V0, NNN ends a
+//   path
+// - the index register is tracked through the graph to find the sprites and
+//   data the instructions use, a subroutine returns with an unknown index
+// - modifyIndexLoadStore follows CPU::Quirk::ModifyIndexloadStore
+Analysis analyze(std::span<const std::byte> rom,
+                 std::uint16_t origin = Memory::ROM_OFFSET,
+                 bool modifyIndexLoadStore = false);
+
+std::string_view getRegionKindName(Analysis::RegionKind kind);
+std::string_view getEdgeKindName(Analysis::EdgeKind kind);
+
+// the whole analysis as a JSON object, addresses are numbers
+void writeJson(std::ostream &out, Analysis const &analysis);
+// the control flow graph in the graphviz format, a node per block
+void writeDot(std::ostream &out, Analysis const &analysis);
+
+} // namespace chip8pp
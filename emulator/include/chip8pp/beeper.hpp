@@ -0,0 +1,57 @@
+#pragma once
+#include <array>
+#include <chip8pp/cpu.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct SDL_AudioStream;
+
+namespace chip8pp {
+
+// square wave beeper driven by the sound timer, played through an SDL audio
+// stream
+// - while it plays, the beeper is the 60Hz clock of the cpu timers: the
+//   audio callback calls CPU::timerTick every SAMPLES_PER_TICK samples
+// - the tone of a tick period follows the sound timer counted down by that
+//   tick, so the tone starts and stops on a tick boundary, sample accurate,
+//   and lasts as many ticks as the rom sees the timer above 0
+// - held timers (a paused debugger) stop both the countdown and the tone
+// - the cpu never waits for the audio, the timers are lock free
+// - one period of the wave is generated up front, the callback only copies
+//   it, the device buffer is kept small for a low output latency
+class Beeper {
+  public:
+	static constexpr int SAMPLE_RATE = 48000;
+	static constexpr std::size_t SAMPLES_PER_TICK = SAMPLE_RATE / 60;
+	// frames per device buffer, ~5ms at 48kHz
+	static constexpr int DEVICE_FRAMES = 256;
+
+	Beeper(CPU &cpu, float frequency = 440.0f, float volume = 0.2f);
+	~Beeper();
+	Beeper(const Beeper &) = delete;
+	Beeper &operator=(const Beeper &) = delete;
+
+	// open the default playback device, returns false without audio
+	bool init();
+
+  private:
+	static void callback(void *userdata, SDL_AudioStream *stream,
+	                     int additionalAmount, int totalAmount);
+	// audio thread
+	void generate(SDL_AudioStream *stream, std::size_t frames);
+
+	CPU &m_cpu;
+	SDL_AudioStream *m_stream{nullptr};
+	// one period of the square wave
+	std::vector<float> m_period;
+	// audio thread owned
+	// samples left until the next timer tick
+	std::size_t m_untilTick{0};
+	// the current tick period plays the tone
+	bool m_tone{false};
+	std::size_t m_phase{0};
+	std::array<float, DEVICE_FRAMES> m_chunk{};
+};
+
+} // namespace chip8pp
@@ -0,0 +1,98 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chip8pp/cpu.hpp>
+#include <chip8pp/debugger.hpp>
+#include <chip8pp/frameSnapshot.hpp>
+#include <chip8pp/memory.hpp>
+#include <chip8pp/seqLock.hpp>
+#include <chip8pp/stats.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace chip8pp {
+
+// control and telemetry endpoint on a unix domain socket
+// - line protocol, every request gets a single "ok ..." or "error ..." line:
+//     pause | resume | step | status
+//     regs                        (paused) v0..vf, pc, i, sp, dt, st
+//     setreg <v0..vf|pc|i|dt|st> <value>   (paused)
+//     peek <addr> <size>          (paused) hex bytes
+//     poke <addr> <hex bytes>     (paused)
+//     break <addr> | delete <addr>
+//     keys <mask>                 hold the keys of the 16 bit mask
+//     frame                       <width> <height> <frame> <hex rows>
+//                                 (16 digits per 64 pixels of a row)
+//     stream <ms>                 send a "stats ..." line every ms, 0 stops
+// - served by a single poll() thread, the cpu thread is only reached through
+//   the debugger atomics, registers and memory are touched while it is
+//   paused
+// - the debugger control mutex taken by the requests is never taken by the
+//   cpu thread, a breakpoint rebuild scanning memory never stalls it
+// - throws std::runtime_error when the socket cannot be created (and on
+//   platforms without unix sockets)
+class ControlServer {
+  public:
+	ControlServer(std::filesystem::path path, Debugger &debugger, CPU &cpu,
+	              Memory &memory, StatsCounters const &counters,
+	              StatsPublisher const *stats);
+	// stops the server thread and removes the socket
+	~ControlServer();
+	ControlServer(const ControlServer &) = delete;
+	ControlServer &operator=(const ControlServer &) = delete;
+
+	// main thread: keys held by the clients, applied to the keypad every
+	// frame
+	std::uint16_t getInjectedKeys() const;
+	// main thread: publish the presented frame for the frame command, rows
+	// are packed as in Grid
+	void publishFrame(std::span<const std::uint64_t> rows,
+	                  std::size_t wordsPerRow, std::size_t width,
+	                  std::size_t height);
+
+  private:
+	struct Client {
+		int fd{-1};
+		std::string input;
+		std::string output;
+		std::chrono::milliseconds streamInterval{0};
+		std::chrono::steady_clock::time_point nextStream;
+	};
+
+	void serve(std::stop_token stop_token);
+	void acceptClients();
+	// returns false when the client disconnected
+	bool readClient(Client &client);
+	bool writeClient(Client &client);
+	std::string handle(Client &client, std::string const &line);
+	std::string formatRegisters();
+	std::string formatStats();
+	std::string formatFrame();
+	void wake();
+
+	std::filesystem::path m_path;
+	Debugger &m_debugger;
+	CPU &m_cpu;
+	Memory &m_memory;
+	StatsCounters const &m_counters;
+	StatsPublisher const *m_stats;
+	int m_listenFd{-1};
+	// written to interrupt poll() on shutdown
+	std::array<int, 2> m_wakePipe{-1, -1};
+	std::vector<Client> m_clients;
+	std::atomic<std::uint16_t> m_injectedKeys{0};
+	// written by the main thread
+	SeqLock<FrameSnapshot> m_frame;
+	std::uint64_t m_framesPublished{0};
+	// server thread owned, last consistent copy of m_frame
+	FrameSnapshot m_lastFrame;
+	std::jthread m_thread;
+};
+
+} // namespace chip8pp
@@ -1,14 +1,31 @@
 #pragma once
 #include <array>
+#include <atomic>
 #include <chip8pp/instructions.hpp>
 #include <chip8pp/keypad.hpp>
 #include <chip8pp/memory.hpp>
+#include <chip8pp/trap.hpp>
 #include <cstddef>
 #include <cstdint>
 #include <libcanvas/screen.hpp>
+#include <optional>
+#include <random>
+#include <string_view>
 namespace chip8pp {
 
-struct CPU {
+template <typename MemoryT> struct BasicCPU;
+class Debugger;
+
+template <typename MemoryT>
+using BasicInstructionCallback = Trap (*)(Instruction instruction,
+                                          BasicCPU<MemoryT> &cpu,
+                                          MemoryT &memory, Screen &screen,
+                                          Keypad &keypad);
+
+// registers, timers and settings of a cpu, the same for every address space
+struct CPUState {
+	CPUState();
+
 	// contains the list of supported quirks
 	enum class Quirk {
 		// Enables the change of the index register when using Load/Store
@@ -20,41 +37,100 @@ struct CPU {
 
 	// list of quirks
 	std::array<bool, static_cast<std::size_t>(Quirk::COUNT)> quirks = {false};
+	// names used on the command line, e.g. "modify-index"
+	static std::string_view getQuirkName(Quirk quirk);
+	static std::optional<Quirk> parseQuirk(std::string_view name);
 	static constexpr std::size_t STACK_SIZE = 16;
+	// screen of the CHIP-8 mode and of the SUPER-CHIP hi-res mode
+	static constexpr std::size_t SCREEN_WIDTH = 64;
+	static constexpr std::size_t SCREEN_HEIGHT = 32;
+	static constexpr std::size_t HIRES_WIDTH = 128;
+	static constexpr std::size_t HIRES_HEIGHT = 64;
+	// what to do when an instruction raises a trap, indexed by Trap
+	TrapPolicies trap_policies = defaultTrapPolicies();
 	// program counter (2 bytes)
 	std::uint16_t pc{0x200};
+	// address of the instruction being executed, set by fetch
+	std::uint16_t instruction_pc{0x200};
 	// index register (2 bytes)
 	std::uint16_t index{0x000};
 	// timers function
-	void timerTick();
+	// - count both timers down once, returns the sound timer before the tick
+	//   (0 while the timers are held)
+	// - lock free, the beeper ticks them from the audio thread
+	std::uint8_t timerTick();
 	std::byte getDelayTimer();
 	std::byte getSoundTimer();
 	void setDelayTimer(std::byte value);
 	void setSoundTimer(std::byte value);
+	// the sound timer (bits 0-7) and the number of writes and ticks that
+	// changed it (bits 8-31)
+	std::atomic<std::uint32_t> sound_state{0};
+	// the timers do not count down while set, e.g. while the debugger is
+	// paused
+	std::atomic<bool> timers_held{false};
 
 	// stack
-	std::array<std::uint16_t, STACK_SIZE> stack;
+	std::array<std::uint16_t, STACK_SIZE> stack{};
 	// stack pointer
 	std::size_t sp{0};
 	// registers [V0, V1, ..., VF]
-	std::array<std::byte, 16> registers;
+	std::array<std::byte, 16> registers{};
+	// SUPER-CHIP user flags, saved and restored by FX75 and FX85
+	std::array<std::byte, 16> rpl_flags{};
+	// last raised trap, with the address and opcode of the instruction that
+	// raised it
+	Trap trap{Trap::None};
+	std::uint16_t trap_pc{0x000};
+	std::uint16_t trap_opcode{0x0000};
+	// source of RND, seeded from std::random_device unless seedRandom is
+	// called
+	std::mt19937 rng;
+	void seedRandom(std::uint32_t seed);
 
-	std::uint16_t fetch(Memory &memory);
-	Instruction decode(std::uint16_t opcode);
-	bool execute(Instruction instruction, Memory &memory, Screen &screen,
-	             Keypad &keypad);
+	static Instruction decode(std::uint16_t opcode);
+	TrapPolicy getTrapPolicy(Trap raised) const {
+		return trap_policies[static_cast<std::size_t>(raised)];
+	}
+
+	// debugger attached to this cpu, used by the intercepting handlers
+	Debugger *debugger{nullptr};
 
   private:
-	// timers - need to be thread safe
-	std::byte delay_timer{0x00};
-	std::byte sound_timer{0x00};
-	// timers mutex
-	std::mutex timers_mutex;
+	// the sound timer is kept in sound_state
+	std::atomic<std::uint8_t> delay_timer{0x00};
+};
+
+// cpu running in the address space of MemoryT
+// - the program counter wraps with MemoryT::ADDRESS_MASK, a compile time
+//   constant, so the 4 KiB cpu pays nothing for the 64 KiB one
+template <typename MemoryT> struct BasicCPU : CPUState {
+	BasicCPU();
+
+	std::uint16_t fetch(MemoryT &memory);
+	// returns Trap::None, or the trap raised by the instruction (also stored
+	// in the trap fields)
+	Trap execute(Instruction instruction, MemoryT &memory, Screen &screen,
+	             Keypad &keypad);
+
+	// handlers used by execute, indexed by InstructionEnum
+	// - a copy of getInstructionList() unless a debugger swapped some entries
+	//   to intercept those instructions, so the debugger costs nothing while
+	//   no breakpoint is set
+	std::array<std::atomic<BasicInstructionCallback<MemoryT>>,
+	           static_cast<std::size_t>(InstructionEnum::COUNT)>
+	    dispatch;
+	// restore the default handlers
+	void resetDispatch();
 };
 
-using InstructionCallback = void (*)(Instruction instruction, CPU &cpu,
-                                     Memory &memory, Screen &screen,
-                                     Keypad &keypad);
+// the CHIP-8 and SUPER-CHIP cpu, used by the debugger and the tools
+using CPU = BasicCPU<Memory>;
+using InstructionCallback = BasicInstructionCallback<Memory>;
+// XO-CHIP cpu, F000 NNNN loads 16 bit addresses
+using XoChipCPU = BasicCPU<XoChipMemory>;
 
-std::span<InstructionCallback> getInstructionList();
+// handlers of the address space of MemoryT, indexed by InstructionEnum
+template <typename MemoryT = Memory>
+std::span<BasicInstructionCallback<MemoryT>> getInstructionList();
 } // namespace chip8pp
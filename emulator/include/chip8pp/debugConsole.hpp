@@ -0,0 +1,35 @@
+#pragma once
+#include <chip8pp/cpu.hpp>
+#include <chip8pp/debugger.hpp>
+#include <chip8pp/memory.hpp>
+#include <ostream>
+#include <stop_token>
+#include <string_view>
+
+namespace chip8pp {
+
+// line based command interpreter for the debugger
+// - registers and memory are only shown while the cpu is paused, the cpu
+//   thread owns them otherwise
+class DebugConsole {
+  public:
+	DebugConsole(Debugger &debugger, CPU &cpu, Memory &memory);
+
+	// run a single command, the output is written to out
+	void execute(std::string_view line, std::ostream &out);
+	// read commands from the standard input until stop is requested
+	void run(std::stop_token stop_token);
+
+  private:
+	void printRegisters(std::ostream &out);
+	void printMemory(std::uint16_t address, std::size_t size,
+	                 std::ostream &out);
+	void printListing(std::uint16_t address, std::size_t count,
+	                  std::ostream &out);
+
+	Debugger &m_debugger;
+	CPU &m_cpu;
+	Memory &m_memory;
+};
+
+} // namespace chip8pp
@@ -0,0 +1,150 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chip8pp/cpu.hpp>
+#include <chip8pp/instructions.hpp>
+#include <chip8pp/keypad.hpp>
+#include <chip8pp/memory.hpp>
+#include <chip8pp/trap.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <vector>
+
+namespace chip8pp {
+
+// interactive debugger: pause, single step, pc breakpoints, memory
+// watchpoints and register conditions
+// - nothing is checked in the fetch/execute loop, instead the debugger swaps
+//   the CPU::dispatch entries of the instructions it needs to see with an
+//   intercepting handler:
+//   - pause/step: every instruction
+//   - breakpoints: the instruction kinds found at the breakpoint addresses
+//     (and the store instructions, to notice when the code is overwritten:
+//     the cpu then also intercepts the instruction kind written there)
+//   - watchpoints: the store instructions (LD B, VX and LD [I], VX are the
+//     only callers of Memory::set_byte)
+//   - register conditions: every instruction
+// - without any of them the dispatch table is the default one
+// - control methods may be called from any thread, they are serialized by a
+//   mutex the cpu thread never takes: the intercepting handlers and the stop
+//   path only use atomics, the stop reason is formatted by its reader
+class Debugger {
+  public:
+	Debugger(CPU &cpu, Memory &memory);
+	// restores the default dispatch table
+	~Debugger();
+	Debugger(const Debugger &) = delete;
+	Debugger &operator=(const Debugger &) = delete;
+
+	// stop before the next instruction
+	void pause();
+	void resume();
+	// execute a single instruction and stop again
+	void step();
+	bool isPaused() const;
+
+	void addBreakpoint(std::uint16_t address);
+	void removeBreakpoint(std::uint16_t address);
+	std::vector<std::uint16_t> getBreakpoints() const;
+	// stop after a store into [begin, end]
+	void addWatchpoint(std::uint16_t begin, std::uint16_t end);
+	void clearWatchpoints();
+	// stop when the register becomes equal to value
+	void addRegisterCondition(std::uint8_t reg, std::uint8_t value);
+	void clearRegisterConditions();
+
+	// re-decode the breakpoint addresses after memory was written while
+	// paused
+	void codeChanged();
+
+	// why the cpu stopped the last time
+	std::string getStopReason() const;
+
+	// cpu thread: called when execute returned Trap::Breakpoint, blocks
+	// while the debugger is paused, returns false when stop was requested
+	bool waitWhilePaused(std::stop_token stop_token);
+	// cpu thread: the cpu stopped in front of an instruction, the pc points
+	// at it again and it must run through executeResumed
+	bool hasPendingInstruction() const { return m_pendingInstruction; }
+	// cpu thread: execute the instruction the cpu stopped in front of, as
+	// CPU::execute does but without intercepting it again
+	Trap executeResumed(Instruction instruction, Screen &screen,
+	                    Keypad &keypad);
+
+  private:
+	static constexpr std::size_t ADDRESSES = Memory::RAM_SIZE;
+	using Bitmap = std::array<std::atomic<std::uint64_t>, ADDRESSES / 64>;
+
+	// the intercepting handler installed in CPU::dispatch
+	static Trap intercept(Instruction instruction, CPU &cpu, Memory &memory,
+	                      Screen &screen, Keypad &keypad);
+	Trap check(Instruction instruction, Memory &memory, Screen &screen,
+	           Keypad &keypad);
+	// why the cpu stopped, packed in a single atomic by the cpu thread
+	enum class StopKind : std::uint8_t {
+		None,
+		// pause or step, at address
+		Stopped,
+		// breakpoint at address
+		Breakpoint,
+		// store into [first, second] by the instruction at address
+		Watchpoint,
+		// register first became equal to second after address
+		Condition,
+	};
+	static std::uint64_t packStop(StopKind kind, std::uint16_t address,
+	                              std::uint16_t first = 0,
+	                              std::uint16_t second = 0);
+	// stop in front of the current instruction
+	Trap stopBefore(std::uint64_t reason);
+	// stop after the current instruction
+	Trap stopAfter(std::uint64_t reason);
+	// recompute which dispatch entries are intercepted, control side
+	void rebuildDispatch();
+	// intercept the kinds now held by the breakpoints overlapping
+	// [begin, end], only widens the table so the cpu never races a rebuild
+	void interceptBreakpoints(std::uint16_t begin, std::uint16_t end);
+
+	static bool test(const Bitmap &bitmap, std::uint16_t address);
+	static void assign(Bitmap &bitmap, std::uint16_t address, bool value);
+	bool anyWatched(std::uint16_t begin, std::uint16_t end) const;
+	// a breakpointed opcode overlaps [begin, end]
+	bool anyBreakpoint(std::uint16_t begin, std::uint16_t end) const;
+
+	CPU &m_cpu;
+	Memory &m_memory;
+	std::atomic<bool> m_paused{false};
+	// intercept every instruction (pause and step)
+	std::atomic<bool> m_stopAll{false};
+	// stop again after the instruction that is resumed
+	std::atomic<bool> m_stepping{false};
+	// woken on resume
+	std::atomic<std::uint32_t> m_wake{0};
+	Bitmap m_breakpoints{};
+	Bitmap m_watchpoints{};
+	// expected value per register, -1 when unused
+	std::array<std::atomic<std::int16_t>, 16> m_conditions;
+
+	// cpu thread state
+	// the cpu stopped in front of an instruction that still has to run
+	bool m_pendingInstruction{false};
+	// registers that matched their condition after the last instruction
+	std::array<bool, 16> m_conditionMatched{};
+
+	// a store changed the code under a breakpoint since the last rebuild
+	std::atomic<bool> m_codeOverwritten{false};
+	// packStop of the last stop, written before m_paused
+	std::atomic<std::uint64_t> m_stopReason{0};
+
+	// serializes the control methods, never taken by the cpu thread
+	mutable std::mutex m_controlMutex;
+	std::size_t m_breakpointCount{0};
+	std::size_t m_watchpointCount{0};
+	std::size_t m_conditionCount{0};
+};
+
+} // namespace chip8pp
@@ -0,0 +1,9 @@
+#pragma once
+#include <chip8pp/instructions.hpp>
+#include <string>
+
+namespace chip8pp {
+// format an instruction using the usual CHIP-8 assembly syntax
+// e.g. "LD V1, 0x05" or "DRW V0, V1, 5"
+std::string disassemble(const Instruction &instruction);
+} // namespace chip8pp
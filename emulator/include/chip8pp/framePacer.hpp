@@ -0,0 +1,61 @@
+#pragma once
+#include <chip8pp/histogram.hpp>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace chip8pp {
+
+// paces the presentation loop on a fixed frame period
+// - every deadline is derived from the previous one, so no error builds up,
+//   a loop that falls a whole period behind skips the missed deadlines
+// - with vsync the present blocks until the vertical blank, the deadlines
+//   are realigned on every present to a little before the next blank so the
+//   newest frame is picked up just in time
+// - the loop sleeps (or waits for input) for getSleepTime and finishWait
+//   spins the last part, sleeps are not precise enough to hit the deadline
+// - records the interval between presents in a row and the age of the
+//   presented frames, the time since the emulation published them
+// - unchanged frames are not presented, they are neither misses nor part of
+//   the intervals
+class FramePacer {
+  public:
+	using clock = std::chrono::steady_clock;
+
+	FramePacer(clock::duration period, bool vsync);
+
+	clock::time_point getDeadline() const;
+	// part of the wait for the deadline that can be slept, 0 when it is too
+	// close
+	clock::duration getSleepTime(clock::time_point now) const;
+	// spin until the deadline
+	void finishWait();
+	// the frame was handled at time now, presented tells whether it reached
+	// the screen and published when the emulation drew it
+	void frameDone(bool presented, clock::time_point published,
+	               clock::time_point now);
+
+	clock::duration getPeriod() const;
+	bool hasVSync() const;
+	Histogram const &getPresentInterval() const;
+	Histogram const &getFrameAge() const;
+	// periods by which new frames missed their deadline
+	std::uint64_t getMissedFrames() const;
+	// human readable report of the histograms
+	std::string summary() const;
+
+  private:
+	clock::duration m_period;
+	bool m_vsync;
+	clock::time_point m_deadline;
+	// reset by a frame that was not presented
+	std::optional<clock::time_point> m_lastPresent;
+	// publish time of the last new frame presented
+	clock::time_point m_lastPublished;
+	Histogram m_presentInterval;
+	Histogram m_frameAge;
+	std::uint64_t m_missedFrames{0};
+};
+
+} // namespace chip8pp
@@ -0,0 +1,63 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <libcanvas/palette.hpp>
+#include <span>
+
+namespace chip8pp {
+
+// fixed size copy of a presented frame, the layout shared by the framebuffer
+// export, the frame stream and the control server
+// - rows are packed as in Grid: wordsPerRow words per row, bit 63 of the
+//   first word is the leftmost pixel
+// - trivially copyable, it is stored in shared memory, queues and seqlocks
+struct FrameSnapshot {
+	// SUPER-CHIP hi-res
+	static constexpr std::size_t MAX_WIDTH = 128;
+	static constexpr std::size_t MAX_HEIGHT = 64;
+	static constexpr std::size_t MAX_WORDS =
+	    MAX_HEIGHT * ((MAX_WIDTH + 63) / 64);
+	// frames published, 0 before the first one
+	std::uint64_t frame{0};
+	// steady clock time of the present
+	std::uint64_t timeNs{0};
+	std::uint32_t width{0};
+	std::uint32_t height{0};
+	std::uint32_t wordsPerRow{0};
+	// palette colours of the clear and set pixels
+	pixelRGBA_t off{0};
+	pixelRGBA_t on{0};
+	std::array<std::uint64_t, MAX_WORDS> rows{};
+
+	static bool fits(std::size_t width, std::size_t height) {
+		return width <= MAX_WIDTH && height <= MAX_HEIGHT;
+	}
+
+	// copy a frame of sourceWidth x sourceHeight pixels with
+	// sourceWordsPerRow words per row, the pixels past MAX_WIDTH x
+	// MAX_HEIGHT are dropped
+	void setRows(std::span<const std::uint64_t> source,
+	             std::size_t sourceWordsPerRow, std::size_t sourceWidth,
+	             std::size_t sourceHeight) {
+		width = (std::uint32_t)std::min(sourceWidth, MAX_WIDTH);
+		height = (std::uint32_t)std::min(sourceHeight, MAX_HEIGHT);
+		wordsPerRow = (width + 63) / 64;
+		std::size_t words = (std::size_t)wordsPerRow * height;
+		if (wordsPerRow == sourceWordsPerRow && words <= source.size()) {
+			// same stride, a single copy
+			std::copy(source.begin(), source.begin() + words, rows.begin());
+			return;
+		}
+		for (std::size_t y = 0; y < height; y++) {
+			for (std::size_t i = 0; i < wordsPerRow; i++) {
+				std::size_t index = y * sourceWordsPerRow + i;
+				rows[y * wordsPerRow + i] =
+				    index < source.size() ? source[index] : 0;
+			}
+		}
+	}
+};
+
+} // namespace chip8pp
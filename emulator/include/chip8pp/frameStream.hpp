@@ -0,0 +1,112 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chip8pp/frameSnapshot.hpp>
+#include <chip8pp/spscQueue.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <libcanvas/grid.hpp>
+#include <thread>
+#include <vector>
+
+namespace chip8pp {
+
+// header of a frame stream, the frame records follow it until the end of the
+// file:
+//   u8      kind, FrameKind
+//   varint  microseconds since the previous frame (LEB128)
+//   keyframe: u16 width, u16 height, then every row
+//   delta:    ceil(height / 8) bytes of changed row mask (bit j % 8 of byte
+//             j / 8 is row j), then the XOR with the previous frame of every
+//             changed row
+// rows are wordsPerRow native endian 64 bit words packed as in Grid, deltas
+// keep the size of the last keyframe
+struct FrameStreamHeader {
+	static constexpr std::array<char, 4> MAGIC{'C', '8', 'F', 'S'};
+	static constexpr std::uint16_t VERSION = 1;
+	std::array<char, 4> magic{MAGIC};
+	std::uint16_t version{VERSION};
+	// frames between two keyframes
+	std::uint16_t keyframeInterval{0};
+};
+static_assert(sizeof(FrameStreamHeader) == 8);
+
+enum class FrameKind : std::uint8_t {
+	Keyframe = 1,
+	Delta = 2,
+};
+
+// records the presented frames as a delta encoded stream
+// - the main thread copies every presented frame into a lock-free queue and
+//   never waits for the file (or pipe), frames are dropped when it is full
+// - a background thread encodes each frame against the previous encoded one,
+//   so a dropped frame never corrupts the stream
+// - identical frames are skipped, a keyframe is written every
+//   keyframeInterval frames and whenever the resolution changes
+class FrameStreamWriter {
+  public:
+	FrameStreamWriter(std::filesystem::path const &path,
+	                  std::uint16_t keyframeInterval = 600,
+	                  std::size_t queueFrames = 64);
+	// encodes the pending frames and flushes the file
+	~FrameStreamWriter();
+
+	// main thread only, returns false when the frame was dropped
+	bool push(Grid::FrameView const &frame,
+	          std::chrono::steady_clock::time_point time);
+	std::uint64_t getDropped() const;
+
+  private:
+	void writer_thread_fn(std::stop_token stop_token);
+	void drain();
+	void encode(FrameSnapshot const &frame);
+
+	SpscQueue<FrameSnapshot> m_queue;
+	std::atomic<std::uint64_t> m_dropped{0};
+	std::ofstream m_file;
+	FrameStreamHeader m_header;
+	// encoder thread owned
+	FrameSnapshot m_previous;
+	bool m_hasPrevious{false};
+	std::uint64_t m_sinceKeyframe{0};
+	std::vector<char> m_encoded;
+	std::jthread m_thread;
+};
+
+// decodes a frame stream written by FrameStreamWriter
+// - throws std::runtime_error when the file is not a frame stream or is
+//   corrupted
+class FrameStreamReader {
+  public:
+	struct Frame {
+		// time since the first frame
+		std::uint64_t timeNs{0};
+		bool keyframe{false};
+		std::size_t width{0};
+		std::size_t height{0};
+		std::size_t wordsPerRow{0};
+		std::vector<std::uint64_t> rows;
+	};
+
+	explicit FrameStreamReader(std::filesystem::path const &path);
+
+	FrameStreamHeader const &getHeader() const;
+	// decode the next frame, returns false at the end of the stream
+	bool next();
+	Frame const &getFrame() const;
+
+  private:
+	std::uint64_t readVarint();
+	template <typename T>
+	T read();
+
+	std::ifstream m_file;
+	FrameStreamHeader m_header;
+	Frame m_frame;
+	bool m_started{false};
+};
+
+} // namespace chip8pp
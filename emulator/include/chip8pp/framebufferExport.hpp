@@ -0,0 +1,51 @@
+#pragma once
+#include <array>
+#include <chip8pp/frameSnapshot.hpp>
+#include <chip8pp/seqLock.hpp>
+#include <chip8pp/sharedMemory.hpp>
+#include <chrono>
+#include <cstdint>
+#include <libcanvas/grid.hpp>
+#include <libcanvas/palette.hpp>
+
+namespace chip8pp {
+
+// layout of the shared memory framebuffer page, the frame is protected by a
+// seqlock
+// - readers map the page once and read the frame in place, no syscall is
+//   needed per frame, frame.sequence moves with every published frame
+struct FramebufferPage {
+	static constexpr std::array<char, 4> MAGIC{'C', '8', 'F', 'B'};
+	static constexpr std::uint32_t VERSION = 3;
+	std::array<char, 4> magic{MAGIC};
+	std::uint32_t version{VERSION};
+	std::uint32_t pid{0};
+	alignas(64) SeqLock<FrameSnapshot> frame;
+};
+
+// shared memory segments are named <FRAMEBUFFER_PREFIX><pid>
+inline constexpr const char *FRAMEBUFFER_PREFIX = "chip8pp-fb-";
+
+// exports the presented frames of the current process
+// - single writer: publish is called by the thread presenting the frames
+// - throws std::runtime_error when the segment cannot be created
+class FramebufferExport {
+  public:
+	FramebufferExport();
+
+	void publish(Grid::FrameView const &frame, Palette palette,
+	             std::chrono::steady_clock::time_point time);
+
+	FramebufferPage const &getPage() const;
+
+  private:
+	SharedMemory m_memory;
+	FramebufferPage *m_page;
+	std::uint64_t m_frames{0};
+};
+
+// read a consistent copy of the frame, returns false if the writer kept
+// writing during every attempt
+bool readFramebufferPage(FramebufferPage const &page, FrameSnapshot &frame);
+
+} // namespace chip8pp
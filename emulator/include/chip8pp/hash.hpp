@@ -0,0 +1,80 @@
+#pragma once
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace chip8pp {
+
+// XXH64 of the bytes, matches the reference xxHash implementation on little
+// endian hosts
+// - about a byte per cycle, fast enough to hash every frame of a test run
+inline std::uint64_t xxh64(const void *data, std::size_t size,
+                           std::uint64_t seed = 0) {
+	constexpr std::uint64_t P1 = 0x9E3779B185EBCA87ULL;
+	constexpr std::uint64_t P2 = 0xC2B2AE3D27D4EB4FULL;
+	constexpr std::uint64_t P3 = 0x165667B19E3779F9ULL;
+	constexpr std::uint64_t P4 = 0x85EBCA77C2B2AE63ULL;
+	constexpr std::uint64_t P5 = 0x27D4EB2F165667C5ULL;
+	auto read64 = [](const unsigned char *p) {
+		std::uint64_t value;
+		std::memcpy(&value, p, sizeof(value));
+		return value;
+	};
+	auto read32 = [](const unsigned char *p) {
+		std::uint32_t value;
+		std::memcpy(&value, p, sizeof(value));
+		return value;
+	};
+	auto round = [](std::uint64_t acc, std::uint64_t input) {
+		return std::rotl(acc + input * P2, 31) * P1;
+	};
+	auto merge = [&](std::uint64_t acc, std::uint64_t value) {
+		return (acc ^ round(0, value)) * P1 + P4;
+	};
+
+	auto p = static_cast<const unsigned char *>(data);
+	const unsigned char *end = p + size;
+	std::uint64_t hash;
+	if (size >= 32) {
+		std::uint64_t v1 = seed + P1 + P2;
+		std::uint64_t v2 = seed + P2;
+		std::uint64_t v3 = seed;
+		std::uint64_t v4 = seed - P1;
+		// 32 byte stripes in 4 independent lanes
+		for (; p + 32 <= end; p += 32) {
+			v1 = round(v1, read64(p));
+			v2 = round(v2, read64(p + 8));
+			v3 = round(v3, read64(p + 16));
+			v4 = round(v4, read64(p + 24));
+		}
+		hash = std::rotl(v1, 1) + std::rotl(v2, 7) + std::rotl(v3, 12) +
+		       std::rotl(v4, 18);
+		hash = merge(hash, v1);
+		hash = merge(hash, v2);
+		hash = merge(hash, v3);
+		hash = merge(hash, v4);
+	} else {
+		hash = seed + P5;
+	}
+	hash += size;
+	for (; p + 8 <= end; p += 8) {
+		hash = std::rotl(hash ^ round(0, read64(p)), 27) * P1 + P4;
+	}
+	if (p + 4 <= end) {
+		hash = std::rotl(hash ^ (read32(p) * P1), 23) * P2 + P3;
+		p += 4;
+	}
+	for (; p < end; p++) {
+		hash = std::rotl(hash ^ (*p * P5), 11) * P1;
+	}
+	// avalanche
+	hash ^= hash >> 33;
+	hash *= P2;
+	hash ^= hash >> 29;
+	hash *= P3;
+	hash ^= hash >> 32;
+	return hash;
+}
+
+} // namespace chip8pp
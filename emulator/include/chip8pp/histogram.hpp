@@ -0,0 +1,76 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace chip8pp {
+
+// fixed size log-linear histogram of durations
+// - each power of two of microseconds is split in 4 linear sub-buckets, so
+//   the relative error of a bucket is at most 25%
+// - 64 buckets cover 0 us to ~131 ms, the last one starts at ~115 ms and
+//   also counts every longer duration
+// - plain data, can be copied into shared memory as is
+struct Histogram {
+	static constexpr std::size_t SUB_BUCKETS = 4;
+	static constexpr std::size_t BUCKETS = 64;
+
+	std::array<std::uint64_t, BUCKETS> buckets{};
+	std::uint64_t count{0};
+	std::uint64_t totalNs{0};
+	std::uint64_t maxNs{0};
+
+	static constexpr std::size_t bucketOf(std::uint64_t us) {
+		if (us < SUB_BUCKETS) {
+			return (std::size_t)us;
+		}
+		// position of the highest set bit and the 2 bits after it
+		std::size_t octave = std::bit_width(us) - 1;
+		std::size_t sub = (us >> (octave - 2)) & (SUB_BUCKETS - 1);
+		std::size_t bucket = (octave - 1) * SUB_BUCKETS + sub;
+		return bucket < BUCKETS ? bucket : BUCKETS - 1;
+	}
+
+	// smallest duration in microseconds counted by the bucket
+	static constexpr std::uint64_t bucketLowerBound(std::size_t bucket) {
+		if (bucket < SUB_BUCKETS) {
+			return bucket;
+		}
+		std::size_t octave = bucket / SUB_BUCKETS + 1;
+		std::uint64_t sub = bucket % SUB_BUCKETS;
+		return (std::uint64_t(1) << octave) + (sub << (octave - 2));
+	}
+
+	void record(std::chrono::nanoseconds duration) {
+		auto ns = (std::uint64_t)std::max<std::int64_t>(duration.count(), 0);
+		buckets[bucketOf(ns / 1000)]++;
+		count++;
+		totalNs += ns;
+		maxNs = ns > maxNs ? ns : maxNs;
+	}
+
+	// approximate percentile (0-100) in microseconds
+	std::uint64_t percentile(double percent) const {
+		if (count == 0) {
+			return 0;
+		}
+		auto target = (std::uint64_t)((double)count * percent / 100.0);
+		std::uint64_t seen = 0;
+		for (std::size_t i = 0; i < BUCKETS; i++) {
+			seen += buckets[i];
+			if (seen > target) {
+				return bucketLowerBound(i);
+			}
+		}
+		return bucketLowerBound(BUCKETS - 1);
+	}
+
+	std::uint64_t meanNs() const { return count == 0 ? 0 : totalNs / count; }
+};
+static_assert(Histogram::bucketLowerBound(Histogram::BUCKETS - 1) == 114688);
+static_assert(Histogram::bucketOf(131071) == Histogram::BUCKETS - 1);
+
+} // namespace chip8pp
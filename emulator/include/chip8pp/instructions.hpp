@@ -2,6 +2,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <span>
+#include <string_view>
 
 namespace chip8pp {
 
@@ -32,7 +33,7 @@ enum class InstructionEnum : std::uint16_t {
 	LD_I_NNN,    // 0xANNN - Set I to NNN
 	JMP_V0_NNN,  // 0xBNNN - Jump to NNN + V0
 	RND_VX_NN,   // 0xCXNN - Set VX to random byte & NN
-	DRW_VX_VY_N, // 0xDXYN - Display N-byte sprite at (VX, VY)
+	DRW_VX_VY_N, // 0xDXYN - Display N-byte sprite at (VX, VY), 16x16 if N = 0
 	SKP_VX,      // 0xEX9E - Skip next instruction if key VX is pressed
 	SKNP_VX,     // 0xEXA1 - Skip next instruction if key VX is not pressed
 	LD_VX_DT,    // 0xFX07 - Set VX to delay timer
@@ -44,6 +45,18 @@ enum class InstructionEnum : std::uint16_t {
 	LD_B_VX,     // 0xFX33 - Store BCD representation of VX in I, I+1, I+2
 	LD_I_VX,     // 0xFX55 - Store registers V0-VX in memory starting at I
 	LD_VX_I,     // 0xFX65 - Read registers V0-VX from memory starting at I
+	// === SUPER-CHIP instructions === //
+	SCD_N,       // 0x00CN - Scroll the display down N pixels
+	SCR,         // 0x00FB - Scroll the display right 4 pixels
+	SCL,         // 0x00FC - Scroll the display left 4 pixels
+	EXIT,        // 0x00FD - Exit the interpreter
+	LOW,         // 0x00FE - Switch to the 64x32 mode
+	HIGH,        // 0x00FF - Switch to the 128x64 mode
+	LD_HF_VX,    // 0xFX30 - Set I to location of hi-res sprite for digit VX
+	LD_R_VX,     // 0xFX75 - Store registers V0-VX in the RPL flags
+	LD_VX_R,     // 0xFX85 - Read registers V0-VX from the RPL flags
+	// === XO-CHIP instructions === //
+	LD_I_LONG,   // 0xF000 NNNN - Set I to the 16 bit NNNN
 	// used only for counting the number of instructions
 	COUNT
 };
@@ -63,6 +76,8 @@ struct Instruction {
 	std::uint16_t nnn;
 
 	static InstructionEnum decodeOpCode(std::uint16_t opcode);
+	// returns the enum name of the instruction (e.g. "LD_VX_NN")
+	static std::string_view getName(InstructionEnum instruction);
 };
 
 } // namespace chip8pp
@@ -1,8 +1,25 @@
 #pragma once
 #include <array>
+#include <atomic>
+#include <chip8pp/spscQueue.hpp>
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <optional>
+#include <span>
 
 namespace chip8pp {
+
+// hex keypad shared by the input thread and the cpu thread
+// - the state is a single 16 bit mask, bit n is Key n, updated atomically by
+//   press/release so it is visible to the cpu without any lock
+// - a key pressed and released before the cpu read it is latched, the next
+//   is_pressed of that key still reports it once
+// - a latch expires at the second expireTaps after the press, so a tap on a
+//   key the rom does not poll is not reported much later
+// - every event is also queued with its timestamp, the cpu thread drains the
+//   queue when it reads the keypad and measures the time between a press and
+//   the first read of that key, see consumeReadLatencies
 class Keypad {
   public:
 	enum class Key {
@@ -29,14 +46,66 @@ class Keypad {
 		COUNT
 	};
 
-	bool is_pressed(Key key) const;
-	void press(Key key);
-	void release(Key key);
-	void set(Key key, bool pressed);
+	using clock = std::chrono::steady_clock;
+
+	struct Event {
+		clock::time_point time;
+		Key key;
+		bool pressed;
+	};
+
+	explicit Keypad(std::size_t eventCapacity = 256);
+	Keypad(const Keypad &) = delete;
+	Keypad &operator=(const Keypad &) = delete;
+
+	// cpu thread
+	bool is_pressed(Key key);
+
+	// input thread, time is when the event happened
+	void press(Key key, clock::time_point time = clock::now());
+	void release(Key key, clock::time_point time = clock::now());
+	void set(Key key, bool pressed, clock::time_point time = clock::now());
 	void clear();
+	// keys held independently of the events, e.g. by the control clients
+	void hold(std::uint16_t mask);
+	// once per frame, drop the latches of the taps made before the last call
+	void expireTaps();
+
+	// any thread: current mask, without latched taps
+	std::uint16_t getState() const;
+
+	// stats thread: hands the pending press to first read latencies to the
+	// callback, returns their number
+	template <typename Callback>
+	std::size_t consumeReadLatencies(Callback &&callback) {
+		return m_readLatencies.consume([&](std::span<const std::uint64_t> ns) {
+			for (auto latency : ns) {
+				callback(std::chrono::nanoseconds(latency));
+			}
+		});
+	}
 
   private:
-	std::array<bool, static_cast<std::size_t>(Key::COUNT)> m_keys{};
+	static constexpr std::uint16_t bit(Key key) {
+		return (std::uint16_t)(1u << static_cast<unsigned>(key));
+	}
+	void queue(Key key, bool pressed, clock::time_point time);
+	// cpu thread: apply the timestamps of the queued events
+	void drainEvents();
+
+	std::atomic<std::uint16_t> m_state{0};
+	std::atomic<std::uint16_t> m_held{0};
+	std::atomic<std::uint16_t> m_latched{0};
+	// input thread owned: keys pressed since the last expireTaps
+	std::uint16_t m_recentTaps{0};
+	// input thread -> cpu thread
+	SpscQueue<Event> m_events;
+	// cpu thread -> stats thread, in nanoseconds
+	SpscQueue<std::uint64_t> m_readLatencies;
+	// cpu thread owned: oldest press of each key not read yet
+	std::array<std::optional<clock::time_point>,
+	           static_cast<std::size_t>(Key::COUNT)>
+	    m_unreadPress{};
 };
 
 } // namespace chip8pp
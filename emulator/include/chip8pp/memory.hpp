@@ -55,14 +55,118 @@ constexpr std::byte font[]{
     static_cast<std::byte>(0x80) // F
 };
 
-class Memory {
+// 8x10 digits of the SUPER-CHIP hi-res font
+constexpr std::byte bigFont[]{
+    static_cast<std::byte>(0xFF), static_cast<std::byte>(0xFF),
+    static_cast<std::byte>(0xC3), static_cast<std::byte>(0xC3),
+    static_cast<std::byte>(0xC3), static_cast<std::byte>(0xC3),
+    static_cast<std::byte>(0xC3), static_cast<std::byte>(0xC3),
+    static_cast<std::byte>(0xFF), static_cast<std::byte>(0xFF), // 0
+    static_cast<std::byte>(0x18), static_cast<std::byte>(0x78),
+    static_cast<std::byte>(0x78), static_cast<std::byte>(0x18),
+    static_cast<std::byte>(0x18), static_cast<std::byte>(0x18),
+    static_cast<std::byte>(0x18), static_cast<std::byte>(0x18),
+    static_cast<std::byte>(0xFF), static_cast<std::byte>(0xFF), // 1
+    static_cast<std::byte>(0xFF), static_cast<std::byte>(0xFF),
+    static_cast<std::byte>(0x03), static_cast<std::byte>(0x03),
+    static_cast<std::byte>(0xFF), static_cast<std::byte>(0xFF),
+    static_cast<std::byte>(0xC0), static_cast<std::byte>(0xC0),
+    static_cast<std::byte>(0xFF), static_cast<std::byte>(0xFF), // 2
+    static_cast<std::byte>(0xFF), static_cast<std::byte>(0xFF),
+    static_cast<std::byte>(0x03), static_cast<std::byte>(0x03),
+    static_cast<std::byte>(0xFF), static_cast<std::byte>(0xFF),
+    static_cast<std::byte>(0x03), static_cast<std::byte>(0x03),
+    static_cast<std::byte>(0xFF), static_cast<std::byte>(0xFF), // 3
+    static_cast<std::byte>(0xC3), static_cast<std::byte>(0xC3),
+    static_cast<std::byte>(0xC3), static_cast<std::byte>(0xC3),
+    static_cast<std::byte>(0xFF), static_cast<std::byte>(0xFF),
+    static_cast<std::byte>(0x03), static_cast<std::byte>(0x03),
+    static_cast<std::byte>(0x03), static_cast<std::byte>(0x03), // 4
+    static_cast<std::byte>(0xFF), static_cast<std::byte>(0xFF),
+    static_cast<std::byte>(0xC0), static_cast<std::byte>(0xC0),
+    static_cast<std::byte>(0xFF), static_cast<std::byte>(0xFF),
+    static_cast<std::byte>(0x03), static_cast<std::byte>(0x03),
+    static_cast<std::byte>(0xFF), static_cast<std::byte>(0xFF), // 5
+    static_cast<std::byte>(0xFF), static_cast<std::byte>(0xFF),
+    static_cast<std::byte>(0xC0), static_cast<std::byte>(0xC0),
+    static_cast<std::byte>(0xFF), static_cast<std::byte>(0xFF),
+    static_cast<std::byte>(0xC3), static_cast<std::byte>(0xC3),
+    static_cast<std::byte>(0xFF), static_cast<std::byte>(0xFF), // 6
+    static_cast<std::byte>(0xFF), static_cast<std::byte>(0xFF),
+    static_cast<std::byte>(0x03), static_cast<std::byte>(0x03),
+    static_cast<std::byte>(0x06), static_cast<std::byte>(0x0C),
+    static_cast<std::byte>(0x18), static_cast<std::byte>(0x18),
+    static_cast<std::byte>(0x18), static_cast<std::byte>(0x18), // 7
+    static_cast<std::byte>(0xFF), static_cast<std::byte>(0xFF),
+    static_cast<std::byte>(0xC3), static_cast<std::byte>(0xC3),
+    static_cast<std::byte>(0xFF), static_cast<std::byte>(0xFF),
+    static_cast<std::byte>(0xC3), static_cast<std::byte>(0xC3),
+    static_cast<std::byte>(0xFF), static_cast<std::byte>(0xFF), // 8
+    static_cast<std::byte>(0xFF), static_cast<std::byte>(0xFF),
+    static_cast<std::byte>(0xC3), static_cast<std::byte>(0xC3),
+    static_cast<std::byte>(0xFF), static_cast<std::byte>(0xFF),
+    static_cast<std::byte>(0x03), static_cast<std::byte>(0x03),
+    static_cast<std::byte>(0xFF), static_cast<std::byte>(0xFF), // 9
+    static_cast<std::byte>(0x7E), static_cast<std::byte>(0xFF),
+    static_cast<std::byte>(0xC3), static_cast<std::byte>(0xC3),
+    static_cast<std::byte>(0xC3), static_cast<std::byte>(0xFF),
+    static_cast<std::byte>(0xFF), static_cast<std::byte>(0xC3),
+    static_cast<std::byte>(0xC3), static_cast<std::byte>(0xC3), // A
+    static_cast<std::byte>(0xFC), static_cast<std::byte>(0xFC),
+    static_cast<std::byte>(0xC3), static_cast<std::byte>(0xC3),
+    static_cast<std::byte>(0xFC), static_cast<std::byte>(0xFC),
+    static_cast<std::byte>(0xC3), static_cast<std::byte>(0xC3),
+    static_cast<std::byte>(0xFC), static_cast<std::byte>(0xFC), // B
+    static_cast<std::byte>(0x3C), static_cast<std::byte>(0xFF),
+    static_cast<std::byte>(0xC3), static_cast<std::byte>(0xC0),
+    static_cast<std::byte>(0xC0), static_cast<std::byte>(0xC0),
+    static_cast<std::byte>(0xC0), static_cast<std::byte>(0xC3),
+    static_cast<std::byte>(0xFF), static_cast<std::byte>(0x3C), // C
+    static_cast<std::byte>(0xFC), static_cast<std::byte>(0xFE),
+    static_cast<std::byte>(0xC3), static_cast<std::byte>(0xC3),
+    static_cast<std::byte>(0xC3), static_cast<std::byte>(0xC3),
+    static_cast<std::byte>(0xC3), static_cast<std::byte>(0xC3),
+    static_cast<std::byte>(0xFE), static_cast<std::byte>(0xFC), // D
+    static_cast<std::byte>(0xFF), static_cast<std::byte>(0xFF),
+    static_cast<std::byte>(0xC0), static_cast<std::byte>(0xC0),
+    static_cast<std::byte>(0xFF), static_cast<std::byte>(0xFF),
+    static_cast<std::byte>(0xC0), static_cast<std::byte>(0xC0),
+    static_cast<std::byte>(0xFF), static_cast<std::byte>(0xFF), // E
+    static_cast<std::byte>(0xFF), static_cast<std::byte>(0xFF),
+    static_cast<std::byte>(0xC0), static_cast<std::byte>(0xC0),
+    static_cast<std::byte>(0xFF), static_cast<std::byte>(0xFF),
+    static_cast<std::byte>(0xC0), static_cast<std::byte>(0xC0),
+    static_cast<std::byte>(0xC0), static_cast<std::byte>(0xC0) // F
+};
+
+// memory access policy of the default Memory, every hook is a no-op and gets
+// optimized away
+struct NoAccessTracking {
+	void onRead(std::uint16_t, std::byte) {}
+	void onWrite(std::uint16_t, std::byte) {}
+	void onExecute(std::uint16_t, std::byte) {}
+};
+
+// AccessPolicy is notified of every read, write and instruction fetch
+// - Size is the address space, 4 KiB for CHIP-8 and SUPER-CHIP, 64 KiB for
+//   XO-CHIP, addresses wrap around it with a compile time mask
+template <typename AccessPolicy = NoAccessTracking,
+          std::size_t Size = 0x1000>
+class BasicMemory {
+	static_assert(Size >= 0x1000 && Size <= 0x10000 &&
+	                  (Size & (Size - 1)) == 0,
+	              "the address space is a power of two up to 64 KiB");
 
   public:
 	static constexpr std::uint16_t ROM_OFFSET = 0x200;
-	static constexpr std::uint16_t RAM_SIZE = 0x1000;
+	static constexpr std::size_t RAM_SIZE = Size;
+	static constexpr std::uint16_t ADDRESS_MASK = Size - 1;
 	static constexpr std::uint16_t ROM_START = 0x200;
 	static constexpr std::uint16_t STACK_SIZE = 0x10;
-	Memory();
+	// where font and bigFont are loaded
+	static constexpr std::uint16_t FONT_OFFSET = 0x50;
+	static constexpr std::uint16_t BIG_FONT_OFFSET = 0xA0;
+	BasicMemory();
 	void load_rom(const std::byte *rom, std::size_t size,
 	              std::uint16_t offset = ROM_OFFSET);
 	// istream load_rom
@@ -70,14 +174,52 @@ class Memory {
 	              std::uint16_t offset = ROM_OFFSET);
 	std::byte *get_memory();
 	std::uint16_t *get_stack();
-	std::byte get_byte(std::uint16_t address);
-	std::uint16_t get_word(std::uint16_t address);
+	// the masks are no-ops for the 64 KiB address space
+	std::byte get_byte(std::uint16_t address) {
+		address &= ADDRESS_MASK;
+		m_accessPolicy.onRead(address, memory[address]);
+		return memory[address];
+	}
+	std::uint16_t get_word(std::uint16_t address) {
+		address &= ADDRESS_MASK;
+		std::uint16_t next = (address + 1) & ADDRESS_MASK;
+		m_accessPolicy.onRead(address, memory[address]);
+		m_accessPolicy.onRead(next, memory[next]);
+		return (static_cast<std::uint16_t>(memory[address]) << 8) |
+		       static_cast<std::uint16_t>(memory[next]);
+	}
+	// same as get_word, but accounted as an instruction fetch
+	std::uint16_t fetch_word(std::uint16_t address) {
+		address &= ADDRESS_MASK;
+		m_accessPolicy.onExecute(address, memory[address]);
+		return (static_cast<std::uint16_t>(memory[address]) << 8) |
+		       static_cast<std::uint16_t>(
+		           memory[(address + 1) & ADDRESS_MASK]);
+	}
 
-	void set_byte(std::uint16_t address, std::byte value);
+	void set_byte(std::uint16_t address, std::byte value) {
+		address &= ADDRESS_MASK;
+		m_accessPolicy.onWrite(address, value);
+		memory[address] = value;
+	}
 
 	void reset();
 
+	AccessPolicy &get_access_policy() { return m_accessPolicy; }
+
   private:
 	std::array<std::byte, RAM_SIZE> memory;
 	std::array<std::uint16_t, STACK_SIZE> stack;
+	[[no_unique_address]] AccessPolicy m_accessPolicy;
 };
+
+// the access tracking layer is selected at build time (memory_tracking
+// option), so the default build pays nothing for it
+#ifdef CHIP8PP_MEMORY_TRACKING
+#include <chip8pp/memoryTracker.hpp>
+using Memory = BasicMemory<chip8pp::MemoryTracker>;
+#else
+using Memory = BasicMemory<>;
+#endif
+// XO-CHIP address space, used by the headless sessions
+using XoChipMemory = BasicMemory<NoAccessTracking, 0x10000>;
@@ -0,0 +1,81 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+
+namespace chip8pp {
+
+// memory access policy that counts the reads, writes and instruction fetches
+// of every address and reports accesses to watched ranges
+// - only compiled in when the memory_tracking build option is enabled
+class MemoryTracker {
+  public:
+	static constexpr std::size_t SIZE = 0x1000;
+
+	enum Access : std::uint8_t {
+		READ = 1 << 0,
+		WRITE = 1 << 1,
+		EXECUTE = 1 << 2,
+	};
+
+	struct WatchHit {
+		std::uint16_t address;
+		Access access;
+		// value read or written (high byte of the opcode for fetches)
+		std::byte value;
+	};
+	using WatchCallback = std::function<void(const WatchHit &hit)>;
+
+	// access policy interface, called by BasicMemory
+	void onRead(std::uint16_t address, std::byte value) {
+		address &= SIZE - 1;
+		m_reads[address]++;
+		if (m_watch[address] & READ) {
+			notify(address, READ, value);
+		}
+	}
+	void onWrite(std::uint16_t address, std::byte value) {
+		address &= SIZE - 1;
+		m_writes[address]++;
+		if (m_watch[address] & WRITE) {
+			notify(address, WRITE, value);
+		}
+	}
+	void onExecute(std::uint16_t address, std::byte value) {
+		address &= SIZE - 1;
+		m_executes[address]++;
+		if (m_watch[address] & EXECUTE) {
+			notify(address, EXECUTE, value);
+		}
+	}
+
+	// watch the accesses of the given kinds in [begin, end]
+	void addWatch(std::uint16_t begin, std::uint16_t end, std::uint8_t access);
+	void clearWatches();
+	void setWatchCallback(WatchCallback callback);
+
+	std::uint32_t getReads(std::uint16_t address) const;
+	std::uint32_t getWrites(std::uint16_t address) const;
+	std::uint32_t getExecutes(std::uint16_t address) const;
+	void reset();
+
+	// one "address,reads,writes,executes" line per address
+	void writeCsv(std::ostream &output) const;
+	// binary PPM image with one scale x scale cell per address, 64 addresses
+	// per row, red = writes, green = reads, blue = executes (log scaled)
+	void writeHeatmap(std::ostream &output, std::size_t scale = 8) const;
+
+  private:
+	void notify(std::uint16_t address, Access access, std::byte value);
+
+	std::array<std::uint32_t, SIZE> m_reads{};
+	std::array<std::uint32_t, SIZE> m_writes{};
+	std::array<std::uint32_t, SIZE> m_executes{};
+	// watched access kinds per address
+	std::array<std::uint8_t, SIZE> m_watch{};
+	WatchCallback m_callback;
+};
+
+} // namespace chip8pp
@@ -0,0 +1,33 @@
+#pragma once
+#include <chip8pp/cpu.hpp>
+#include <chip8pp/instructions.hpp>
+#include <chip8pp/session.hpp>
+#include <chip8pp/trap.hpp>
+#include <vector>
+
+namespace chip8pp {
+
+// runs the cpu of a session from a cache of decoded instructions, one entry
+// per address
+// - an entry is reused while memory still holds its opcode, so self
+//   modifying code decodes again instead of running stale instructions
+// - calls getInstructionList() directly, the debugger dispatch entries are
+//   not used
+// - must match BasicCPU::execute, chip8pp-lockstep checks it against the
+//   reference interpreter
+template <typename MemoryT> class BasicPredecodedCore {
+  public:
+	BasicPredecodedCore();
+
+	// fetch and execute one instruction, returns the trap raised by it (also
+	// stored in the trap fields of the cpu)
+	Trap step(BasicSession<MemoryT> &session);
+
+  private:
+	std::vector<Instruction> m_decoded;
+};
+
+using PredecodedCore = BasicPredecodedCore<Memory>;
+using XoChipPredecodedCore = BasicPredecodedCore<XoChipMemory>;
+
+} // namespace chip8pp
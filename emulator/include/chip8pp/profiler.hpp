@@ -0,0 +1,65 @@
+#pragma once
+#include <array>
+#include <chip8pp/cpu.hpp>
+#include <chip8pp/instructions.hpp>
+#include <chip8pp/memory.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+namespace chip8pp {
+
+// sampling profiler for the emulated program
+// - every `interval` instructions the program counter and the active call
+//   chain are recorded into a per-address hit table
+// - CALL_NNN instructions are always recorded to build an exact call graph
+class Profiler {
+  public:
+	explicit Profiler(std::uint32_t interval = 101);
+
+	// must be called after every executed instruction, only does real work
+	// when a call was executed or a sample is due
+	void observe(const Instruction &instruction, const CPU &cpu) {
+		if (instruction.instruction == InstructionEnum::CALL_NNN) {
+			recordCall(cpu);
+		}
+		if (--m_countdown == 0) {
+			m_countdown = m_interval;
+			sample(cpu);
+		}
+	}
+
+	// write the sampled call chains in the folded stacks format, one
+	// "frame;frame;frame count" line per unique chain (flamegraph.pl input)
+	void writeFoldedStacks(std::ostream &output) const;
+	// write the hotspot table, the call graph and a disassembly listing of
+	// every sampled address annotated with its hit count
+	// - the memory is read untracked, it does not show in the heatmap
+	void writeListing(std::ostream &output, Memory &memory) const;
+
+	std::uint64_t getSampleCount() const;
+
+  private:
+	void recordCall(const CPU &cpu);
+	void sample(const CPU &cpu);
+	// entry address of the routine at the given call depth
+	std::uint16_t routineAt(std::size_t depth) const;
+
+	std::uint32_t m_interval;
+	std::uint32_t m_countdown;
+	std::uint64_t m_samples{0};
+	// samples per address
+	std::array<std::uint64_t, Memory::RAM_SIZE> m_hits{};
+	// entry address of the routine called at each stack level, indexed by
+	// the stack pointer so RET does not need to be tracked
+	std::array<std::uint16_t, CPU::STACK_SIZE> m_routines{};
+	// sampled call chains (outermost routine first, innermost last)
+	std::map<std::vector<std::uint16_t>, std::uint64_t> m_stacks;
+	// number of calls per (caller, callee) routine pair
+	std::map<std::pair<std::uint16_t, std::uint16_t>, std::uint64_t> m_calls;
+};
+
+} // namespace chip8pp
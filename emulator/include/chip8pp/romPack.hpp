@@ -0,0 +1,131 @@
+#pragma once
+#include <array>
+#include <chip8pp/cpu.hpp>
+#include <chip8pp/memory.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace chip8pp {
+
+// header of a rom pack, all the roms of a batch in a single file:
+//   RomPackHeader
+//   RomPackEntry[romCount]   sorted by hash, then by name
+//   u32[romCount]            entry numbers sorted by name, at nameIndexOffset
+//   names and rom contents   referenced by the entries
+// integers are native endian, roms with the same content share their bytes
+struct RomPackHeader {
+	static constexpr std::array<char, 4> MAGIC{'C', '8', 'R', 'P'};
+	static constexpr std::uint16_t VERSION = 1;
+	std::array<char, 4> magic{MAGIC};
+	std::uint16_t version{VERSION};
+	std::uint16_t entrySize{0};
+	std::uint32_t romCount{0};
+	std::uint32_t reserved{0};
+	std::uint64_t nameIndexOffset{0};
+	// size of the whole file
+	std::uint64_t totalSize{0};
+};
+static_assert(sizeof(RomPackHeader) == 32);
+
+struct RomPackEntry {
+	// XXH64 of the rom content
+	std::uint64_t hash{0};
+	std::uint64_t dataOffset{0};
+	std::uint32_t nameOffset{0};
+	std::uint32_t size{0};
+	std::uint16_t nameLength{0};
+	// where the rom is loaded
+	std::uint16_t origin{Memory::ROM_OFFSET};
+	// bit n enables CPU::Quirk n
+	std::uint16_t quirks{0};
+	// instructions run per 60Hz frame, 0 when the rom has no preference
+	std::uint16_t cyclesPerFrame{0};
+};
+static_assert(sizeof(RomPackEntry) == 32);
+
+// read only view of a rom pack
+// - the file is memory mapped once (read into memory where mmap is not
+//   available) and validated on open, the roms are never copied until they
+//   are loaded into a Memory
+// - lookups by hash or name are binary searches over the mapped indexes
+// - throws std::runtime_error when the file cannot be read or is not a
+//   valid rom pack
+class RomPack {
+  public:
+	// rom inside the pack, valid while the pack is
+	struct Rom {
+		std::string_view name;
+		std::uint64_t hash;
+		std::span<const std::byte> data;
+		std::uint16_t origin;
+		std::uint16_t quirks;
+		std::uint16_t cyclesPerFrame;
+
+		template <typename MemoryT>
+		void load(MemoryT &memory) const {
+			memory.load_rom(data.data(), data.size(), origin);
+		}
+		// set the quirks of the cpu
+		void configure(CPUState &cpu) const;
+	};
+
+	explicit RomPack(std::filesystem::path const &path);
+	RomPack(RomPack &&other) noexcept;
+	RomPack &operator=(RomPack &&other) noexcept;
+	RomPack(const RomPack &) = delete;
+	RomPack &operator=(const RomPack &) = delete;
+	~RomPack();
+
+	// hash of a rom content, as stored in the entries
+	static std::uint64_t hash(std::span<const std::byte> rom);
+
+	std::size_t size() const;
+	// in hash order
+	Rom at(std::size_t index) const;
+	// first rom with the content hash
+	std::optional<Rom> findHash(std::uint64_t hash) const;
+	std::optional<Rom> findName(std::string_view name) const;
+	// by name, or by hash when the key is a 16 digit hexadecimal number
+	std::optional<Rom> find(std::string_view key) const;
+
+  private:
+	void release();
+	RomPackHeader const &header() const;
+	RomPackEntry const &entry(std::size_t index) const;
+	std::string_view nameOf(RomPackEntry const &entry) const;
+	std::uint32_t nameIndex(std::size_t position) const;
+
+	const std::byte *m_data{nullptr};
+	std::size_t m_size{0};
+	bool m_mapped{false};
+	// contents when the file could not be mapped
+	std::vector<std::byte> m_buffer;
+};
+
+// collects roms and writes them as a rom pack
+class RomPackBuilder {
+  public:
+	void add(std::string name, std::span<const std::byte> rom,
+	         std::uint16_t quirks = 0, std::uint16_t cyclesPerFrame = 0,
+	         std::uint16_t origin = Memory::ROM_OFFSET);
+	// throws std::runtime_error when two roms have the same name or the
+	// file cannot be written
+	void write(std::filesystem::path const &path) const;
+	std::size_t size() const;
+
+  private:
+	struct Input {
+		std::string name;
+		std::vector<std::byte> data;
+		RomPackEntry entry;
+	};
+	std::vector<Input> m_roms;
+};
+
+} // namespace chip8pp
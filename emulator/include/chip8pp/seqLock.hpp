@@ -0,0 +1,52 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+namespace chip8pp {
+
+// single writer sequence lock around a trivially copyable value, it can live
+// in shared memory
+// - the sequence is odd while the writer updates the value in place, the
+//   writer never waits
+// - a reader copies the value and keeps the copy when the sequence was even
+//   and did not move around it, it yields between a bounded number of
+//   attempts
+template <typename T> struct SeqLock {
+	static_assert(std::is_trivially_copyable_v<T>);
+	static_assert(std::atomic<std::uint32_t>::is_always_lock_free);
+	static constexpr int READ_ATTEMPTS = 16;
+
+	std::atomic<std::uint32_t> sequence{0};
+	T value{};
+
+	// writer: update(T &) changes the value in place
+	template <typename Update> void write(Update &&update) {
+		auto before = sequence.load(std::memory_order_relaxed);
+		sequence.store(before + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		update(value);
+		sequence.store(before + 2, std::memory_order_release);
+	}
+
+	// reader: consistent copy of the value, returns false (and a torn out)
+	// when the writer kept writing during every attempt
+	bool read(T &out) const {
+		for (int attempt = 0; attempt < READ_ATTEMPTS; attempt++) {
+			auto before = sequence.load(std::memory_order_acquire);
+			if (!(before & 1)) {
+				std::memcpy(&out, &value, sizeof(T));
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (sequence.load(std::memory_order_relaxed) == before) {
+					return true;
+				}
+			}
+			std::this_thread::yield();
+		}
+		return false;
+	}
+};
+
+} // namespace chip8pp
@@ -0,0 +1,78 @@
+#pragma once
+#include <chip8pp/cpu.hpp>
+#include <chip8pp/keypad.hpp>
+#include <chip8pp/memory.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <libcanvas/grid.hpp>
+#include <libcanvas/screen.hpp>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace chip8pp {
+
+// keys held during a run, read from a text file with one change per line:
+//   <frame> <mask>      hold the keys of the 16 bit mask from that frame on
+// empty lines and lines starting with '#' are ignored
+// - throws std::runtime_error when the file cannot be read or parsed
+class InputMovie {
+  public:
+	InputMovie() = default;
+	static InputMovie load(std::filesystem::path const &path);
+
+	// keys held during the frame
+	std::uint16_t keysAt(std::uint64_t frame) const;
+
+  private:
+	// sorted by frame
+	std::vector<std::pair<std::uint64_t, std::uint16_t>> m_changes;
+};
+
+// headless emulator instance: memory, cpu, keypad and a screen without a
+// window
+// - the cpu runs on the calling thread one 60Hz frame at a time, a fixed
+//   number of instructions then a timer tick, so a run with the same rom,
+//   seed and input is always the same
+// - independent sessions can run on different threads
+// - MemoryT selects the address space, see Session and XoChipSession
+template <typename MemoryT> struct BasicSession {
+	static constexpr std::size_t WIDTH = CPU::SCREEN_WIDTH;
+	static constexpr std::size_t HEIGHT = CPU::SCREEN_HEIGHT;
+	// SUPER-CHIP hi-res mode
+	static constexpr std::size_t MAX_WIDTH = CPU::HIRES_WIDTH;
+	static constexpr std::size_t MAX_HEIGHT = CPU::HIRES_HEIGHT;
+	static constexpr std::size_t DEFAULT_CYCLES_PER_FRAME = 10;
+
+	BasicSession(std::span<const std::byte> rom, std::uint32_t seed = 0,
+	             std::size_t cyclesPerFrame = DEFAULT_CYCLES_PER_FRAME);
+	BasicSession(const BasicSession &) = delete;
+	BasicSession &operator=(const BasicSession &) = delete;
+
+	// hold exactly the keys of the mask
+	void setKeys(std::uint16_t mask);
+	// run one frame, returns the trap that halted the cpu (now or in an
+	// earlier frame) according to the cpu trap policies
+	std::optional<Trap> runFrame();
+	// logical framebuffer after the last frame, packed as in Grid
+	Grid::FrameView getFrame();
+	// XXH64 of the rows of getFrame, seeded with the size
+	std::uint64_t frameHash();
+
+	MemoryT memory;
+	BasicCPU<MemoryT> cpu;
+	Screen screen;
+	Keypad keypad;
+	std::size_t cyclesPerFrame;
+	// frames run so far
+	std::uint64_t frame{0};
+	std::optional<Trap> halted;
+};
+
+using Session = BasicSession<Memory>;
+// runs XO-CHIP roms, up to 64 KiB
+using XoChipSession = BasicSession<XoChipMemory>;
+
+} // namespace chip8pp
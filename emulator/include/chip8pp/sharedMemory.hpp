@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace chip8pp {
+
+// POSIX shared memory segment mapped into the process
+// - the creating side owns the segment and unlinks it on destruction
+// - throws std::runtime_error when the segment cannot be created or opened
+//   (and on platforms without POSIX shared memory)
+class SharedMemory {
+  public:
+	// create (or replace) a read/write segment of the given size
+	static SharedMemory create(std::string const &name, std::size_t size);
+	// map an existing segment read only
+	static SharedMemory open(std::string const &name);
+	// names of the existing segments starting with prefix (without the
+	// leading '/')
+	static std::vector<std::string> list(std::string const &prefix);
+	// id of the current process, used to name the segments, 0 when unknown
+	static std::uint32_t processId();
+
+	SharedMemory(SharedMemory &&other) noexcept;
+	SharedMemory &operator=(SharedMemory &&other) noexcept;
+	SharedMemory(const SharedMemory &) = delete;
+	SharedMemory &operator=(const SharedMemory &) = delete;
+	~SharedMemory();
+
+	void *data() const;
+	std::size_t size() const;
+	std::string const &name() const;
+
+  private:
+	SharedMemory(std::string name, void *data, std::size_t size, bool owner);
+	void release();
+
+	std::string m_name;
+	void *m_data{nullptr};
+	std::size_t m_size{0};
+	bool m_owner{false};
+};
+
+} // namespace chip8pp
@@ -0,0 +1,94 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <span>
+
+namespace chip8pp {
+
+// bounded single-producer single-consumer lock-free queue
+// - push is only called from the producer thread, pop/consume only from the
+//   consumer thread
+// - push never blocks, it fails when the queue is full
+template <typename T>
+class SpscQueue {
+  public:
+	// capacity is rounded up to the next power of two
+	explicit SpscQueue(std::size_t capacity)
+	    : m_capacity(std::bit_ceil(capacity < 2 ? 2 : capacity)),
+	      m_mask(m_capacity - 1), m_buffer(new T[m_capacity]) {}
+
+	SpscQueue(const SpscQueue &) = delete;
+	SpscQueue &operator=(const SpscQueue &) = delete;
+
+	// producer side
+	bool push(const T &value) {
+		std::size_t head = m_head.load(std::memory_order_relaxed);
+		if (head - m_cachedTail == m_capacity) {
+			// refresh the consumer position only when the queue looks full
+			m_cachedTail = m_tail.load(std::memory_order_acquire);
+			if (head - m_cachedTail == m_capacity) {
+				return false;
+			}
+		}
+		m_buffer[head & m_mask] = value;
+		m_head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	// consumer side
+	bool pop(T &value) {
+		std::size_t tail = m_tail.load(std::memory_order_relaxed);
+		if (tail == m_cachedHead) {
+			m_cachedHead = m_head.load(std::memory_order_acquire);
+			if (tail == m_cachedHead) {
+				return false;
+			}
+		}
+		value = m_buffer[tail & m_mask];
+		m_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// consumer side, hands every queued element to the callback as at most
+	// two contiguous spans and returns the number of consumed elements
+	template <typename Callback>
+	std::size_t consume(Callback &&callback) {
+		std::size_t tail = m_tail.load(std::memory_order_relaxed);
+		m_cachedHead = m_head.load(std::memory_order_acquire);
+		std::size_t count = m_cachedHead - tail;
+		if (count == 0) {
+			return 0;
+		}
+		std::size_t first = tail & m_mask;
+		std::size_t firstCount = std::min(count, m_capacity - first);
+		callback(std::span<const T>(m_buffer.get() + first, firstCount));
+		if (firstCount < count) {
+			callback(std::span<const T>(m_buffer.get(), count - firstCount));
+		}
+		m_tail.store(tail + count, std::memory_order_release);
+		return count;
+	}
+
+	bool empty() const {
+		return m_head.load(std::memory_order_acquire) ==
+		       m_tail.load(std::memory_order_acquire);
+	}
+
+	std::size_t capacity() const { return m_capacity; }
+
+  private:
+	const std::size_t m_capacity;
+	const std::size_t m_mask;
+	std::unique_ptr<T[]> m_buffer;
+	// producer owned
+	alignas(64) std::atomic<std::size_t> m_head{0};
+	std::size_t m_cachedTail{0};
+	// consumer owned
+	alignas(64) std::atomic<std::size_t> m_tail{0};
+	std::size_t m_cachedHead{0};
+};
+
+} // namespace chip8pp
@@ -0,0 +1,90 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chip8pp/histogram.hpp>
+#include <chip8pp/seqLock.hpp>
+#include <chip8pp/sharedMemory.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace chip8pp {
+
+// counters shared by the emulation threads, read by the stats publisher
+struct StatsCounters {
+	// executed instructions, updated by the cpu thread in batches
+	std::atomic<std::uint64_t> instructions{0};
+	// timer ticks that woke up at least one period late
+	std::atomic<std::uint64_t> schedulerOverruns{0};
+};
+
+// plain data published in the stats page
+struct StatsSnapshot {
+	// steady clock time of the publication
+	std::uint64_t timestampNs{0};
+	std::uint64_t instructions{0};
+	std::uint64_t instructionsPerSecond{0};
+	std::uint64_t framesPresented{0};
+	std::uint64_t schedulerOverruns{0};
+	// frame deadlines missed by the presentation loop
+	std::uint64_t missedFrames{0};
+	// interval between two presented frames
+	Histogram frameTime;
+	// time between the emulation drawing a frame and its present
+	Histogram frameAge;
+	// time spent in Screen::update
+	Histogram screenUpdate;
+	// time between a key event and the next presented frame
+	Histogram inputLatency;
+	// time between a key press and the first time the program read that key
+	Histogram inputReadLatency;
+};
+
+// layout of the shared memory stats page, the snapshot is protected by a
+// seqlock
+struct StatsPage {
+	static constexpr std::array<char, 4> MAGIC{'C', '8', 'S', 'T'};
+	static constexpr std::uint32_t VERSION = 4;
+	std::array<char, 4> magic{MAGIC};
+	std::uint32_t version{VERSION};
+	std::uint32_t pid{0};
+	SeqLock<StatsSnapshot> snapshot;
+};
+
+// shared memory segments are named <STATS_PREFIX><pid>
+inline constexpr const char *STATS_PREFIX = "chip8pp-stats-";
+
+// publishes a stats page for the current process
+// - single writer: every method must be called from the same thread
+class StatsPublisher {
+  public:
+	explicit StatsPublisher(StatsCounters const &counters);
+
+	void recordFrame(std::chrono::nanoseconds updateTime);
+	// presentation timings, owned by the FramePacer
+	void setPacing(Histogram const &presentInterval, Histogram const &frameAge,
+	               std::uint64_t missedFrames);
+	void recordInputLatency(std::chrono::nanoseconds latency);
+	void recordInputReadLatency(std::chrono::nanoseconds latency);
+	// copy the current values into the stats page
+	void publish();
+
+	StatsSnapshot const &getSnapshot() const;
+	// the published page, may be read from any thread with readStatsPage
+	StatsPage const &getPage() const;
+
+  private:
+	StatsCounters const &m_counters;
+	SharedMemory m_memory;
+	StatsPage *m_page;
+	StatsSnapshot m_snapshot;
+	std::chrono::steady_clock::time_point m_lastRate;
+	std::uint64_t m_lastInstructions{0};
+};
+
+// read a consistent copy of a stats page, returns false if the publisher
+// kept writing during every attempt
+bool readStatsPage(StatsPage const &page, StatsSnapshot &snapshot);
+
+} // namespace chip8pp
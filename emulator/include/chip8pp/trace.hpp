@@ -0,0 +1,98 @@
+#pragma once
+#include <array>
+#include <chip8pp/cpu.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace chip8pp {
+
+// fixed size record of one executed instruction
+struct TraceRecord {
+	// used in `reg` when the instruction did not change any register
+	static constexpr std::uint8_t NO_REGISTER = 0xFF;
+	// number of instructions executed before this one
+	std::uint64_t cycle;
+	// address of the instruction
+	std::uint16_t pc;
+	std::uint16_t opcode;
+	// index register after the instruction
+	std::uint16_t index;
+	// first register changed by the instruction and its new value
+	std::uint8_t reg;
+	std::uint8_t value;
+};
+static_assert(sizeof(TraceRecord) == 16);
+
+// header of a trace file, the records follow it and are stored as a ring of
+// `capacity` entries, record `i` lives in slot `i % capacity`
+struct TraceFileHeader {
+	static constexpr std::array<char, 4> MAGIC{'C', '8', 'T', 'R'};
+	static constexpr std::uint16_t VERSION = 1;
+	std::array<char, 4> magic{MAGIC};
+	std::uint16_t version{VERSION};
+	std::uint16_t recordSize{sizeof(TraceRecord)};
+	// number of record slots in the file
+	std::uint64_t capacity{0};
+	// total number of records written to the file
+	std::uint64_t written{0};
+	std::uint64_t reserved{0};
+};
+static_assert(sizeof(TraceFileHeader) == 32);
+
+// execution tracer, a flight recorder of the last `depth` instructions
+// - the cpu thread stores the records in a ring in memory laid out as the
+//   file, the newest record overwrites the oldest so none is ever dropped
+// - the ring is written to the file by snapshot, on a fault, and when the
+//   tracer is destroyed
+class TraceWriter {
+  public:
+	TraceWriter(std::filesystem::path const &path, std::size_t depth);
+	// writes the last snapshot, the cpu thread must be stopped
+	~TraceWriter();
+
+	// cpu thread only, registersBefore holds the registers as they were
+	// before the instruction was executed
+	void record(std::uint64_t cycle, std::uint16_t pc, std::uint16_t opcode,
+	            const CPU &cpu,
+	            const std::array<std::byte, 16> &registersBefore) {
+		TraceRecord record{cycle,
+		                   pc,
+		                   opcode,
+		                   cpu.index,
+		                   TraceRecord::NO_REGISTER,
+		                   0};
+		for (std::uint8_t i = 0; i < 16; i++) {
+			if (cpu.registers[i] != registersBefore[i]) {
+				record.reg = i;
+				record.value = (std::uint8_t)cpu.registers[i];
+				break;
+			}
+		}
+		m_ring[m_slot] = record;
+		if (++m_slot == m_ring.size()) {
+			m_slot = 0;
+		}
+		m_header.written++;
+	}
+
+	// cpu thread only, write the records kept so far to the file
+	void snapshot();
+
+  private:
+	std::vector<TraceRecord> m_ring;
+	// slot of the next record
+	std::size_t m_slot{0};
+	// m_header.written at the last snapshot
+	std::uint64_t m_snapshot{0};
+	std::ofstream m_file;
+	TraceFileHeader m_header;
+};
+
+// read a trace file, returns the stored records from oldest to newest
+std::vector<TraceRecord> readTraceFile(std::filesystem::path const &path,
+                                       TraceFileHeader &header);
+
+} // namespace chip8pp
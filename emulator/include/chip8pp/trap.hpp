@@ -0,0 +1,53 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace chip8pp {
+
+// reason an instruction did not complete normally, returned by the
+// instruction handlers instead of throwing
+enum class Trap : std::uint8_t {
+	None = 0,
+	// opcode that does not decode to any instruction
+	InvalidOpcode,
+	// decoded instruction without an implementation
+	NotImplemented,
+	// CALL with a full stack
+	StackOverflow,
+	// RET with an empty stack
+	StackUnderflow,
+	// raised by the debugger
+	Breakpoint,
+	// LD VX, K without a pressed key, the instruction is retried
+	KeyWait,
+	// the rom ended itself with EXIT
+	Exit,
+	// used only to count the number of traps
+	COUNT,
+};
+
+// what the execution loop does when an instruction raises a trap
+enum class TrapPolicy : std::uint8_t {
+	// stop executing and report the trap
+	Halt,
+	// ignore the trap and continue with the next instruction
+	Skip,
+	// report the trap and continue with the next instruction
+	Report,
+};
+
+using TrapPolicies =
+    std::array<TrapPolicy, static_cast<std::size_t>(Trap::COUNT)>;
+
+// halt on faults, keep going while waiting for a key
+TrapPolicies defaultTrapPolicies();
+
+// names used on the command line, e.g. "stack-overflow" and "halt"
+std::string_view getTrapName(Trap trap);
+std::optional<Trap> parseTrap(std::string_view name);
+std::optional<TrapPolicy> parseTrapPolicy(std::string_view name);
+
+} // namespace chip8pp
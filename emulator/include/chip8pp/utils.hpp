@@ -1,10 +1,18 @@
 #pragma once
+#include <chip8pp/memory.hpp>
+#include <cstdint>
 #include <filesystem>
 #include <memory>
+#include <string>
 #include <tuple>
 
 namespace chip8pp::utils {
 // load a rom from a file path into a memory buffer
+// - max_size defaults to the space after the roms of the 4 KiB Memory
 std::tuple<std::unique_ptr<std::byte[]>, std::size_t>
-load_file(std::filesystem::path const &path);
+load_file(std::filesystem::path const &path,
+          std::size_t max_size = Memory::RAM_SIZE - Memory::ROM_START);
+// parse a 16 bit number using the C syntax (0x200, 512)
+// - throws std::invalid_argument when the text is not a valid number
+std::uint16_t parse_number(std::string const &text);
 } // namespace chip8pp::utils
@@ -0,0 +1,487 @@
+#include <algorithm>
+#include <array>
+#include <chip8pp/analyzer.hpp>
+#include <chip8pp/cpu.hpp>
+#include <chip8pp/disassembler.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <string>
+// check if format is available
+#if __has_include(<format>)
+#include <format>
+using std::format;
+// if not, use fmt
+#elif __has_include(<fmt/format.h>)
+#include <fmt/format.h>
+using fmt::format;
+#else
+#error "No <format> or <fmt/format.h> found"
+#endif
+
+namespace chip8pp {
+
+namespace {
+
+constexpr std::size_t ADDRESS_SPACE = Memory::RAM_SIZE;
+constexpr std::size_t NO_BLOCK = SIZE_MAX;
+
+bool isSkip(InstructionEnum instruction) {
+	switch (instruction) {
+	case InstructionEnum::SE_VX_NN:
+	case InstructionEnum::SNE_VX_NN:
+	case InstructionEnum::SE_VX_VY:
+	case InstructionEnum::SNE_VX_VY:
+	case InstructionEnum::SKP_VX:
+	case InstructionEnum::SKNP_VX:
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool endsBlock(InstructionEnum instruction) {
+	switch (instruction) {
+	case InstructionEnum::JMP_NNN:
+	case InstructionEnum::CALL_NNN:
+	case InstructionEnum::RET:
+	case InstructionEnum::JMP_V0_NNN:
+	case InstructionEnum::EXIT:
+	case InstructionEnum::INVALID:
+	// XO-CHIP only, invalid in the 4 KiB address space
+	case InstructionEnum::LD_I_LONG:
+		return true;
+	default:
+		return isSkip(instruction);
+	}
+}
+
+// successors of the instruction at pc when it ends a block
+std::vector<Analysis::Edge> blockEdges(Instruction const &instruction,
+                                       std::uint16_t pc) {
+	using Kind = Analysis::EdgeKind;
+	switch (instruction.instruction) {
+	case InstructionEnum::JMP_NNN:
+		return {{instruction.nnn, Kind::Jump}};
+	case InstructionEnum::CALL_NNN:
+		return {{instruction.nnn, Kind::Call},
+		        {(std::uint16_t)(pc + 2), Kind::Fallthrough}};
+	default:
+		if (isSkip(instruction.instruction)) {
+			return {{(std::uint16_t)(pc + 2), Kind::Fallthrough},
+			        {(std::uint16_t)(pc + 4), Kind::Skip}};
+		}
+		return {};
+	}
+}
+
+// value of the index register on a path, merged where the paths join
+struct IndexState {
+	enum class Kind { Unset, Known, Unknown };
+	Kind kind{Kind::Unset};
+	std::uint16_t value{0};
+
+	static IndexState known(std::uint16_t value) {
+		return {Kind::Known, value};
+	}
+	static IndexState unknown() { return {Kind::Unknown, 0}; }
+
+	// returns true when the state changed
+	bool merge(IndexState other) {
+		if (other.kind == Kind::Unset || kind == Kind::Unknown ||
+		    (kind == other.kind && value == other.value)) {
+			return false;
+		}
+		*this = kind == Kind::Unset ? other : unknown();
+		return true;
+	}
+};
+
+} // namespace
+
+bool Analysis::isStatic() const {
+	return computedJumps.empty() && selfModifyingStores.empty() &&
+	       unknownStores.empty() && invalidInstructions.empty() &&
+	       externalTargets.empty();
+}
+
+const Analysis::Block *Analysis::findBlock(std::uint16_t start) const {
+	auto block = std::lower_bound(
+	    blocks.begin(), blocks.end(), start,
+	    [](Block const &block, std::uint16_t value) {
+		    return block.start < value;
+	    });
+	return block != blocks.end() && block->start == start ? &*block
+	                                                      : nullptr;
+}
+
+Analysis analyze(std::span<const std::byte> rom, std::uint16_t origin,
+                 bool modifyIndexLoadStore) {
+	Analysis analysis;
+	analysis.origin = origin;
+	analysis.size = rom.size();
+	auto inRom = [&](std::uint32_t address) {
+		return address >= origin && address + 2 <= origin + rom.size() &&
+		       address + 2 <= ADDRESS_SPACE;
+	};
+
+	// discover the reachable instructions and where the blocks start
+	std::vector<bool> isInstruction(ADDRESS_SPACE);
+	std::vector<bool> isLeader(ADDRESS_SPACE);
+	std::vector<Instruction> decoded(ADDRESS_SPACE);
+	std::set<std::uint16_t> calls;
+	std::set<std::uint16_t> external;
+	std::vector<std::uint16_t> pending;
+	auto follow = [&](std::uint16_t target) {
+		if (!inRom(target)) {
+			external.insert(target);
+			return;
+		}
+		isLeader[target] = true;
+		pending.push_back(target);
+	};
+	follow(origin);
+	while (!pending.empty()) {
+		std::uint16_t pc = pending.back();
+		pending.pop_back();
+		// sweep until the path leaves, ends or joins a known one
+		for (;;) {
+			if (isInstruction[pc]) {
+				isLeader[pc] = true;
+				break;
+			}
+			isInstruction[pc] = true;
+			auto offset = (std::size_t)(pc - origin);
+			decoded[pc] = CPU::decode(
+			    (std::uint16_t)((std::uint16_t)rom[offset] << 8 |
+			                    (std::uint16_t)rom[offset + 1]));
+			auto &instruction = decoded[pc];
+			if (endsBlock(instruction.instruction)) {
+				for (auto edge : blockEdges(instruction, pc)) {
+					if (edge.kind == Analysis::EdgeKind::Call) {
+						calls.insert(edge.to);
+					}
+					follow(edge.to);
+				}
+				break;
+			}
+			if (!inRom(pc + 2)) {
+				external.insert((std::uint16_t)(pc + 2));
+				break;
+			}
+			pc += 2;
+		}
+	}
+
+	// cut the instructions into blocks
+	std::vector<std::size_t> blockIndex(ADDRESS_SPACE, NO_BLOCK);
+	for (std::uint16_t start = 0; start < ADDRESS_SPACE; start++) {
+		if (!isLeader[start] || !isInstruction[start]) {
+			continue;
+		}
+		blockIndex[start] = analysis.blocks.size();
+		auto &block = analysis.blocks.emplace_back();
+		block.start = start;
+		for (std::uint16_t pc = start;; pc += 2) {
+			auto &instruction = decoded[pc];
+			block.instructions.push_back(instruction);
+			block.end = pc + 2;
+			if (endsBlock(instruction.instruction)) {
+				block.successors = blockEdges(instruction, pc);
+				if (instruction.instruction == InstructionEnum::JMP_V0_NNN) {
+					analysis.computedJumps.push_back(pc);
+				} else if (instruction.instruction ==
+				               InstructionEnum::INVALID ||
+				           instruction.instruction ==
+				               InstructionEnum::LD_I_LONG) {
+					analysis.invalidInstructions.push_back(pc);
+				}
+				break;
+			}
+			if (!inRom(pc + 2) || isLeader[pc + 2]) {
+				block.successors = {
+				    {(std::uint16_t)(pc + 2), Analysis::EdgeKind::Fallthrough}};
+				break;
+			}
+		}
+	}
+
+	std::vector<bool> isCode(ADDRESS_SPACE);
+	std::vector<bool> isSprite(ADDRESS_SPACE);
+	std::vector<bool> isData(ADDRESS_SPACE);
+	std::set<std::uint16_t> references;
+	for (std::size_t pc = 0; pc + 1 < ADDRESS_SPACE; pc++) {
+		if (isInstruction[pc]) {
+			isCode[pc] = true;
+			isCode[pc + 1] = true;
+		}
+	}
+	auto mark = [](std::vector<bool> &bytes, std::uint32_t from,
+	               std::uint32_t count) {
+		for (auto address = from;
+		     address < from + count && address < ADDRESS_SPACE; address++) {
+			bytes[address] = true;
+		}
+	};
+	// index register at the end of the block, what the instructions access
+	// is recorded when record is set
+	auto transfer = [&](Analysis::Block const &block, IndexState index,
+	                    bool record) {
+		std::uint16_t pc = block.start;
+		for (auto &instruction : block.instructions) {
+			auto x = (std::uint32_t)instruction.x;
+			bool known = index.kind == IndexState::Kind::Known;
+			std::uint32_t count = 0;
+			switch (instruction.instruction) {
+			case InstructionEnum::LD_I_NNN:
+				index = IndexState::known(instruction.nnn);
+				if (record) {
+					references.insert(instruction.nnn);
+				}
+				break;
+			case InstructionEnum::ADD_I_VX:
+			case InstructionEnum::LD_F_VX:
+			case InstructionEnum::LD_HF_VX:
+				index = IndexState::unknown();
+				break;
+			case InstructionEnum::DRW_VX_VY_N:
+				// a height of 0 is a 16x16 sprite
+				if (record && known) {
+					auto n = (std::uint32_t)instruction.n;
+					mark(isSprite, index.value, n ? n : 32);
+				}
+				break;
+			case InstructionEnum::LD_VX_I:
+				if (record && known) {
+					mark(isData, index.value, x + 1);
+				}
+				if (known && modifyIndexLoadStore) {
+					index.value = (std::uint16_t)(index.value + x + 1);
+				}
+				break;
+			case InstructionEnum::LD_B_VX:
+				count = 3;
+				[[fallthrough]];
+			case InstructionEnum::LD_I_VX:
+				count = count ? count : x + 1;
+				if (record && !known) {
+					analysis.unknownStores.push_back(pc);
+				} else if (record) {
+					mark(isData, index.value, count);
+					for (std::uint32_t i = 0; i < count; i++) {
+						if (index.value + i < ADDRESS_SPACE &&
+						    isCode[index.value + i]) {
+							analysis.selfModifyingStores.push_back(pc);
+							break;
+						}
+					}
+				}
+				if (known && modifyIndexLoadStore &&
+				    instruction.instruction == InstructionEnum::LD_I_VX) {
+					index.value = (std::uint16_t)(index.value + count);
+				}
+				break;
+			default:
+				break;
+			}
+			pc += 2;
+		}
+		return index;
+	};
+
+	// propagate the index through the graph until nothing changes, the cpu
+	// starts with an index of 0
+	std::vector<IndexState> entry(analysis.blocks.size());
+	std::vector<std::size_t> changed;
+	if (inRom(origin)) {
+		entry[blockIndex[origin]] = IndexState::known(0);
+		changed.push_back(blockIndex[origin]);
+	}
+	while (!changed.empty()) {
+		std::size_t current = changed.back();
+		changed.pop_back();
+		auto &block = analysis.blocks[current];
+		IndexState exit = transfer(block, entry[current], false);
+		bool call = block.instructions.back().instruction ==
+		            InstructionEnum::CALL_NNN;
+		for (auto edge : block.successors) {
+			if (!inRom(edge.to)) {
+				continue;
+			}
+			std::size_t next = blockIndex[edge.to];
+			// the subroutine may have changed the index
+			IndexState state =
+			    call && edge.kind == Analysis::EdgeKind::Fallthrough
+			        ? IndexState::unknown()
+			        : exit;
+			if (entry[next].merge(state)) {
+				changed.push_back(next);
+			}
+		}
+	}
+	for (std::size_t i = 0; i < analysis.blocks.size(); i++) {
+		transfer(analysis.blocks[i], entry[i], true);
+	}
+
+	for (std::size_t offset = 0; offset < rom.size(); offset++) {
+		std::size_t address = origin + offset;
+		auto kind = Analysis::RegionKind::Unknown;
+		if (address >= ADDRESS_SPACE) {
+			break;
+		} else if (isCode[address]) {
+			kind = Analysis::RegionKind::Code;
+		} else if (isSprite[address]) {
+			kind = Analysis::RegionKind::Sprite;
+		} else if (isData[address]) {
+			kind = Analysis::RegionKind::Data;
+		}
+		if (analysis.regions.empty() || analysis.regions.back().kind != kind) {
+			analysis.regions.push_back(
+			    {(std::uint16_t)address, (std::uint16_t)address, kind});
+		}
+		analysis.regions.back().end = (std::uint16_t)(address + 1);
+	}
+
+	analysis.callTargets.assign(calls.begin(), calls.end());
+	analysis.references.assign(references.begin(), references.end());
+	analysis.externalTargets.assign(external.begin(), external.end());
+	for (auto *list : {&analysis.computedJumps, &analysis.selfModifyingStores,
+	                   &analysis.unknownStores,
+	                   &analysis.invalidInstructions}) {
+		std::sort(list->begin(), list->end());
+	}
+	return analysis;
+}
+
+std::string_view getRegionKindName(Analysis::RegionKind kind) {
+	switch (kind) {
+	case Analysis::RegionKind::Code:
+		return "code";
+	case Analysis::RegionKind::Sprite:
+		return "sprite";
+	case Analysis::RegionKind::Data:
+		return "data";
+	default:
+		return "unknown";
+	}
+}
+
+std::string_view getEdgeKindName(Analysis::EdgeKind kind) {
+	switch (kind) {
+	case Analysis::EdgeKind::Jump:
+		return "jump";
+	case Analysis::EdgeKind::Skip:
+		return "skip";
+	case Analysis::EdgeKind::Call:
+		return "call";
+	default:
+		return "fallthrough";
+	}
+}
+
+namespace {
+
+void writeAddressList(std::ostream &out, std::string_view name,
+                      std::vector<std::uint16_t> const &addresses,
+                      bool last = false) {
+	out << format("    \"{}\": [", name);
+	for (std::size_t i = 0; i < addresses.size(); i++) {
+		out << format("{}{}", i ? ", " : "", addresses[i]);
+	}
+	out << (last ? "]\n" : "],\n");
+}
+
+} // namespace
+
+void writeJson(std::ostream &out, Analysis const &analysis) {
+	// the disassembly never contains characters to escape
+	out << "{\n";
+	out << format("  \"origin\": {},\n  \"size\": {},\n  \"static\": {},\n",
+	              analysis.origin, analysis.size,
+	              analysis.isStatic() ? "true" : "false");
+	out << "  \"blocks\": [\n";
+	for (std::size_t i = 0; i < analysis.blocks.size(); i++) {
+		auto &block = analysis.blocks[i];
+		out << format("    {{\"start\": {}, \"end\": {}, \"instructions\": [",
+		              block.start, block.end);
+		std::uint16_t pc = block.start;
+		for (auto &instruction : block.instructions) {
+			out << format("{}\n      {{\"address\": {}, \"opcode\": {}, "
+			              "\"text\": \"{}\"}}",
+			              pc == block.start ? "" : ",", pc,
+			              instruction.opcode, disassemble(instruction));
+			pc += 2;
+		}
+		out << "],\n     \"successors\": [";
+		for (std::size_t j = 0; j < block.successors.size(); j++) {
+			auto &edge = block.successors[j];
+			out << format("{}{{\"to\": {}, \"kind\": \"{}\"}}",
+			              j ? ", " : "", edge.to,
+			              getEdgeKindName(edge.kind));
+		}
+		out << format("]}}{}\n", i + 1 < analysis.blocks.size() ? "," : "");
+	}
+	out << "  ],\n  \"regions\": [\n";
+	for (std::size_t i = 0; i < analysis.regions.size(); i++) {
+		auto &region = analysis.regions[i];
+		out << format(
+		    "    {{\"start\": {}, \"end\": {}, \"kind\": \"{}\"}}{}\n",
+		    region.start, region.end, getRegionKindName(region.kind),
+		    i + 1 < analysis.regions.size() ? "," : "");
+	}
+	out << "  ],\n  \"addresses\": {\n";
+	writeAddressList(out, "call_targets", analysis.callTargets);
+	writeAddressList(out, "references", analysis.references);
+	writeAddressList(out, "computed_jumps", analysis.computedJumps);
+	writeAddressList(out, "self_modifying_stores",
+	                 analysis.selfModifyingStores);
+	writeAddressList(out, "unknown_stores", analysis.unknownStores);
+	writeAddressList(out, "invalid_instructions",
+	                 analysis.invalidInstructions);
+	writeAddressList(out, "external_targets", analysis.externalTargets,
+	                 true);
+	out << "  }\n}\n";
+}
+
+void writeDot(std::ostream &out, Analysis const &analysis) {
+	out << "digraph cfg {\n  node [shape=box, fontname=monospace];\n";
+	for (auto &block : analysis.blocks) {
+		// left aligned lines
+		std::string label;
+		std::uint16_t pc = block.start;
+		for (auto &instruction : block.instructions) {
+			label += format("{:03x}  {}\\l", pc, disassemble(instruction));
+			pc += 2;
+		}
+		bool subroutine = std::binary_search(analysis.callTargets.begin(),
+		                                     analysis.callTargets.end(),
+		                                     block.start);
+		out << format("  b{:03x} [label=\"{}\"{}];\n", block.start, label,
+		              subroutine ? ", peripheries=2" : "");
+	}
+	for (auto target : analysis.externalTargets) {
+		out << format("  b{:03x} [label=\"{:03x} (outside the rom)\", "
+		              "style=dashed];\n",
+		              target, target);
+	}
+	for (auto &block : analysis.blocks) {
+		for (auto edge : block.successors) {
+			std::string_view style;
+			switch (edge.kind) {
+			case Analysis::EdgeKind::Skip:
+				style = " [style=dashed, label=skip]";
+				break;
+			case Analysis::EdgeKind::Call:
+				style = " [style=bold, label=call]";
+				break;
+			default:
+				break;
+			}
+			out << format("  b{:03x} -> b{:03x}{};\n", block.start, edge.to,
+			              style);
+		}
+	}
+	out << "}\n";
+}
+
+} // namespace chip8pp
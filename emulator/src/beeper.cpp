@@ -0,0 +1,82 @@
+#include <algorithm>
+#include <chip8pp/beeper.hpp>
+#include <cmath>
+#include <string>
+
+#include <SDL3/SDL.h>
+
+namespace chip8pp {
+
+Beeper::Beeper(CPU &cpu, float frequency, float volume) : m_cpu(cpu) {
+	// a whole number of samples per period, the pitch is rounded slightly
+	auto samples = (std::size_t)std::max(
+	    2.0f, std::round((float)SAMPLE_RATE / std::max(frequency, 1.0f)));
+	m_period.resize(samples);
+	for (std::size_t i = 0; i < samples; i++) {
+		m_period[i] = i < samples / 2 ? volume : -volume;
+	}
+}
+
+bool Beeper::init() {
+	// ask for a small device buffer, SDL uses a larger one by default
+	SDL_SetHint(SDL_HINT_AUDIO_DEVICE_SAMPLE_FRAMES,
+	            std::to_string(DEVICE_FRAMES).c_str());
+	if (!SDL_InitSubSystem(SDL_INIT_AUDIO)) {
+		SDL_Log("Could not initialize SDL audio: %s", SDL_GetError());
+		return false;
+	}
+	SDL_AudioSpec spec{SDL_AUDIO_F32, 1, SAMPLE_RATE};
+	m_stream = SDL_OpenAudioDeviceStream(SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK,
+	                                     &spec, &Beeper::callback, this);
+	if (!m_stream) {
+		SDL_Log("Could not open the audio device: %s", SDL_GetError());
+		SDL_QuitSubSystem(SDL_INIT_AUDIO);
+		return false;
+	}
+	// streams are opened paused
+	SDL_ResumeAudioStreamDevice(m_stream);
+	return true;
+}
+
+void Beeper::callback(void *userdata, SDL_AudioStream *stream,
+                      int additionalAmount, int) {
+	// only produce what the device needs now, queued audio is latency
+	auto frames = (std::size_t)std::max(additionalAmount, 0) / sizeof(float);
+	static_cast<Beeper *>(userdata)->generate(stream, frames);
+}
+
+void Beeper::generate(SDL_AudioStream *stream, std::size_t frames) {
+	while (frames > 0) {
+		if (m_untilTick == 0) {
+			// a timer above 0 before the tick sounds until the next one
+			m_tone = m_cpu.timerTick() > 0;
+			m_untilTick = SAMPLES_PER_TICK;
+			if (!m_tone) {
+				// restart the wave on the next tone
+				m_phase = 0;
+			}
+		}
+		std::size_t count = std::min({frames, m_chunk.size(), m_untilTick});
+		if (m_tone) {
+			for (std::size_t i = 0; i < count; i++) {
+				m_chunk[i] = m_period[m_phase];
+				m_phase = m_phase + 1 == m_period.size() ? 0 : m_phase + 1;
+			}
+		} else {
+			std::fill(m_chunk.begin(), m_chunk.begin() + count, 0.0f);
+		}
+		SDL_PutAudioStreamData(stream, m_chunk.data(),
+		                       (int)(count * sizeof(float)));
+		m_untilTick -= count;
+		frames -= count;
+	}
+}
+
+Beeper::~Beeper() {
+	if (m_stream) {
+		SDL_DestroyAudioStream(m_stream);
+		SDL_QuitSubSystem(SDL_INIT_AUDIO);
+	}
+}
+
+} // namespace chip8pp
@@ -0,0 +1,461 @@
+#include <algorithm>
+#include <cerrno>
+#include <chip8pp/controlServer.hpp>
+#include <chip8pp/utils.hpp>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+// check if format is available
+#if __has_include(<format>)
+#include <format>
+using std::format;
+// if not, use fmt
+#elif __has_include(<fmt/format.h>)
+#include <fmt/format.h>
+using fmt::format;
+#else
+#error "No <format> or <fmt/format.h> found"
+#endif
+
+#if __has_include(<sys/socket.h>) && __has_include(<sys/un.h>) &&            \
+    __has_include(<poll.h>)
+#define CHIP8PP_HAS_UNIX_SOCKETS 1
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+#endif
+
+namespace chip8pp {
+
+namespace {
+// a client sending a line longer than this is disconnected
+constexpr std::size_t MAX_PENDING_INPUT = 64 * 1024;
+// a client not reading its replies is disconnected past this
+constexpr std::size_t MAX_PENDING_OUTPUT = 1024 * 1024;
+
+using utils::parse_number;
+
+std::string toHex(const std::byte *data, std::size_t size) {
+	constexpr const char *digits = "0123456789abcdef";
+	std::string text;
+	text.reserve(size * 2);
+	for (std::size_t i = 0; i < size; i++) {
+		text.push_back(digits[(std::uint8_t)data[i] >> 4]);
+		text.push_back(digits[(std::uint8_t)data[i] & 0xF]);
+	}
+	return text;
+}
+
+int fromHexDigit(char digit) {
+	if (digit >= '0' && digit <= '9') {
+		return digit - '0';
+	}
+	if (digit >= 'a' && digit <= 'f') {
+		return digit - 'a' + 10;
+	}
+	if (digit >= 'A' && digit <= 'F') {
+		return digit - 'A' + 10;
+	}
+	throw std::invalid_argument(format("invalid hex digit {}", digit));
+}
+} // namespace
+
+std::uint16_t ControlServer::getInjectedKeys() const {
+	return m_injectedKeys.load(std::memory_order_relaxed);
+}
+
+void ControlServer::publishFrame(std::span<const std::uint64_t> rows,
+                                 std::size_t wordsPerRow, std::size_t width,
+                                 std::size_t height) {
+	m_frame.write([&](FrameSnapshot &frame) {
+		frame.frame = ++m_framesPublished;
+		// the grid uses the same layout, the pixels past MAX_WIDTH are
+		// dropped
+		frame.setRows(rows, wordsPerRow, width, height);
+	});
+}
+
+std::string ControlServer::handle(Client &client, std::string const &line) {
+	std::istringstream stream{line};
+	std::vector<std::string> args;
+	for (std::string arg; stream >> arg;) {
+		args.push_back(arg);
+	}
+	if (args.empty()) {
+		return "error empty request";
+	}
+	const std::string &command = args[0];
+	auto requireArgs = [&args](std::size_t count) {
+		if (args.size() < count + 1) {
+			throw std::invalid_argument(
+			    format("{} expects {} arguments", args[0], count));
+		}
+	};
+	// registers and memory belong to the cpu thread while it runs
+	auto requirePaused = [this]() {
+		if (!m_debugger.isPaused()) {
+			throw std::runtime_error("cpu is running");
+		}
+	};
+	try {
+		if (command == "pause") {
+			m_debugger.pause();
+		} else if (command == "resume") {
+			m_debugger.resume();
+		} else if (command == "step") {
+			m_debugger.step();
+		} else if (command == "status") {
+			return m_debugger.isPaused()
+			           ? format("ok paused {}", m_debugger.getStopReason())
+			           : std::string("ok running");
+		} else if (command == "regs") {
+			requirePaused();
+			return "ok " + formatRegisters();
+		} else if (command == "setreg") {
+			requireArgs(2);
+			requirePaused();
+			const std::string &name = args[1];
+			std::uint16_t value = parse_number(args[2]);
+			if (name.size() == 2 && (name[0] == 'v' || name[0] == 'V')) {
+				m_cpu.registers[fromHexDigit(name[1])] = (std::byte)value;
+			} else if (name == "pc") {
+				m_cpu.pc = value & (Memory::RAM_SIZE - 1);
+			} else if (name == "i") {
+				m_cpu.index = value;
+			} else if (name == "dt") {
+				m_cpu.setDelayTimer((std::byte)value);
+			} else if (name == "st") {
+				m_cpu.setSoundTimer((std::byte)value);
+			} else {
+				throw std::invalid_argument(
+				    format("unknown register {}", name));
+			}
+		} else if (command == "peek") {
+			requireArgs(2);
+			requirePaused();
+			std::uint16_t address = parse_number(args[1]);
+			std::uint16_t size = parse_number(args[2]);
+			if (address + size > Memory::RAM_SIZE) {
+				throw std::invalid_argument("range outside of memory");
+			}
+			return "ok " + toHex(m_memory.get_memory() + address, size);
+		} else if (command == "poke") {
+			requireArgs(2);
+			requirePaused();
+			std::uint16_t address = parse_number(args[1]);
+			const std::string &bytes = args[2];
+			if (bytes.size() % 2 != 0 ||
+			    address + bytes.size() / 2 > Memory::RAM_SIZE) {
+				throw std::invalid_argument("invalid byte string");
+			}
+			std::vector<std::byte> data;
+			for (std::size_t i = 0; i < bytes.size(); i += 2) {
+				data.push_back((std::byte)(fromHexDigit(bytes[i]) << 4 |
+				                           fromHexDigit(bytes[i + 1])));
+			}
+			std::memcpy(m_memory.get_memory() + address, data.data(),
+			            data.size());
+			m_debugger.codeChanged();
+		} else if (command == "break") {
+			requireArgs(1);
+			m_debugger.addBreakpoint(parse_number(args[1]));
+		} else if (command == "delete") {
+			requireArgs(1);
+			m_debugger.removeBreakpoint(parse_number(args[1]));
+		} else if (command == "keys") {
+			requireArgs(1);
+			m_injectedKeys.store(parse_number(args[1]),
+			                     std::memory_order_relaxed);
+		} else if (command == "frame") {
+			return "ok " + formatFrame();
+		} else if (command == "stream") {
+			requireArgs(1);
+			client.streamInterval =
+			    std::chrono::milliseconds(parse_number(args[1]));
+			client.nextStream = std::chrono::steady_clock::now();
+		} else {
+			return format("error unknown command {}", command);
+		}
+	} catch (const std::exception &e) {
+		return format("error {}", e.what());
+	}
+	return "ok";
+}
+
+std::string ControlServer::formatRegisters() {
+	std::string text;
+	for (std::size_t i = 0; i < m_cpu.registers.size(); i++) {
+		text += format("v{:x}={:02x} ", i, (std::uint8_t)m_cpu.registers[i]);
+	}
+	text += format("pc={:#05x} i={:#05x} sp={} dt={} st={}", m_cpu.pc,
+	               m_cpu.index, m_cpu.sp, (std::uint8_t)m_cpu.getDelayTimer(),
+	               (std::uint8_t)m_cpu.getSoundTimer());
+	return text;
+}
+
+std::string ControlServer::formatStats() {
+	StatsSnapshot snapshot;
+	if (!m_stats || !readStatsPage(m_stats->getPage(), snapshot)) {
+		// only the counters are available
+		snapshot.instructions =
+		    m_counters.instructions.load(std::memory_order_relaxed);
+		snapshot.schedulerOverruns =
+		    m_counters.schedulerOverruns.load(std::memory_order_relaxed);
+	}
+	return format("stats instructions={} ips={} frames={} overruns={} "
+	              "missed={} frame_p50_us={} frame_p99_us={} age_p99_us={} "
+	              "input_p99_us={} read_p99_us={}",
+	              snapshot.instructions, snapshot.instructionsPerSecond,
+	              snapshot.framesPresented, snapshot.schedulerOverruns,
+	              snapshot.missedFrames, snapshot.frameTime.percentile(50),
+	              snapshot.frameTime.percentile(99),
+	              snapshot.frameAge.percentile(99),
+	              snapshot.inputLatency.percentile(99),
+	              snapshot.inputReadLatency.percentile(99));
+}
+
+std::string ControlServer::formatFrame() {
+	// send the previous frame again when the main thread kept writing
+	// during every read attempt
+	FrameSnapshot copy;
+	if (m_frame.read(copy)) {
+		m_lastFrame = copy;
+	}
+	const FrameSnapshot &frame = m_lastFrame;
+	std::string text =
+	    format("{} {} {}", frame.width, frame.height, frame.frame);
+	for (std::size_t y = 0; y < frame.height; y++) {
+		text += ' ';
+		for (std::size_t i = 0; i < frame.wordsPerRow; i++) {
+			text += format("{:016x}", frame.rows[y * frame.wordsPerRow + i]);
+		}
+	}
+	return text;
+}
+
+#ifdef CHIP8PP_HAS_UNIX_SOCKETS
+
+ControlServer::ControlServer(std::filesystem::path path, Debugger &debugger,
+                             CPU &cpu, Memory &memory,
+                             StatsCounters const &counters,
+                             StatsPublisher const *stats)
+    : m_path(std::move(path)), m_debugger(debugger), m_cpu(cpu),
+      m_memory(memory), m_counters(counters), m_stats(stats) {
+	sockaddr_un address{};
+	address.sun_family = AF_UNIX;
+	std::string name = m_path.string();
+	if (name.size() >= sizeof(address.sun_path)) {
+		throw std::runtime_error(format("Socket path {} is too long", name));
+	}
+	std::memcpy(address.sun_path, name.c_str(), name.size() + 1);
+	m_listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (m_listenFd < 0) {
+		throw std::runtime_error(
+		    format("Could not create socket: {}", std::strerror(errno)));
+	}
+	// remove a leftover socket of a crashed process
+	unlink(name.c_str());
+	if (bind(m_listenFd, reinterpret_cast<sockaddr *>(&address),
+	         sizeof(address)) != 0 ||
+	    listen(m_listenFd, 8) != 0 || pipe(m_wakePipe.data()) != 0) {
+		int error = errno;
+		close(m_listenFd);
+		throw std::runtime_error(format("Could not listen on {}: {}", name,
+		                                std::strerror(error)));
+	}
+	for (int fd : {m_listenFd, m_wakePipe[0], m_wakePipe[1]}) {
+		fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+	}
+	m_thread = std::jthread([this](std::stop_token token) { serve(token); });
+}
+
+ControlServer::~ControlServer() {
+	m_thread.request_stop();
+	if (m_thread.joinable()) {
+		m_thread.join();
+	}
+	for (auto &client : m_clients) {
+		close(client.fd);
+	}
+	close(m_wakePipe[0]);
+	close(m_wakePipe[1]);
+	close(m_listenFd);
+	unlink(m_path.c_str());
+}
+
+void ControlServer::wake() {
+	char byte = 0;
+	// a full pipe already wakes the server
+	[[maybe_unused]] auto written = write(m_wakePipe[1], &byte, 1);
+}
+
+void ControlServer::serve(std::stop_token stop_token) {
+	std::stop_callback onStop(stop_token, [this]() { wake(); });
+	std::vector<pollfd> fds;
+	while (!stop_token.stop_requested()) {
+		fds.clear();
+		fds.push_back({m_wakePipe[0], POLLIN, 0});
+		fds.push_back({m_listenFd, POLLIN, 0});
+		// sleep until the next stats line is due
+		auto now = std::chrono::steady_clock::now();
+		int timeout = -1;
+		for (auto &client : m_clients) {
+			short events = POLLIN;
+			if (!client.output.empty()) {
+				events |= POLLOUT;
+			}
+			fds.push_back({client.fd, events, 0});
+			if (client.streamInterval.count() > 0) {
+				auto wait = std::chrono::duration_cast<
+				                std::chrono::milliseconds>(client.nextStream -
+				                                           now)
+				                .count();
+				wait = wait < 0 ? 0 : wait;
+				timeout = timeout < 0 ? (int)wait
+				                      : std::min(timeout, (int)wait);
+			}
+		}
+		if (poll(fds.data(), fds.size(), timeout) < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			// nothing to recover, the emulator keeps running without it
+			return;
+		}
+		if (fds[0].revents) {
+			char buffer[64];
+			while (read(m_wakePipe[0], buffer, sizeof(buffer)) > 0) {
+			}
+			continue;
+		}
+		// only the clients polled above have events
+		std::size_t polled = fds.size() - 2;
+		for (std::size_t i = 0; i < polled; i++) {
+			auto &client = m_clients[i];
+			auto revents = fds[i + 2].revents;
+			bool alive = true;
+			if (revents & (POLLIN | POLLHUP | POLLERR)) {
+				alive = readClient(client);
+			}
+			if (alive && (revents & POLLOUT)) {
+				alive = writeClient(client);
+			}
+			if (!alive) {
+				close(client.fd);
+				client.fd = -1;
+			}
+		}
+		if (fds[1].revents & POLLIN) {
+			acceptClients();
+		}
+
+		now = std::chrono::steady_clock::now();
+		for (auto &client : m_clients) {
+			if (client.fd < 0 || client.streamInterval.count() == 0 ||
+			    now < client.nextStream) {
+				continue;
+			}
+			client.output += formatStats() + "\n";
+			client.nextStream += client.streamInterval;
+			if (client.nextStream < now) {
+				// the server fell behind, do not send a burst
+				client.nextStream = now + client.streamInterval;
+			}
+			if (!writeClient(client)) {
+				close(client.fd);
+				client.fd = -1;
+			}
+		}
+		std::erase_if(m_clients,
+		              [](const Client &client) { return client.fd < 0; });
+	}
+}
+
+void ControlServer::acceptClients() {
+	while (true) {
+		int fd = accept(m_listenFd, nullptr, nullptr);
+		if (fd < 0) {
+			return;
+		}
+		fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+		Client client;
+		client.fd = fd;
+		m_clients.push_back(std::move(client));
+	}
+}
+
+bool ControlServer::readClient(Client &client) {
+	char buffer[4096];
+	while (true) {
+		auto received = recv(client.fd, buffer, sizeof(buffer), 0);
+		if (received == 0) {
+			return false;
+		}
+		if (received < 0) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK) {
+				break;
+			}
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		client.input.append(buffer, (std::size_t)received);
+	}
+	std::size_t start = 0;
+	for (auto end = client.input.find('\n'); end != std::string::npos;
+	     end = client.input.find('\n', start)) {
+		std::string line = client.input.substr(start, end - start);
+		if (!line.empty() && line.back() == '\r') {
+			line.pop_back();
+		}
+		client.output += handle(client, line) + "\n";
+		start = end + 1;
+	}
+	client.input.erase(0, start);
+	if (client.input.size() > MAX_PENDING_INPUT) {
+		return false;
+	}
+	return writeClient(client);
+}
+
+bool ControlServer::writeClient(Client &client) {
+	while (!client.output.empty()) {
+		auto sent = send(client.fd, client.output.data(), client.output.size(),
+		                 MSG_NOSIGNAL);
+		if (sent < 0) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK) {
+				break;
+			}
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		client.output.erase(0, (std::size_t)sent);
+	}
+	return client.output.size() <= MAX_PENDING_OUTPUT;
+}
+
+#else
+
+ControlServer::ControlServer(std::filesystem::path path, Debugger &debugger,
+                             CPU &cpu, Memory &memory,
+                             StatsCounters const &counters,
+                             StatsPublisher const *stats)
+    : m_path(std::move(path)), m_debugger(debugger), m_cpu(cpu),
+      m_memory(memory), m_counters(counters), m_stats(stats) {
+	throw std::runtime_error("Unix sockets are not available");
+}
+
+ControlServer::~ControlServer() {}
+
+#endif
+
+} // namespace chip8pp
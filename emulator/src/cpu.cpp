@@ -5,53 +5,101 @@
 
 namespace chip8pp {
 
-void CPU::timerTick() {
-	// lock the mutex
-	std::lock_guard<std::mutex> lock(timers_mutex);
-	// update the timers
-	if ((std::uint8_t)delay_timer > 0) {
-		delay_timer = (std::byte)((std::uint8_t)delay_timer - 1);
+CPUState::CPUState() : rng(std::random_device{}()) {}
+
+template <typename MemoryT> BasicCPU<MemoryT>::BasicCPU() { resetDispatch(); }
+
+void CPUState::seedRandom(std::uint32_t seed) { rng.seed(seed); }
+
+namespace {
+constexpr std::array<std::string_view, static_cast<std::size_t>(
+                                           CPUState::Quirk::COUNT)>
+    quirkNames{"modify-index"};
+} // namespace
+
+std::string_view CPUState::getQuirkName(Quirk quirk) {
+	if (quirk >= Quirk::COUNT) {
+		return "unknown";
+	}
+	return quirkNames[static_cast<std::size_t>(quirk)];
+}
+
+std::optional<CPUState::Quirk> CPUState::parseQuirk(std::string_view name) {
+	for (std::size_t i = 0; i < quirkNames.size(); i++) {
+		if (quirkNames[i] == name) {
+			return static_cast<Quirk>(i);
+		}
+	}
+	return std::nullopt;
+}
+
+template <typename MemoryT> void BasicCPU<MemoryT>::resetDispatch() {
+	auto instructions = getInstructionList<MemoryT>();
+	for (std::size_t i = 0; i < dispatch.size(); i++) {
+		dispatch[i].store(instructions[i], std::memory_order_relaxed);
 	}
-	if ((std::uint8_t)sound_timer > 0) {
-		sound_timer = (std::byte)((std::uint8_t)sound_timer - 1);
+}
+
+namespace {
+// count a timer down without going below 0
+std::uint8_t countDown(std::atomic<std::uint8_t> &timer) {
+	std::uint8_t value = timer.load(std::memory_order_relaxed);
+	while (value > 0 && !timer.compare_exchange_weak(
+	                        value, (std::uint8_t)(value - 1),
+	                        std::memory_order_relaxed)) {
+	}
+	return value;
+}
+// a new sound timer value, counted as one more change
+std::uint32_t nextSoundState(std::uint32_t state, std::uint8_t value) {
+	return (((state >> 8) + 1) << 8) | value;
+}
+} // namespace
+
+std::uint8_t CPUState::timerTick() {
+	if (timers_held.load(std::memory_order_relaxed)) {
+		return 0;
+	}
+	countDown(delay_timer);
+	// the cpu may write the sound timer at the same time
+	std::uint32_t state = sound_state.load(std::memory_order_relaxed);
+	while ((state & 0xFF) > 0 &&
+	       !sound_state.compare_exchange_weak(
+	           state, nextSoundState(state, (std::uint8_t)(state - 1)),
+	           std::memory_order_release, std::memory_order_relaxed)) {
 	}
+	return (std::uint8_t)state;
 }
 
-std::byte CPU::getDelayTimer() {
-	// lock the mutex
-	std::lock_guard<std::mutex> lock(timers_mutex);
-	// return the delay timer
-	return delay_timer;
+std::byte CPUState::getDelayTimer() {
+	return (std::byte)delay_timer.load(std::memory_order_relaxed);
 }
 
-std::byte CPU::getSoundTimer() {
-	// lock the mutex
-	std::lock_guard<std::mutex> lock(timers_mutex);
-	// return the sound timer
-	return sound_timer;
+std::byte CPUState::getSoundTimer() {
+	return (std::byte)sound_state.load(std::memory_order_acquire);
 }
 
-void CPU::setDelayTimer(std::byte value) {
-	// lock the mutex
-	std::lock_guard<std::mutex> lock(timers_mutex);
-	// set the delay timer
-	delay_timer = value;
+void CPUState::setDelayTimer(std::byte value) {
+	delay_timer.store((std::uint8_t)value, std::memory_order_relaxed);
 }
 
-void CPU::setSoundTimer(std::byte value) {
-	// lock the mutex
-	std::lock_guard<std::mutex> lock(timers_mutex);
-	// set the sound timer
-	sound_timer = value;
+void CPUState::setSoundTimer(std::byte value) {
+	std::uint32_t state = sound_state.load(std::memory_order_relaxed);
+	while (!sound_state.compare_exchange_weak(
+	    state, nextSoundState(state, (std::uint8_t)value),
+	    std::memory_order_release, std::memory_order_relaxed)) {
+	}
 }
 
-std::uint16_t CPU::fetch(Memory &memory) {
-	std::uint16_t opcode = memory.get_word(pc);
-	pc = (pc + 2) & 0x0FFF;
+template <typename MemoryT>
+std::uint16_t BasicCPU<MemoryT>::fetch(MemoryT &memory) {
+	instruction_pc = pc;
+	std::uint16_t opcode = memory.fetch_word(pc);
+	pc = (pc + 2) & MemoryT::ADDRESS_MASK;
 	return opcode;
 }
 
-Instruction CPU::decode(std::uint16_t opcode) {
+Instruction CPUState::decode(std::uint16_t opcode) {
 	// Decode the instruction into a struct
 	// - Instruction : the instruction (1st nibble)
 	// - X           : the 2nd nibble
@@ -70,18 +118,27 @@ Instruction CPU::decode(std::uint16_t opcode) {
 	return instruction;
 }
 
-bool CPU::execute(Instruction instruction, Memory &memory, Screen &screen,
-                  Keypad &keypad) {
-	// get the instruction list
-	static auto instructions = getInstructionList();
+template <typename MemoryT>
+Trap BasicCPU<MemoryT>::execute(Instruction instruction, MemoryT &memory,
+                                Screen &screen, Keypad &keypad) {
+	Trap result = Trap::InvalidOpcode;
 	// check that the instruction is not out of bounds
-	if (instruction.instruction >= InstructionEnum::COUNT) {
-		return false;
+	if (instruction.instruction < InstructionEnum::COUNT) [[likely]] {
+		// execute the instruction, a relaxed load is a plain load
+		BasicInstructionCallback<MemoryT> callback =
+		    dispatch[static_cast<std::size_t>(instruction.instruction)].load(
+		        std::memory_order_relaxed);
+		result = callback(instruction, *this, memory, screen, keypad);
 	}
-	// execute the instruction
-	instructions[static_cast<std::size_t>(instruction.instruction)](
-	    instruction, *this, memory, screen, keypad);
-	return true;
+	if (result != Trap::None) [[unlikely]] {
+		trap = result;
+		trap_pc = instruction_pc;
+		trap_opcode = instruction.opcode;
+	}
+	return result;
 }
 
+template struct BasicCPU<Memory>;
+template struct BasicCPU<XoChipMemory>;
+
 } // namespace chip8pp
@@ -0,0 +1,193 @@
+#include <chip8pp/debugConsole.hpp>
+#include <chip8pp/disassembler.hpp>
+#include <chip8pp/utils.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+// check if format is available
+#if __has_include(<format>)
+#include <format>
+using std::format;
+// if not, use fmt
+#elif __has_include(<fmt/format.h>)
+#include <fmt/format.h>
+using fmt::format;
+#else
+#error "No <format> or <fmt/format.h> found"
+#endif
+
+#if __has_include(<poll.h>)
+#define CHIP8PP_HAS_POLL 1
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace chip8pp {
+
+namespace {
+constexpr const char *HELP =
+    "commands:\n"
+    "  pause | p                 stop before the next instruction\n"
+    "  continue | c              resume the execution\n"
+    "  step | s                  execute a single instruction\n"
+    "  break | b [addr]          add a breakpoint, or list them\n"
+    "  delete | d <addr>         remove a breakpoint\n"
+    "  watch | w <addr>[-<end>]  stop after a store into the range\n"
+    "  unwatch                   remove every watchpoint\n"
+    "  cond <vx>=<value>         stop when a register becomes value\n"
+    "  uncond                    remove every register condition\n"
+    "  regs | r                  show the registers (paused)\n"
+    "  mem | m <addr> [size]     show memory (paused)\n"
+    "  list | l [addr] [count]   disassemble, defaults to pc (paused)\n"
+    "  status                    show the cpu state\n"
+    "numbers use the C syntax (0x200, 512)\n";
+
+using utils::parse_number;
+} // namespace
+
+DebugConsole::DebugConsole(Debugger &debugger, CPU &cpu, Memory &memory)
+    : m_debugger(debugger), m_cpu(cpu), m_memory(memory) {}
+
+void DebugConsole::execute(std::string_view line, std::ostream &out) {
+	std::istringstream stream{std::string(line)};
+	std::vector<std::string> args;
+	for (std::string arg; stream >> arg;) {
+		args.push_back(arg);
+	}
+	if (args.empty()) {
+		return;
+	}
+	const std::string &command = args[0];
+	bool paused = m_debugger.isPaused();
+	try {
+		if (command == "help" || command == "h") {
+			out << HELP;
+		} else if (command == "pause" || command == "p") {
+			m_debugger.pause();
+		} else if (command == "continue" || command == "c") {
+			m_debugger.resume();
+		} else if (command == "step" || command == "s") {
+			m_debugger.step();
+		} else if ((command == "break" || command == "b") && args.size() > 1) {
+			m_debugger.addBreakpoint(parse_number(args[1]));
+		} else if (command == "break" || command == "b") {
+			for (auto address : m_debugger.getBreakpoints()) {
+				out << format("breakpoint {:#05x}\n", address);
+			}
+		} else if ((command == "delete" || command == "d") &&
+		           args.size() > 1) {
+			m_debugger.removeBreakpoint(parse_number(args[1]));
+		} else if ((command == "watch" || command == "w") && args.size() > 1) {
+			auto separator = args[1].find('-');
+			auto begin = parse_number(args[1].substr(0, separator));
+			auto end = separator == std::string::npos
+			               ? begin
+			               : parse_number(args[1].substr(separator + 1));
+			m_debugger.addWatchpoint(begin, end);
+		} else if (command == "unwatch") {
+			m_debugger.clearWatchpoints();
+		} else if (command == "cond" && args.size() > 1) {
+			auto separator = args[1].find('=');
+			if (separator != 2 || (args[1][0] != 'v' && args[1][0] != 'V')) {
+				throw std::invalid_argument("expected vx=value");
+			}
+			auto reg = parse_number("0x" + args[1].substr(1, 1));
+			m_debugger.addRegisterCondition(
+			    (std::uint8_t)reg,
+			    (std::uint8_t)parse_number(args[1].substr(separator + 1)));
+		} else if (command == "uncond") {
+			m_debugger.clearRegisterConditions();
+		} else if (command == "status") {
+			out << (paused ? format("paused: {}\n",
+			                        m_debugger.getStopReason())
+			               : std::string("running\n"));
+		} else if (command == "regs" || command == "r" || command == "mem" ||
+		           command == "m" || command == "list" || command == "l") {
+			if (!paused) {
+				out << "the cpu is running, pause it first\n";
+			} else if (command == "regs" || command == "r") {
+				printRegisters(out);
+			} else if ((command == "mem" || command == "m") &&
+			           args.size() > 1) {
+				printMemory(parse_number(args[1]),
+				            args.size() > 2 ? parse_number(args[2]) : 64, out);
+			} else if (command == "list" || command == "l") {
+				printListing(args.size() > 1 ? parse_number(args[1])
+				                             : m_cpu.pc,
+				             args.size() > 2 ? parse_number(args[2]) : 8, out);
+			} else {
+				out << "missing address\n";
+			}
+		} else {
+			out << format("unknown command {}, try help\n", command);
+		}
+	} catch (const std::exception &e) {
+		out << format("error: {}\n", e.what());
+	}
+}
+
+void DebugConsole::run(std::stop_token stop_token) {
+	std::string line;
+	while (!stop_token.stop_requested()) {
+#ifdef CHIP8PP_HAS_POLL
+		// wait for input with a timeout to notice stop requests
+		pollfd input{STDIN_FILENO, POLLIN, 0};
+		if (poll(&input, 1, 100) <= 0) {
+			continue;
+		}
+#endif
+		if (!std::getline(std::cin, line)) {
+			break;
+		}
+		execute(line, std::cout);
+		std::cout << std::flush;
+	}
+}
+
+void DebugConsole::printRegisters(std::ostream &out) {
+	for (std::size_t i = 0; i < m_cpu.registers.size(); i++) {
+		out << format("V{:X}={:02x}{}", i, (std::uint8_t)m_cpu.registers[i],
+		              i % 8 == 7 ? '\n' : ' ');
+	}
+	out << format("PC={:#05x} I={:#05x} SP={} DT={} ST={}\n", m_cpu.pc,
+	              m_cpu.index, m_cpu.sp, (std::uint8_t)m_cpu.getDelayTimer(),
+	              (std::uint8_t)m_cpu.getSoundTimer());
+	for (std::size_t i = 0; i < m_cpu.sp && i < m_cpu.stack.size(); i++) {
+		out << format("  stack[{}]={:#05x}\n", i, m_cpu.stack[i]);
+	}
+}
+
+void DebugConsole::printMemory(std::uint16_t address, std::size_t size,
+                               std::ostream &out) {
+	const std::byte *memory = m_memory.get_memory();
+	for (std::size_t offset = 0; offset < size; offset++) {
+		auto current = (address + offset) & (Memory::RAM_SIZE - 1);
+		if (offset % 16 == 0) {
+			out << format("{:03x}:", current);
+		}
+		out << format(" {:02x}", (std::uint8_t)memory[current]);
+		if (offset % 16 == 15 || offset + 1 == size) {
+			out << '\n';
+		}
+	}
+}
+
+void DebugConsole::printListing(std::uint16_t address, std::size_t count,
+                                std::ostream &out) {
+	const std::byte *memory = m_memory.get_memory();
+	for (std::size_t i = 0; i < count; i++) {
+		auto current = (address + i * 2) & (Memory::RAM_SIZE - 1);
+		auto opcode = (std::uint16_t)(
+		    ((std::uint16_t)memory[current] << 8) |
+		    (std::uint16_t)memory[(current + 1) & (Memory::RAM_SIZE - 1)]);
+		out << format("{}{:03x}: {:04x}  {}\n",
+		              current == m_cpu.pc ? "> " : "  ", current, opcode,
+		              disassemble(CPU::decode(opcode)));
+	}
+}
+
+} // namespace chip8pp
@@ -0,0 +1,365 @@
+#include <chip8pp/debugger.hpp>
+#include <cstddef>
+#include <cstdint>
+// check if format is available
+#if __has_include(<format>)
+#include <format>
+using std::format;
+// if not, use fmt
+#elif __has_include(<fmt/format.h>)
+#include <fmt/format.h>
+using fmt::format;
+#else
+#error "No <format> or <fmt/format.h> found"
+#endif
+
+namespace chip8pp {
+
+namespace {
+bool isStore(InstructionEnum instruction) {
+	return instruction == InstructionEnum::LD_B_VX ||
+	       instruction == InstructionEnum::LD_I_VX;
+}
+
+std::size_t kindAt(const std::byte *memory, std::size_t address,
+                   std::size_t size) {
+	auto opcode =
+	    (std::uint16_t)(((std::uint16_t)memory[address] << 8) |
+	                    (std::uint16_t)memory[(address + 1) & (size - 1)]);
+	return static_cast<std::size_t>(Instruction::decodeOpCode(opcode));
+}
+} // namespace
+
+Debugger::Debugger(CPU &cpu, Memory &memory) : m_cpu(cpu), m_memory(memory) {
+	for (auto &condition : m_conditions) {
+		condition.store(-1, std::memory_order_relaxed);
+	}
+	m_cpu.debugger = this;
+}
+
+Debugger::~Debugger() {
+	m_cpu.resetDispatch();
+	m_cpu.timers_held.store(false);
+	m_cpu.debugger = nullptr;
+}
+
+void Debugger::pause() {
+	std::lock_guard<std::mutex> lock{m_controlMutex};
+	m_stopAll.store(true);
+	rebuildDispatch();
+}
+
+void Debugger::resume() {
+	std::lock_guard<std::mutex> lock{m_controlMutex};
+	m_stopAll.store(false);
+	m_stepping.store(false);
+	rebuildDispatch();
+	m_cpu.timers_held.store(false);
+	m_paused.store(false);
+	m_wake.fetch_add(1);
+	m_wake.notify_all();
+}
+
+void Debugger::step() {
+	std::lock_guard<std::mutex> lock{m_controlMutex};
+	// let exactly one instruction run, the next one is intercepted
+	m_stepping.store(true);
+	m_stopAll.store(true);
+	rebuildDispatch();
+	m_paused.store(false);
+	m_wake.fetch_add(1);
+	m_wake.notify_all();
+}
+
+bool Debugger::isPaused() const { return m_paused.load(); }
+
+void Debugger::addBreakpoint(std::uint16_t address) {
+	std::lock_guard<std::mutex> lock{m_controlMutex};
+	address &= ADDRESSES - 1;
+	if (!test(m_breakpoints, address)) {
+		assign(m_breakpoints, address, true);
+		m_breakpointCount++;
+	}
+	rebuildDispatch();
+}
+
+void Debugger::removeBreakpoint(std::uint16_t address) {
+	std::lock_guard<std::mutex> lock{m_controlMutex};
+	address &= ADDRESSES - 1;
+	if (test(m_breakpoints, address)) {
+		assign(m_breakpoints, address, false);
+		m_breakpointCount--;
+	}
+	rebuildDispatch();
+}
+
+std::vector<std::uint16_t> Debugger::getBreakpoints() const {
+	std::vector<std::uint16_t> breakpoints;
+	for (std::size_t address = 0; address < ADDRESSES; address++) {
+		if (test(m_breakpoints, (std::uint16_t)address)) {
+			breakpoints.push_back((std::uint16_t)address);
+		}
+	}
+	return breakpoints;
+}
+
+void Debugger::addWatchpoint(std::uint16_t begin, std::uint16_t end) {
+	std::lock_guard<std::mutex> lock{m_controlMutex};
+	for (std::size_t address = begin; address <= end && address < ADDRESSES;
+	     address++) {
+		assign(m_watchpoints, (std::uint16_t)address, true);
+	}
+	m_watchpointCount++;
+	rebuildDispatch();
+}
+
+void Debugger::clearWatchpoints() {
+	std::lock_guard<std::mutex> lock{m_controlMutex};
+	for (auto &word : m_watchpoints) {
+		word.store(0);
+	}
+	m_watchpointCount = 0;
+	rebuildDispatch();
+}
+
+void Debugger::addRegisterCondition(std::uint8_t reg, std::uint8_t value) {
+	std::lock_guard<std::mutex> lock{m_controlMutex};
+	if (m_conditions[reg & 0xF].exchange(value) < 0) {
+		m_conditionCount++;
+	}
+	rebuildDispatch();
+}
+
+void Debugger::clearRegisterConditions() {
+	std::lock_guard<std::mutex> lock{m_controlMutex};
+	for (auto &condition : m_conditions) {
+		condition.store(-1);
+	}
+	m_conditionCount = 0;
+	rebuildDispatch();
+}
+
+void Debugger::codeChanged() {
+	std::lock_guard<std::mutex> lock{m_controlMutex};
+	rebuildDispatch();
+}
+
+std::uint64_t Debugger::packStop(StopKind kind, std::uint16_t address,
+                                 std::uint16_t first, std::uint16_t second) {
+	return (std::uint64_t)kind << 48 | (std::uint64_t)address << 32 |
+	       (std::uint64_t)first << 16 | second;
+}
+
+std::string Debugger::getStopReason() const {
+	std::uint64_t reason = m_stopReason.load(std::memory_order_acquire);
+	auto address = (std::uint16_t)(reason >> 32);
+	auto first = (std::uint16_t)(reason >> 16);
+	auto second = (std::uint16_t)reason;
+	switch (static_cast<StopKind>(reason >> 48)) {
+	case StopKind::None:
+		return "";
+	case StopKind::Stopped:
+		return format("stopped at {:#05x}", address);
+	case StopKind::Breakpoint:
+		return format("breakpoint at {:#05x}", address);
+	case StopKind::Watchpoint:
+		return format("watchpoint {:#05x}-{:#05x} written at {:#05x}", first,
+		              second, address);
+	case StopKind::Condition:
+		return format("V{:X} == {:#04x} after {:#05x}", first, second,
+		              address);
+	}
+	return "";
+}
+
+bool Debugger::test(const Bitmap &bitmap, std::uint16_t address) {
+	return (bitmap[address / 64].load(std::memory_order_relaxed) >>
+	        (address % 64)) &
+	       1;
+}
+
+void Debugger::assign(Bitmap &bitmap, std::uint16_t address, bool value) {
+	std::uint64_t bit = std::uint64_t(1) << (address % 64);
+	if (value) {
+		bitmap[address / 64].fetch_or(bit);
+	} else {
+		bitmap[address / 64].fetch_and(~bit);
+	}
+}
+
+bool Debugger::anyWatched(std::uint16_t begin, std::uint16_t end) const {
+	for (std::size_t address = begin; address <= end; address++) {
+		if (test(m_watchpoints, address & (ADDRESSES - 1))) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool Debugger::anyBreakpoint(std::uint16_t begin, std::uint16_t end) const {
+	// a breakpoint covers both opcode bytes, start at the one before begin
+	for (std::size_t address = begin + ADDRESSES - 1;
+	     address <= end + ADDRESSES; address++) {
+		if (test(m_breakpoints, address & (ADDRESSES - 1))) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void Debugger::interceptBreakpoints(std::uint16_t begin, std::uint16_t end) {
+	const std::byte *memory = m_memory.get_memory();
+	for (std::size_t address = begin + ADDRESSES - 1;
+	     address <= end + ADDRESSES; address++) {
+		std::size_t wrapped = address & (ADDRESSES - 1);
+		if (test(m_breakpoints, (std::uint16_t)wrapped)) {
+			m_cpu.dispatch[kindAt(memory, wrapped, ADDRESSES)].store(
+			    &Debugger::intercept);
+		}
+	}
+}
+
+void Debugger::rebuildDispatch() {
+	// the memory is decoded below, a later overwrite sets the flag again
+	m_codeOverwritten.store(false);
+	auto instructions = getInstructionList();
+	std::array<bool, static_cast<std::size_t>(InstructionEnum::COUNT)>
+	    intercepted{};
+	bool all = m_stopAll.load() || m_conditionCount > 0;
+	if (m_breakpointCount > 0) {
+		// intercept the instruction kinds found at the breakpoints
+		const std::byte *memory = m_memory.get_memory();
+		for (std::size_t address = 0; address < ADDRESSES; address++) {
+			if (test(m_breakpoints, (std::uint16_t)address)) {
+				intercepted[kindAt(memory, address, ADDRESSES)] = true;
+			}
+		}
+	}
+	if (m_breakpointCount > 0 || m_watchpointCount > 0) {
+		intercepted[static_cast<std::size_t>(InstructionEnum::LD_B_VX)] = true;
+		intercepted[static_cast<std::size_t>(InstructionEnum::LD_I_VX)] = true;
+	}
+	// sequentially consistent with m_codeOverwritten: either the cpu widens
+	// the table after these stores, or the flag is seen set below and the
+	// breakpoints are decoded again
+	for (std::size_t i = 0; i < m_cpu.dispatch.size(); i++) {
+		m_cpu.dispatch[i].store(all || intercepted[i] ? &Debugger::intercept
+		                                              : instructions[i]);
+	}
+	if (m_codeOverwritten.load()) {
+		interceptBreakpoints(0, ADDRESSES - 1);
+	}
+}
+
+Trap Debugger::intercept(Instruction instruction, CPU &cpu, Memory &memory,
+                         Screen &screen, Keypad &keypad) {
+	return cpu.debugger->check(instruction, memory, screen, keypad);
+}
+
+Trap Debugger::stopBefore(std::uint64_t reason) {
+	// rewind so the instruction runs when the cpu is resumed
+	m_cpu.pc = m_cpu.instruction_pc;
+	m_pendingInstruction = true;
+	m_stopReason.store(reason, std::memory_order_release);
+	// the timers and the beep stop with the rom
+	m_cpu.timers_held.store(true);
+	m_paused.store(true);
+	return Trap::Breakpoint;
+}
+
+Trap Debugger::stopAfter(std::uint64_t reason) {
+	m_pendingInstruction = false;
+	m_stopReason.store(reason, std::memory_order_release);
+	m_cpu.timers_held.store(true);
+	m_paused.store(true);
+	return Trap::Breakpoint;
+}
+
+Trap Debugger::check(Instruction instruction, Memory &memory, Screen &screen,
+                     Keypad &keypad) {
+	// JP V0, NNN can leave the pc past the end of memory, fetch wraps it
+	std::uint16_t address = m_cpu.instruction_pc & (ADDRESSES - 1);
+	if (m_stopAll.load(std::memory_order_relaxed)) {
+		// a pending step lets one instruction through
+		if (!m_stepping.exchange(false)) {
+			return stopBefore(packStop(StopKind::Stopped, address));
+		}
+	} else if (test(m_breakpoints, address)) {
+		return stopBefore(packStop(StopKind::Breakpoint, address));
+	}
+
+	std::uint16_t index = m_cpu.index;
+	InstructionCallback original =
+	    getInstructionList()[static_cast<std::size_t>(instruction.instruction)];
+	Trap result = original(instruction, m_cpu, memory, screen, keypad);
+	if (result != Trap::None) {
+		return result;
+	}
+
+	if (isStore(instruction.instruction)) {
+		std::uint16_t end =
+		    index + (instruction.instruction == InstructionEnum::LD_B_VX
+		                 ? 2
+		                 : (std::uint8_t)instruction.x);
+		if (anyBreakpoint(index, end)) {
+			// the code under a breakpoint changed, intercept the instruction
+			// kind it holds now
+			m_codeOverwritten.store(true);
+			interceptBreakpoints(index, end);
+		}
+		if (anyWatched(index, end)) {
+			return stopAfter(
+			    packStop(StopKind::Watchpoint, address, index, end));
+		}
+	}
+
+	for (std::size_t reg = 0; reg < m_conditions.size(); reg++) {
+		auto expected = m_conditions[reg].load(std::memory_order_relaxed);
+		if (expected < 0) {
+			continue;
+		}
+		// only stop when the register starts matching
+		bool matched = (std::int16_t)m_cpu.registers[reg] == expected;
+		bool triggered = matched && !m_conditionMatched[reg];
+		m_conditionMatched[reg] = matched;
+		if (triggered) {
+			return stopAfter(packStop(StopKind::Condition, address,
+			                          (std::uint16_t)reg,
+			                          (std::uint16_t)expected));
+		}
+	}
+	return Trap::None;
+}
+
+bool Debugger::waitWhilePaused(std::stop_token stop_token) {
+	// wake the waiting loop when a stop is requested
+	std::stop_callback wake(stop_token, [this]() {
+		m_wake.fetch_add(1);
+		m_wake.notify_all();
+	});
+	while (m_paused.load() && !stop_token.stop_requested()) {
+		auto generation = m_wake.load();
+		if (!m_paused.load() || stop_token.stop_requested()) {
+			break;
+		}
+		m_wake.wait(generation);
+	}
+	return !stop_token.stop_requested();
+}
+
+Trap Debugger::executeResumed(Instruction instruction, Screen &screen,
+                              Keypad &keypad) {
+	m_pendingInstruction = false;
+	m_stepping.store(false);
+	InstructionCallback original =
+	    getInstructionList()[static_cast<std::size_t>(instruction.instruction)];
+	Trap result = original(instruction, m_cpu, m_memory, screen, keypad);
+	if (result != Trap::None) {
+		m_cpu.trap = result;
+		m_cpu.trap_pc = m_cpu.instruction_pc;
+		m_cpu.trap_opcode = instruction.opcode;
+	}
+	return result;
+}
+
+} // namespace chip8pp
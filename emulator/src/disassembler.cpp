@@ -0,0 +1,124 @@
+#include <chip8pp/disassembler.hpp>
+#include <chip8pp/instructions.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+// check if format is available
+#if __has_include(<format>)
+#include <format>
+using std::format;
+// if not, use fmt
+#elif __has_include(<fmt/format.h>)
+#include <fmt/format.h>
+using fmt::format;
+#else
+#error "No <format> or <fmt/format.h> found"
+#endif
+
+namespace chip8pp {
+
+std::string disassemble(const Instruction &instruction) {
+	auto x = (std::uint8_t)instruction.x;
+	auto y = (std::uint8_t)instruction.y;
+	auto n = (std::uint8_t)instruction.n;
+	auto nn = (std::uint8_t)instruction.nn;
+	auto nnn = instruction.nnn;
+	switch (instruction.instruction) {
+	case InstructionEnum::SYS:
+		return format("SYS {:#05x}", nnn);
+	case InstructionEnum::CLS:
+		return "CLS";
+	case InstructionEnum::RET:
+		return "RET";
+	case InstructionEnum::JMP_NNN:
+		return format("JP {:#05x}", nnn);
+	case InstructionEnum::CALL_NNN:
+		return format("CALL {:#05x}", nnn);
+	case InstructionEnum::SE_VX_NN:
+		return format("SE V{:X}, {:#04x}", x, nn);
+	case InstructionEnum::SNE_VX_NN:
+		return format("SNE V{:X}, {:#04x}", x, nn);
+	case InstructionEnum::SE_VX_VY:
+		return format("SE V{:X}, V{:X}", x, y);
+	case InstructionEnum::LD_VX_NN:
+		return format("LD V{:X}, {:#04x}", x, nn);
+	case InstructionEnum::ADD_VX_NN:
+		return format("ADD V{:X}, {:#04x}", x, nn);
+	case InstructionEnum::LD_VX_VY:
+		return format("LD V{:X}, V{:X}", x, y);
+	case InstructionEnum::OR_VX_VY:
+		return format("OR V{:X}, V{:X}", x, y);
+	case InstructionEnum::AND_VX_VY:
+		return format("AND V{:X}, V{:X}", x, y);
+	case InstructionEnum::XOR_VX_VY:
+		return format("XOR V{:X}, V{:X}", x, y);
+	case InstructionEnum::ADD_VX_VY:
+		return format("ADD V{:X}, V{:X}", x, y);
+	case InstructionEnum::SUB_VX_VY:
+		return format("SUB V{:X}, V{:X}", x, y);
+	case InstructionEnum::SHR_VX_VY:
+		return format("SHR V{:X}, V{:X}", x, y);
+	case InstructionEnum::SUBN_VX_VY:
+		return format("SUBN V{:X}, V{:X}", x, y);
+	case InstructionEnum::SHL_VX_VY:
+		return format("SHL V{:X}, V{:X}", x, y);
+	case InstructionEnum::SNE_VX_VY:
+		return format("SNE V{:X}, V{:X}", x, y);
+	case InstructionEnum::LD_I_NNN:
+		return format("LD I, {:#05x}", nnn);
+	case InstructionEnum::JMP_V0_NNN:
+		return format("JP V0, {:#05x}", nnn);
+	case InstructionEnum::RND_VX_NN:
+		return format("RND V{:X}, {:#04x}", x, nn);
+	case InstructionEnum::DRW_VX_VY_N:
+		return format("DRW V{:X}, V{:X}, {}", x, y, n);
+	case InstructionEnum::SKP_VX:
+		return format("SKP V{:X}", x);
+	case InstructionEnum::SKNP_VX:
+		return format("SKNP V{:X}", x);
+	case InstructionEnum::LD_VX_DT:
+		return format("LD V{:X}, DT", x);
+	case InstructionEnum::LD_VX_K:
+		return format("LD V{:X}, K", x);
+	case InstructionEnum::LD_DT_VX:
+		return format("LD DT, V{:X}", x);
+	case InstructionEnum::LD_ST_VX:
+		return format("LD ST, V{:X}", x);
+	case InstructionEnum::ADD_I_VX:
+		return format("ADD I, V{:X}", x);
+	case InstructionEnum::LD_F_VX:
+		return format("LD F, V{:X}", x);
+	case InstructionEnum::LD_B_VX:
+		return format("LD B, V{:X}", x);
+	case InstructionEnum::LD_I_VX:
+		return format("LD [I], V{:X}", x);
+	case InstructionEnum::LD_VX_I:
+		return format("LD V{:X}, [I]", x);
+	case InstructionEnum::SCD_N:
+		return format("SCD {}", n);
+	case InstructionEnum::SCR:
+		return "SCR";
+	case InstructionEnum::SCL:
+		return "SCL";
+	case InstructionEnum::EXIT:
+		return "EXIT";
+	case InstructionEnum::LOW:
+		return "LOW";
+	case InstructionEnum::HIGH:
+		return "HIGH";
+	case InstructionEnum::LD_HF_VX:
+		return format("LD HF, V{:X}", x);
+	case InstructionEnum::LD_R_VX:
+		return format("LD R, V{:X}", x);
+	case InstructionEnum::LD_VX_R:
+		return format("LD V{:X}, R", x);
+	case InstructionEnum::LD_I_LONG:
+		// the address is the next word
+		return "LD I, LONG";
+	default:
+		// anything else is emitted as raw data
+		return format("DW {:#06x}", instruction.opcode);
+	}
+}
+
+} // namespace chip8pp
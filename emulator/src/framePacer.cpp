@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <chip8pp/framePacer.hpp>
+#include <string_view>
+#include <thread>
+// check if format is available
+#if __has_include(<format>)
+#include <format>
+using std::format;
+// if not, use fmt
+#elif __has_include(<fmt/format.h>)
+#include <fmt/format.h>
+using fmt::format;
+#else
+#error "No <format> or <fmt/format.h> found"
+#endif
+
+namespace chip8pp {
+
+namespace {
+// sleeps may overshoot by about this much, the rest is spun
+constexpr std::chrono::milliseconds SPIN_MARGIN{1};
+// with vsync the frame is prepared this long before the vertical blank
+constexpr std::chrono::microseconds VSYNC_LEAD{2000};
+
+std::string formatHistogram(std::string_view name,
+                            Histogram const &histogram) {
+	return format("{}: {} frames, p50 {:.2f}ms p99 {:.2f}ms max {:.2f}ms\n",
+	              name, histogram.count,
+	              (double)histogram.percentile(50) / 1000.0,
+	              (double)histogram.percentile(99) / 1000.0,
+	              (double)histogram.maxNs / 1e6);
+}
+} // namespace
+
+FramePacer::FramePacer(clock::duration period, bool vsync)
+    : m_period(period), m_vsync(vsync), m_deadline(clock::now()) {}
+
+FramePacer::clock::time_point FramePacer::getDeadline() const {
+	return m_deadline;
+}
+
+FramePacer::clock::duration
+FramePacer::getSleepTime(clock::time_point now) const {
+	return std::max(m_deadline - SPIN_MARGIN - now, clock::duration::zero());
+}
+
+void FramePacer::finishWait() {
+	auto now = clock::now();
+	while (now < m_deadline) {
+		std::this_thread::yield();
+		now = clock::now();
+	}
+}
+
+void FramePacer::frameDone(bool presented, clock::time_point published,
+                           clock::time_point now) {
+	if (presented) {
+		// only the interval between two presents in a row, an unchanged
+		// frame in between is idle time and not a stall
+		if (m_lastPresent) {
+			m_presentInterval.record(now - *m_lastPresent);
+		}
+		m_lastPresent = now;
+		// nothing was published before the first frame
+		if (published != clock::time_point{}) {
+			m_frameAge.record(now - published);
+		}
+		if (published != m_lastPublished) {
+			// a new frame is missed when it reaches the screen a period or
+			// more after its deadline, with vsync the present returns at
+			// the blank a little after the deadline
+			auto late = std::max(now - m_deadline, clock::duration::zero());
+			m_missedFrames += (std::uint64_t)(late / m_period);
+			m_lastPublished = published;
+		}
+	} else {
+		m_lastPresent.reset();
+	}
+	if (m_vsync && presented) {
+		// the present returned at the vertical blank
+		auto lead = std::min<clock::duration>(VSYNC_LEAD, m_period / 4);
+		m_deadline = now + m_period - lead;
+		return;
+	}
+	m_deadline += m_period;
+	if (now >= m_deadline) {
+		// the loop fell behind, skip the deadlines but keep the phase
+		m_deadline += ((now - m_deadline) / m_period + 1) * m_period;
+	}
+}
+
+FramePacer::clock::duration FramePacer::getPeriod() const { return m_period; }
+
+bool FramePacer::hasVSync() const { return m_vsync; }
+
+Histogram const &FramePacer::getPresentInterval() const {
+	return m_presentInterval;
+}
+
+Histogram const &FramePacer::getFrameAge() const { return m_frameAge; }
+
+std::uint64_t FramePacer::getMissedFrames() const { return m_missedFrames; }
+
+std::string FramePacer::summary() const {
+	return format(
+	    "frame pacing: {} at {:.2f}Hz, {} missed deadlines\n",
+	    m_vsync ? "vsync" : "deadline",
+	    1.0 / std::chrono::duration<double>(m_period).count(),
+	    m_missedFrames) +
+	       formatHistogram("present interval", m_presentInterval) +
+	       formatHistogram("frame age", m_frameAge);
+}
+
+} // namespace chip8pp
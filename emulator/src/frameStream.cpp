@@ -0,0 +1,257 @@
+#include <algorithm>
+#include <chip8pp/frameStream.hpp>
+#include <cstring>
+#include <stdexcept>
+// check if format is available
+#if __has_include(<format>)
+#include <format>
+using std::format;
+// if not, use fmt
+#elif __has_include(<fmt/format.h>)
+#include <fmt/format.h>
+using fmt::format;
+#else
+#error "No <format> or <fmt/format.h> found"
+#endif
+
+namespace chip8pp {
+
+namespace {
+// how often the writer thread encodes the queued frames
+constexpr std::chrono::milliseconds DRAIN_INTERVAL{10};
+
+void append(std::vector<char> &out, const void *data, std::size_t size) {
+	auto bytes = static_cast<const char *>(data);
+	out.insert(out.end(), bytes, bytes + size);
+}
+
+// LEB128, 7 bits per byte with the high bit set on all but the last one
+void appendVarint(std::vector<char> &out, std::uint64_t value) {
+	while (value >= 0x80) {
+		out.push_back((char)((value & 0x7F) | 0x80));
+		value >>= 7;
+	}
+	out.push_back((char)value);
+}
+} // namespace
+
+FrameStreamWriter::FrameStreamWriter(std::filesystem::path const &path,
+                                     std::uint16_t keyframeInterval,
+                                     std::size_t queueFrames)
+    : m_queue(queueFrames) {
+	if (keyframeInterval == 0) {
+		throw std::runtime_error("Keyframe interval must not be 0");
+	}
+	m_file.open(path, std::ios::binary | std::ios::out | std::ios::trunc);
+	if (!m_file.is_open()) {
+		throw std::runtime_error(
+		    format("Could not open frame stream {}", path.string()));
+	}
+	m_header.keyframeInterval = keyframeInterval;
+	m_file.write(reinterpret_cast<const char *>(&m_header), sizeof(m_header));
+	m_thread = std::jthread(
+	    [this](std::stop_token stop_token) { writer_thread_fn(stop_token); });
+}
+
+FrameStreamWriter::~FrameStreamWriter() {
+	m_thread.request_stop();
+	if (m_thread.joinable()) {
+		m_thread.join();
+	}
+	// the producer is gone, encode whatever is left
+	drain();
+}
+
+bool FrameStreamWriter::push(Grid::FrameView const &frame,
+                             std::chrono::steady_clock::time_point time) {
+	if (!FrameSnapshot::fits(frame.width, frame.height)) {
+		throw std::runtime_error(
+		    format("Frame streams are limited to {}x{} pixels",
+		           FrameSnapshot::MAX_WIDTH, FrameSnapshot::MAX_HEIGHT));
+	}
+	FrameSnapshot queued;
+	queued.timeNs =
+	    (std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+	        time.time_since_epoch())
+	        .count();
+	queued.setRows(std::span(frame.rows, frame.wordsPerRow * frame.height),
+	               frame.wordsPerRow, frame.width, frame.height);
+	if (!m_queue.push(queued)) {
+		m_dropped.store(m_dropped.load(std::memory_order_relaxed) + 1,
+		                std::memory_order_relaxed);
+		return false;
+	}
+	return true;
+}
+
+std::uint64_t FrameStreamWriter::getDropped() const {
+	return m_dropped.load(std::memory_order_relaxed);
+}
+
+void FrameStreamWriter::writer_thread_fn(std::stop_token stop_token) {
+	while (!stop_token.stop_requested()) {
+		std::this_thread::sleep_for(DRAIN_INTERVAL);
+		drain();
+	}
+}
+
+void FrameStreamWriter::drain() {
+	auto encodeAll = [this](std::span<const FrameSnapshot> frames) {
+		for (auto &frame : frames) {
+			encode(frame);
+		}
+	};
+	if (m_queue.consume(encodeAll) != 0) {
+		// a reader on the other end of a pipe sees the frames right away
+		m_file.flush();
+	}
+}
+
+void FrameStreamWriter::encode(FrameSnapshot const &frame) {
+	std::size_t wordsPerRow = frame.wordsPerRow;
+	std::size_t words = frame.height * wordsPerRow;
+	bool resized = !m_hasPrevious || frame.width != m_previous.width ||
+	               frame.height != m_previous.height;
+	if (!resized && std::equal(frame.rows.begin(), frame.rows.begin() + words,
+	                           m_previous.rows.begin())) {
+		// same picture, the time is carried by the next frame
+		return;
+	}
+	bool keyframe = resized || m_sinceKeyframe >= m_header.keyframeInterval;
+	m_encoded.clear();
+	std::uint64_t elapsedUs =
+	    m_hasPrevious ? (frame.timeNs - m_previous.timeNs) / 1000 : 0;
+	if (keyframe) {
+		m_encoded.push_back((char)FrameKind::Keyframe);
+		appendVarint(m_encoded, elapsedUs);
+		// the sizes are 16 bit in the stream
+		auto width = (std::uint16_t)frame.width;
+		auto height = (std::uint16_t)frame.height;
+		append(m_encoded, &width, sizeof(width));
+		append(m_encoded, &height, sizeof(height));
+		append(m_encoded, frame.rows.data(), words * sizeof(std::uint64_t));
+		m_sinceKeyframe = 1;
+	} else {
+		m_encoded.push_back((char)FrameKind::Delta);
+		appendVarint(m_encoded, elapsedUs);
+		std::size_t maskOffset = m_encoded.size();
+		m_encoded.resize(maskOffset + (frame.height + 7) / 8, 0);
+		for (std::size_t j = 0; j < frame.height; j++) {
+			const std::uint64_t *row = &frame.rows[j * wordsPerRow];
+			const std::uint64_t *previous = &m_previous.rows[j * wordsPerRow];
+			if (std::equal(row, row + wordsPerRow, previous)) {
+				continue;
+			}
+			m_encoded[maskOffset + j / 8] |= (char)(1 << (j % 8));
+			for (std::size_t i = 0; i < wordsPerRow; i++) {
+				std::uint64_t diff = row[i] ^ previous[i];
+				append(m_encoded, &diff, sizeof(diff));
+			}
+		}
+		m_sinceKeyframe++;
+	}
+	m_file.write(m_encoded.data(), (std::streamsize)m_encoded.size());
+	m_previous = frame;
+	m_hasPrevious = true;
+}
+
+FrameStreamReader::FrameStreamReader(std::filesystem::path const &path)
+    : m_file(path, std::ios::binary) {
+	if (!m_file.is_open()) {
+		throw std::runtime_error(
+		    format("Could not open frame stream {}", path.string()));
+	}
+	m_file.read(reinterpret_cast<char *>(&m_header), sizeof(m_header));
+	if (!m_file || m_header.magic != FrameStreamHeader::MAGIC) {
+		throw std::runtime_error(
+		    format("{} is not a frame stream", path.string()));
+	}
+	if (m_header.version != FrameStreamHeader::VERSION) {
+		throw std::runtime_error(
+		    format("Unsupported frame stream version {}", m_header.version));
+	}
+}
+
+FrameStreamHeader const &FrameStreamReader::getHeader() const {
+	return m_header;
+}
+
+FrameStreamReader::Frame const &FrameStreamReader::getFrame() const {
+	return m_frame;
+}
+
+template <typename T>
+T FrameStreamReader::read() {
+	T value;
+	m_file.read(reinterpret_cast<char *>(&value), sizeof(T));
+	if (!m_file) {
+		throw std::runtime_error("Frame stream is truncated");
+	}
+	return value;
+}
+
+std::uint64_t FrameStreamReader::readVarint() {
+	std::uint64_t value = 0;
+	for (unsigned shift = 0; shift < 64; shift += 7) {
+		auto byte = read<std::uint8_t>();
+		value |= (std::uint64_t)(byte & 0x7F) << shift;
+		if (!(byte & 0x80)) {
+			return value;
+		}
+	}
+	throw std::runtime_error("Frame stream has an invalid frame time");
+}
+
+bool FrameStreamReader::next() {
+	int kind = m_file.get();
+	if (kind == std::char_traits<char>::eof()) {
+		return false;
+	}
+	std::uint64_t elapsedUs = readVarint();
+	m_frame.timeNs = m_started ? m_frame.timeNs + elapsedUs * 1000 : 0;
+	switch ((FrameKind)kind) {
+	case FrameKind::Keyframe: {
+		m_frame.keyframe = true;
+		m_frame.width = read<std::uint16_t>();
+		m_frame.height = read<std::uint16_t>();
+		m_frame.wordsPerRow = (m_frame.width + 63) / 64;
+		m_frame.rows.resize(m_frame.wordsPerRow * m_frame.height);
+		m_file.read(reinterpret_cast<char *>(m_frame.rows.data()),
+		            (std::streamsize)(m_frame.rows.size() *
+		                              sizeof(std::uint64_t)));
+		if (!m_file) {
+			throw std::runtime_error("Frame stream is truncated");
+		}
+		m_started = true;
+		break;
+	}
+	case FrameKind::Delta: {
+		if (!m_started) {
+			throw std::runtime_error("Frame stream starts with a delta");
+		}
+		m_frame.keyframe = false;
+		std::vector<std::uint8_t> mask((m_frame.height + 7) / 8);
+		m_file.read(reinterpret_cast<char *>(mask.data()),
+		            (std::streamsize)mask.size());
+		for (std::size_t j = 0; j < m_frame.height; j++) {
+			if (!(mask[j / 8] & (1 << (j % 8)))) {
+				continue;
+			}
+			for (std::size_t i = 0; i < m_frame.wordsPerRow; i++) {
+				m_frame.rows[j * m_frame.wordsPerRow + i] ^=
+				    read<std::uint64_t>();
+			}
+		}
+		if (!m_file) {
+			throw std::runtime_error("Frame stream is truncated");
+		}
+		break;
+	}
+	default:
+		throw std::runtime_error(
+		    format("Frame stream has an invalid frame kind {}", kind));
+	}
+	return true;
+}
+
+} // namespace chip8pp
@@ -0,0 +1,55 @@
+#include <chip8pp/framebufferExport.hpp>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <string>
+// check if format is available
+#if __has_include(<format>)
+#include <format>
+using std::format;
+// if not, use fmt
+#elif __has_include(<fmt/format.h>)
+#include <fmt/format.h>
+using fmt::format;
+#else
+#error "No <format> or <fmt/format.h> found"
+#endif
+
+namespace chip8pp {
+
+FramebufferExport::FramebufferExport()
+    : m_memory(SharedMemory::create(
+          FRAMEBUFFER_PREFIX + std::to_string(SharedMemory::processId()),
+          sizeof(FramebufferPage))),
+      m_page(new (m_memory.data()) FramebufferPage()) {
+	m_page->pid = SharedMemory::processId();
+}
+
+void FramebufferExport::publish(Grid::FrameView const &frame,
+                                Palette palette,
+                                std::chrono::steady_clock::time_point time) {
+	if (!FrameSnapshot::fits(frame.width, frame.height)) {
+		throw std::runtime_error(
+		    format("Exported frames are limited to {}x{} pixels",
+		           FrameSnapshot::MAX_WIDTH, FrameSnapshot::MAX_HEIGHT));
+	}
+	// the rows go straight into the page
+	m_page->frame.write([&](FrameSnapshot &page) {
+		page.frame = ++m_frames;
+		page.timeNs = (std::uint64_t)std::chrono::duration_cast<
+		                  std::chrono::nanoseconds>(time.time_since_epoch())
+		                  .count();
+		page.off = palette.off;
+		page.on = palette.on;
+		page.setRows(std::span(frame.rows, frame.wordsPerRow * frame.height),
+		             frame.wordsPerRow, frame.width, frame.height);
+	});
+}
+
+FramebufferPage const &FramebufferExport::getPage() const { return *m_page; }
+
+bool readFramebufferPage(FramebufferPage const &page, FrameSnapshot &frame) {
+	return page.frame.read(frame);
+}
+
+} // namespace chip8pp
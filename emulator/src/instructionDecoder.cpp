@@ -13,7 +13,20 @@ InstructionEnum Instruction::decodeOpCode(std::uint16_t opcode) {
 			return InstructionEnum::CLS;
 		case 0x00EE:
 			return InstructionEnum::RET;
+		case 0x00FB:
+			return InstructionEnum::SCR;
+		case 0x00FC:
+			return InstructionEnum::SCL;
+		case 0x00FD:
+			return InstructionEnum::EXIT;
+		case 0x00FE:
+			return InstructionEnum::LOW;
+		case 0x00FF:
+			return InstructionEnum::HIGH;
 		default:
+			if ((opcode & 0xFFF0) == 0x00C0) {
+				return InstructionEnum::SCD_N;
+			}
 			return InstructionEnum::SYS;
 		}
 	case 0x01:
@@ -76,6 +89,12 @@ InstructionEnum Instruction::decodeOpCode(std::uint16_t opcode) {
 		break;
 	case 0x0F:
 		switch ((std::uint8_t)opcode & 0x00FF) {
+		case 0x00:
+			// the address is in the next word
+			if (opcode == 0xF000) {
+				return InstructionEnum::LD_I_LONG;
+			}
+			return InstructionEnum::INVALID;
 		case 0x07:
 			return InstructionEnum::LD_VX_DT;
 		case 0x0A:
@@ -88,12 +107,18 @@ InstructionEnum Instruction::decodeOpCode(std::uint16_t opcode) {
 			return InstructionEnum::ADD_I_VX;
 		case 0x29:
 			return InstructionEnum::LD_F_VX;
+		case 0x30:
+			return InstructionEnum::LD_HF_VX;
 		case 0x33:
 			return InstructionEnum::LD_B_VX;
 		case 0x55:
 			return InstructionEnum::LD_I_VX;
 		case 0x65:
 			return InstructionEnum::LD_VX_I;
+		case 0x75:
+			return InstructionEnum::LD_R_VX;
+		case 0x85:
+			return InstructionEnum::LD_VX_R;
 		default:
 			return InstructionEnum::INVALID;
 		}
@@ -103,4 +128,103 @@ InstructionEnum Instruction::decodeOpCode(std::uint16_t opcode) {
 	return InstructionEnum::INVALID;
 }
 
+std::string_view Instruction::getName(InstructionEnum instruction) {
+	switch (instruction) {
+	case InstructionEnum::INVALID:
+		return CHIP8_INSTRUCTION_ENUM_NAME(INVALID);
+	case InstructionEnum::SYS:
+		return CHIP8_INSTRUCTION_ENUM_NAME(SYS);
+	case InstructionEnum::CLS:
+		return CHIP8_INSTRUCTION_ENUM_NAME(CLS);
+	case InstructionEnum::RET:
+		return CHIP8_INSTRUCTION_ENUM_NAME(RET);
+	case InstructionEnum::JMP_NNN:
+		return CHIP8_INSTRUCTION_ENUM_NAME(JMP_NNN);
+	case InstructionEnum::CALL_NNN:
+		return CHIP8_INSTRUCTION_ENUM_NAME(CALL_NNN);
+	case InstructionEnum::SE_VX_NN:
+		return CHIP8_INSTRUCTION_ENUM_NAME(SE_VX_NN);
+	case InstructionEnum::SNE_VX_NN:
+		return CHIP8_INSTRUCTION_ENUM_NAME(SNE_VX_NN);
+	case InstructionEnum::SE_VX_VY:
+		return CHIP8_INSTRUCTION_ENUM_NAME(SE_VX_VY);
+	case InstructionEnum::LD_VX_NN:
+		return CHIP8_INSTRUCTION_ENUM_NAME(LD_VX_NN);
+	case InstructionEnum::ADD_VX_NN:
+		return CHIP8_INSTRUCTION_ENUM_NAME(ADD_VX_NN);
+	case InstructionEnum::LD_VX_VY:
+		return CHIP8_INSTRUCTION_ENUM_NAME(LD_VX_VY);
+	case InstructionEnum::OR_VX_VY:
+		return CHIP8_INSTRUCTION_ENUM_NAME(OR_VX_VY);
+	case InstructionEnum::AND_VX_VY:
+		return CHIP8_INSTRUCTION_ENUM_NAME(AND_VX_VY);
+	case InstructionEnum::XOR_VX_VY:
+		return CHIP8_INSTRUCTION_ENUM_NAME(XOR_VX_VY);
+	case InstructionEnum::ADD_VX_VY:
+		return CHIP8_INSTRUCTION_ENUM_NAME(ADD_VX_VY);
+	case InstructionEnum::SUB_VX_VY:
+		return CHIP8_INSTRUCTION_ENUM_NAME(SUB_VX_VY);
+	case InstructionEnum::SHR_VX_VY:
+		return CHIP8_INSTRUCTION_ENUM_NAME(SHR_VX_VY);
+	case InstructionEnum::SUBN_VX_VY:
+		return CHIP8_INSTRUCTION_ENUM_NAME(SUBN_VX_VY);
+	case InstructionEnum::SHL_VX_VY:
+		return CHIP8_INSTRUCTION_ENUM_NAME(SHL_VX_VY);
+	case InstructionEnum::SNE_VX_VY:
+		return CHIP8_INSTRUCTION_ENUM_NAME(SNE_VX_VY);
+	case InstructionEnum::LD_I_NNN:
+		return CHIP8_INSTRUCTION_ENUM_NAME(LD_I_NNN);
+	case InstructionEnum::JMP_V0_NNN:
+		return CHIP8_INSTRUCTION_ENUM_NAME(JMP_V0_NNN);
+	case InstructionEnum::RND_VX_NN:
+		return CHIP8_INSTRUCTION_ENUM_NAME(RND_VX_NN);
+	case InstructionEnum::DRW_VX_VY_N:
+		return CHIP8_INSTRUCTION_ENUM_NAME(DRW_VX_VY_N);
+	case InstructionEnum::SKP_VX:
+		return CHIP8_INSTRUCTION_ENUM_NAME(SKP_VX);
+	case InstructionEnum::SKNP_VX:
+		return CHIP8_INSTRUCTION_ENUM_NAME(SKNP_VX);
+	case InstructionEnum::LD_VX_DT:
+		return CHIP8_INSTRUCTION_ENUM_NAME(LD_VX_DT);
+	case InstructionEnum::LD_VX_K:
+		return CHIP8_INSTRUCTION_ENUM_NAME(LD_VX_K);
+	case InstructionEnum::LD_DT_VX:
+		return CHIP8_INSTRUCTION_ENUM_NAME(LD_DT_VX);
+	case InstructionEnum::LD_ST_VX:
+		return CHIP8_INSTRUCTION_ENUM_NAME(LD_ST_VX);
+	case InstructionEnum::ADD_I_VX:
+		return CHIP8_INSTRUCTION_ENUM_NAME(ADD_I_VX);
+	case InstructionEnum::LD_F_VX:
+		return CHIP8_INSTRUCTION_ENUM_NAME(LD_F_VX);
+	case InstructionEnum::LD_B_VX:
+		return CHIP8_INSTRUCTION_ENUM_NAME(LD_B_VX);
+	case InstructionEnum::LD_I_VX:
+		return CHIP8_INSTRUCTION_ENUM_NAME(LD_I_VX);
+	case InstructionEnum::LD_VX_I:
+		return CHIP8_INSTRUCTION_ENUM_NAME(LD_VX_I);
+	case InstructionEnum::SCD_N:
+		return CHIP8_INSTRUCTION_ENUM_NAME(SCD_N);
+	case InstructionEnum::SCR:
+		return CHIP8_INSTRUCTION_ENUM_NAME(SCR);
+	case InstructionEnum::SCL:
+		return CHIP8_INSTRUCTION_ENUM_NAME(SCL);
+	case InstructionEnum::EXIT:
+		return CHIP8_INSTRUCTION_ENUM_NAME(EXIT);
+	case InstructionEnum::LOW:
+		return CHIP8_INSTRUCTION_ENUM_NAME(LOW);
+	case InstructionEnum::HIGH:
+		return CHIP8_INSTRUCTION_ENUM_NAME(HIGH);
+	case InstructionEnum::LD_HF_VX:
+		return CHIP8_INSTRUCTION_ENUM_NAME(LD_HF_VX);
+	case InstructionEnum::LD_R_VX:
+		return CHIP8_INSTRUCTION_ENUM_NAME(LD_R_VX);
+	case InstructionEnum::LD_VX_R:
+		return CHIP8_INSTRUCTION_ENUM_NAME(LD_VX_R);
+	case InstructionEnum::LD_I_LONG:
+		return CHIP8_INSTRUCTION_ENUM_NAME(LD_I_LONG);
+	default:
+		return CHIP8_INSTRUCTION_ENUM_NAME(INVALID);
+	}
+}
+
 } // namespace chip8pp
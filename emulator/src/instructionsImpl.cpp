@@ -1,133 +1,161 @@
+#include <array>
 #include <chip8pp/cpu.hpp>
 #include <chip8pp/instructions.hpp>
 #include <chip8pp/memory.hpp>
 #include <cstddef>
 #include <cstdint>
-#include <random>
-// check if format is available
-#if __has_include(<format>)
-#include <format>
-using std::format;
-// if not, use fmt
-#elif __has_include(<fmt/format.h>)
-#include <fmt/format.h>
-using fmt::format;
-#else
-#error "No <format> or <fmt/format.h> found"
-#endif
+#include <span>
 
 namespace chip8pp {
 namespace instructions {
 
-std::uint8_t generateRandomNumber() {
-	// get a static random number generator
-	static std::random_device rd;
-	static std::mt19937 gen(rd());
-	static std::uniform_int_distribution<> dis(0, 255);
-	return (std::uint8_t)dis(gen);
+// skip the next instruction, XO-CHIP skips the 4 bytes of F000 NNNN at once
+template <typename MemoryT>
+void skipNext(BasicCPU<MemoryT> &cpu, MemoryT &memory) {
+	if constexpr (MemoryT::RAM_SIZE > 0x1000) {
+		if (memory.fetch_word(cpu.pc) == 0xF000) {
+			cpu.pc += 2;
+		}
+	}
+	cpu.pc += 2;
 }
 
-void invalid(Instruction, CPU &, Memory &, Screen &, Keypad &) {
-	throw std::runtime_error("Invalid instruction");
+template <typename MemoryT>
+Trap invalid(Instruction, BasicCPU<MemoryT> &, MemoryT &, Screen &, Keypad &) {
+	return Trap::InvalidOpcode;
 }
 
 // the non implemented instruction, used for fallback
-void notImplemented(Instruction instruction, CPU &, Memory &, Screen &,
+template <typename MemoryT>
+Trap notImplemented(Instruction, BasicCPU<MemoryT> &, MemoryT &, Screen &,
                     Keypad &) {
-	throw std::runtime_error(format("Instruction {:#x} not implemented",
-	                                (uint16_t)instruction.opcode));
+	return Trap::NotImplemented;
+}
+template <typename MemoryT>
+Trap noop(Instruction, BasicCPU<MemoryT> &, MemoryT &, Screen &, Keypad &) {
+	return Trap::None;
 }
-void noop(Instruction, CPU &, Memory &, Screen &, Keypad &) {}
 
-void CLS(Instruction, CPU &, Memory &, Screen &screen, Keypad &) {
+template <typename MemoryT>
+Trap CLS(Instruction, BasicCPU<MemoryT> &, MemoryT &, Screen &screen,
+         Keypad &) {
 	screen.clear();
+	return Trap::None;
 }
 
-void RET(Instruction, CPU &cpu, Memory &, Screen &, Keypad &) {
+template <typename MemoryT>
+Trap RET(Instruction, BasicCPU<MemoryT> &cpu, MemoryT &, Screen &, Keypad &) {
 	// check if stack is empty
 	if (cpu.sp == 0) {
-		// stack underflow at address pc
-		throw std::runtime_error(
-		    format("Stack underflow at address {:#x}", (uint16_t)cpu.pc));
+		return Trap::StackUnderflow;
 	}
 	cpu.sp--;
 	cpu.pc = cpu.stack[cpu.sp];
+	return Trap::None;
 }
 
-void JMP_NNN(Instruction instruction, CPU &cpu, Memory &, Screen &, Keypad &) {
+template <typename MemoryT>
+Trap JMP_NNN(Instruction instruction, BasicCPU<MemoryT> &cpu, MemoryT &,
+             Screen &, Keypad &) {
 	cpu.pc = instruction.nnn;
+	return Trap::None;
 }
 
-void CALL_NNN(Instruction instruction, CPU &cpu, Memory &, Screen &, Keypad &) {
+template <typename MemoryT>
+Trap CALL_NNN(Instruction instruction, BasicCPU<MemoryT> &cpu, MemoryT &,
+              Screen &, Keypad &) {
 	// check if stack is full
 	if (cpu.sp >= CPU::STACK_SIZE) {
-		// stack overflow at address pc
-		throw std::runtime_error(
-		    format("Stack overflow at address {:#x}", (uint16_t)cpu.pc));
+		return Trap::StackOverflow;
 	}
 	cpu.stack[cpu.sp] = cpu.pc;
 	cpu.sp++;
 	cpu.pc = instruction.nnn;
+	return Trap::None;
 }
 
-void SE_VX_NN(Instruction instruction, CPU &cpu, Memory &, Screen &, Keypad &) {
+template <typename MemoryT>
+Trap SE_VX_NN(Instruction instruction, BasicCPU<MemoryT> &cpu, MemoryT &memory,
+              Screen &, Keypad &) {
 	if (cpu.registers[(uint8_t)instruction.x] == instruction.nn) {
-		cpu.pc += 2;
+		skipNext(cpu, memory);
 	}
+	return Trap::None;
 }
 
-void SNE_VX_NN(Instruction instruction, CPU &cpu, Memory &, Screen &,
-               Keypad &) {
+template <typename MemoryT>
+Trap SNE_VX_NN(Instruction instruction, BasicCPU<MemoryT> &cpu, MemoryT &memory,
+               Screen &, Keypad &) {
 	if (cpu.registers[(uint8_t)instruction.x] != instruction.nn) {
-		cpu.pc += 2;
+		skipNext(cpu, memory);
 	}
+	return Trap::None;
 }
 
-void SE_VX_VY(Instruction instruction, CPU &cpu, Memory &, Screen &, Keypad &) {
+template <typename MemoryT>
+Trap SE_VX_VY(Instruction instruction, BasicCPU<MemoryT> &cpu, MemoryT &memory,
+              Screen &, Keypad &) {
 	if (cpu.registers[(uint8_t)instruction.x] ==
 	    cpu.registers[(uint8_t)instruction.y]) {
-		cpu.pc += 2;
+		skipNext(cpu, memory);
 	}
+	return Trap::None;
 }
 
-void LD_VX_NN(Instruction instruction, CPU &cpu, Memory &, Screen &, Keypad &) {
+template <typename MemoryT>
+Trap LD_VX_NN(Instruction instruction, BasicCPU<MemoryT> &cpu, MemoryT &,
+              Screen &, Keypad &) {
 	cpu.registers[(uint8_t)instruction.x] = instruction.nn;
+	return Trap::None;
 }
 
-void ADD_VX_NN(Instruction instruction, CPU &cpu, Memory &, Screen &,
-               Keypad &) {
+template <typename MemoryT>
+Trap ADD_VX_NN(Instruction instruction, BasicCPU<MemoryT> &cpu, MemoryT &,
+               Screen &, Keypad &) {
 	cpu.registers[(uint8_t)instruction.x] =
 	    (std::byte)((uint8_t)cpu.registers[(size_t)instruction.x] +
 	                (uint8_t)instruction.nn);
+	return Trap::None;
 }
 
-void LD_VX_VY(Instruction instruction, CPU &cpu, Memory &, Screen &, Keypad &) {
+template <typename MemoryT>
+Trap LD_VX_VY(Instruction instruction, BasicCPU<MemoryT> &cpu, MemoryT &,
+              Screen &, Keypad &) {
 	cpu.registers[(uint8_t)instruction.x] =
 	    cpu.registers[(uint8_t)instruction.y];
+	return Trap::None;
 }
 
-void OR_VX_VY(Instruction instruction, CPU &cpu, Memory &, Screen &, Keypad &) {
+template <typename MemoryT>
+Trap OR_VX_VY(Instruction instruction, BasicCPU<MemoryT> &cpu, MemoryT &,
+              Screen &, Keypad &) {
 	cpu.registers[(uint8_t)instruction.x] =
 	    (std::byte)((uint8_t)cpu.registers[(size_t)instruction.x] |
 	                (uint8_t)cpu.registers[(size_t)instruction.y]);
+	return Trap::None;
 }
 
-void AND_VX_VY(Instruction instruction, CPU &cpu, Memory &, Screen &,
-               Keypad &) {
+template <typename MemoryT>
+Trap AND_VX_VY(Instruction instruction, BasicCPU<MemoryT> &cpu, MemoryT &,
+               Screen &, Keypad &) {
 	cpu.registers[(uint8_t)instruction.x] =
 	    (std::byte)((uint8_t)cpu.registers[(size_t)instruction.x] &
 	                (uint8_t)cpu.registers[(size_t)instruction.y]);
+	return Trap::None;
 }
 
-void XOR_VX_VY(Instruction instruction, CPU &cpu, Memory &, Screen &,
-               Keypad &) {
+template <typename MemoryT>
+Trap XOR_VX_VY(Instruction instruction, BasicCPU<MemoryT> &cpu, MemoryT &,
+               Screen &, Keypad &) {
 	cpu.registers[(uint8_t)instruction.x] =
 	    (std::byte)((uint8_t)cpu.registers[(size_t)instruction.x] ^
 	                (uint8_t)cpu.registers[(size_t)instruction.y]);
+	return Trap::None;
 }
 
-void ADD_VX_VY(Instruction instruction, CPU &cpu, Memory &, Screen &,
-               Keypad &) {
+template <typename MemoryT>
+Trap ADD_VX_VY(Instruction instruction, BasicCPU<MemoryT> &cpu, MemoryT &,
+               Screen &, Keypad &) {
 	// add the values as 16 bit integers
 	std::int16_t sum = (std::int16_t)cpu.registers[(uint8_t)instruction.x] +
 	                   (std::int16_t)cpu.registers[(uint8_t)instruction.y];
@@ -135,10 +163,12 @@ void ADD_VX_VY(Instruction instruction, CPU &cpu, Memory &, Screen &,
 	cpu.registers[0xF] = (sum > 0xFF) ? std::byte(1) : std::byte(0);
 	// set the register
 	cpu.registers[(uint8_t)instruction.x] = (std::byte)(sum & 0xFF);
+	return Trap::None;
 }
 
-void SUB_VX_VY(Instruction instruction, CPU &cpu, Memory &, Screen &,
-               Keypad &) {
+template <typename MemoryT>
+Trap SUB_VX_VY(Instruction instruction, BasicCPU<MemoryT> &cpu, MemoryT &,
+               Screen &, Keypad &) {
 	// add the values as 16 bit integers
 	std::int16_t diff = (std::int16_t)cpu.registers[(uint8_t)instruction.x] -
 	                    (std::int16_t)cpu.registers[(uint8_t)instruction.y];
@@ -146,10 +176,12 @@ void SUB_VX_VY(Instruction instruction, CPU &cpu, Memory &, Screen &,
 	cpu.registers[0xF] = (diff < 0) ? std::byte(0) : std::byte(1);
 	// set the register
 	cpu.registers[(uint8_t)instruction.x] = (std::byte)(diff & 0xFF);
+	return Trap::None;
 }
 
-void SHR_VX_VY(Instruction instruction, CPU &cpu, Memory &, Screen &,
-               Keypad &) {
+template <typename MemoryT>
+Trap SHR_VX_VY(Instruction instruction, BasicCPU<MemoryT> &cpu, MemoryT &,
+               Screen &, Keypad &) {
 	// set the register VX = VY >> 1
 	cpu.registers[(uint8_t)instruction.x] = (std::byte)(
 	    ((uint8_t)cpu.registers[(uint8_t)instruction.y] >> 1) & 0xFF);
@@ -159,10 +191,12 @@ void SHR_VX_VY(Instruction instruction, CPU &cpu, Memory &, Screen &,
 	    (bool)(cpu.registers[(uint8_t)instruction.x] & std::byte(0b00000001))
 	        ? std::byte(1)
 	        : std::byte(0);
+	return Trap::None;
 }
 
-void SUBN_VX_VY(Instruction instruction, CPU &cpu, Memory &, Screen &,
-                Keypad &) {
+template <typename MemoryT>
+Trap SUBN_VX_VY(Instruction instruction, BasicCPU<MemoryT> &cpu, MemoryT &,
+                Screen &, Keypad &) {
 	// add the values as 16 bit integers
 	std::int16_t diff = (std::int16_t)cpu.registers[(uint8_t)instruction.y] -
 	                    (std::int16_t)cpu.registers[(uint8_t)instruction.x];
@@ -170,10 +204,12 @@ void SUBN_VX_VY(Instruction instruction, CPU &cpu, Memory &, Screen &,
 	cpu.registers[0xF] = (diff < 0) ? std::byte(0) : std::byte(1);
 	// set the register
 	cpu.registers[(uint8_t)instruction.x] = (std::byte)(diff & 0xFF);
+	return Trap::None;
 }
 
-void SHL_VX_VY(Instruction instruction, CPU &cpu, Memory &, Screen &,
-               Keypad &) {
+template <typename MemoryT>
+Trap SHL_VX_VY(Instruction instruction, BasicCPU<MemoryT> &cpu, MemoryT &,
+               Screen &, Keypad &) {
 	// set the register VX = VY << 1
 	cpu.registers[(uint8_t)instruction.x] = (std::byte)(
 	    ((uint8_t)cpu.registers[(uint8_t)instruction.y] << 1) & 0xFF);
@@ -183,127 +219,165 @@ void SHL_VX_VY(Instruction instruction, CPU &cpu, Memory &, Screen &,
 	    (bool)(cpu.registers[(uint8_t)instruction.x] & std::byte(0b10000000))
 	        ? std::byte(1)
 	        : std::byte(0);
+	return Trap::None;
 }
 
-void SNE_VX_VY(Instruction instruction, CPU &cpu, Memory &, Screen &,
-               Keypad &) {
+template <typename MemoryT>
+Trap SNE_VX_VY(Instruction instruction, BasicCPU<MemoryT> &cpu, MemoryT &memory,
+               Screen &, Keypad &) {
 	if (cpu.registers[(uint8_t)instruction.x] !=
 	    cpu.registers[(uint8_t)instruction.y]) {
-		cpu.pc += 2;
+		skipNext(cpu, memory);
 	}
+	return Trap::None;
 }
 
-void LD_I_NNN(Instruction instruction, CPU &cpu, Memory &, Screen &, Keypad &) {
+template <typename MemoryT>
+Trap LD_I_NNN(Instruction instruction, BasicCPU<MemoryT> &cpu, MemoryT &,
+              Screen &, Keypad &) {
 	cpu.index = instruction.nnn;
+	return Trap::None;
 }
 
-void JMP_V0_NNN(Instruction instruction, CPU &cpu, Memory &, Screen &,
-                Keypad &) {
+template <typename MemoryT>
+Trap JMP_V0_NNN(Instruction instruction, BasicCPU<MemoryT> &cpu, MemoryT &,
+                Screen &, Keypad &) {
 	cpu.pc = (std::uint16_t)instruction.nnn + (std::uint16_t)cpu.registers[0];
+	return Trap::None;
 }
 
-void RND_VX_NN(Instruction instruction, CPU &cpu, Memory &, Screen &,
-               Keypad &) {
-	std::uint8_t random = generateRandomNumber();
+template <typename MemoryT>
+Trap RND_VX_NN(Instruction instruction, BasicCPU<MemoryT> &cpu, MemoryT &,
+               Screen &, Keypad &) {
+	// the top bits of the generator, its output is the same on every
+	// platform for a given seed
+	auto random = (std::uint8_t)(cpu.rng() >> 24);
 	cpu.registers[(uint8_t)instruction.x] =
 	    (std::byte)(random & (std::uint8_t)instruction.nn);
-}
-
-void DRW_VX_VY_N(Instruction instruction, CPU &cpu, Memory &memory,
-                 Screen &screen, Keypad &) {
-	// set F register to 0
-	cpu.registers[0xF] = std::byte(0);
-	// loop through the height of the sprite
-	for (std::uint8_t hline = 0; hline < (std::uint8_t)instruction.n; hline++) {
-		std::uint8_t spr_byte =
-		    (std::uint8_t)memory.get_byte(cpu.index + hline);
-		// loop through the width of the sprite
-		for (std::uint8_t vline = 0; vline < 8; vline++) {
-			// check if the pixel is set
-			if ((spr_byte & (0x80 >> vline)) != 0) {
-				// check if the pixel is already set
-				pixelRGBA_t pixel = screen.getPixel(
-				    (std::uint8_t)cpu.registers[(std::uint8_t)instruction.x] +
-				        vline,
-				    (std::uint8_t)cpu.registers[(std::uint8_t)instruction.y] +
-				        hline);
-				if (pixel == 0xFFFFFFFF) {
-					// set F register to 1
-					cpu.registers[0xF] = std::byte(1);
-				}
-				// save the pixel to the screen
-				screen.setPixel(
-				    (std::uint8_t)cpu.registers[(std::uint8_t)instruction.x] +
-				        vline,
-				    (std::uint8_t)cpu.registers[(std::uint8_t)instruction.y] +
-				        hline,
-				    0xFFFFFFFF);
-			}
-		}
+	return Trap::None;
+}
+
+template <typename MemoryT>
+Trap DRW_VX_VY_N(Instruction instruction, BasicCPU<MemoryT> &cpu,
+                 MemoryT &memory, Screen &screen, Keypad &) {
+	std::size_t x = (std::uint8_t)cpu.registers[(std::uint8_t)instruction.x];
+	std::size_t y = (std::uint8_t)cpu.registers[(std::uint8_t)instruction.y];
+	std::uint8_t height = (std::uint8_t)instruction.n;
+	// SUPER-CHIP: a height of 0 draws a 16x16 sprite, 2 bytes per row
+	std::size_t width = height == 0 ? 16 : 8;
+	std::size_t size = height == 0 ? 32 : height;
+	// read the sprite first so it is drawn under a single screen lock
+	std::array<std::byte, 32> sprite;
+	for (std::uint8_t i = 0; i < size; i++) {
+		sprite[i] = memory.get_byte(cpu.index + i);
 	}
-}
-
-void SKP_VX(Instruction instruction, CPU &cpu, Memory &, Screen &,
-            Keypad &keypad) {
-	Keypad::Key key = (Keypad::Key)cpu.registers[(std::uint8_t)instruction.x];
+	bool collision =
+	    screen.blitSprite(x, y, std::span(sprite.data(), size),
+	                      {BlitMode::Op::Xor, BlitMode::Edge::Clip}, width);
+	// set F register to 1 if any pixel was erased
+	cpu.registers[0xF] = std::byte(collision ? 1 : 0);
+	return Trap::None;
+}
+
+template <typename MemoryT>
+Trap SKP_VX(Instruction instruction, BasicCPU<MemoryT> &cpu, MemoryT &memory,
+            Screen &, Keypad &keypad) {
+	// only the low nibble names a key
+	Keypad::Key key = (Keypad::Key)(
+	    (std::uint8_t)cpu.registers[(std::uint8_t)instruction.x] & 0xF);
 	if (keypad.is_pressed(key)) {
-		cpu.pc += 2;
+		skipNext(cpu, memory);
 	}
+	return Trap::None;
 }
 
-void SKNP_VX(Instruction instruction, CPU &cpu, Memory &, Screen &,
-             Keypad &keypad) {
-	Keypad::Key key = (Keypad::Key)cpu.registers[(std::uint8_t)instruction.x];
+template <typename MemoryT>
+Trap SKNP_VX(Instruction instruction, BasicCPU<MemoryT> &cpu, MemoryT &memory,
+             Screen &, Keypad &keypad) {
+	Keypad::Key key = (Keypad::Key)(
+	    (std::uint8_t)cpu.registers[(std::uint8_t)instruction.x] & 0xF);
 	if (!keypad.is_pressed(key)) {
-		cpu.pc += 2;
+		skipNext(cpu, memory);
 	}
+	return Trap::None;
 }
 
-void LD_VX_DT(Instruction instruction, CPU &cpu, Memory &, Screen &, Keypad &) {
+template <typename MemoryT>
+Trap LD_VX_DT(Instruction instruction, BasicCPU<MemoryT> &cpu, MemoryT &,
+              Screen &, Keypad &) {
 	cpu.registers[(std::uint8_t)instruction.x] = cpu.getDelayTimer();
+	return Trap::None;
 }
 
-void LD_VX_K(Instruction instruction, CPU &cpu, Memory &, Screen &,
-             Keypad &keypad) {
+template <typename MemoryT>
+Trap LD_VX_K(Instruction instruction, BasicCPU<MemoryT> &cpu, MemoryT &,
+             Screen &, Keypad &keypad) {
 	// check if a key is pressed
 	for (std::uint8_t i = 0; i < 16; i++) {
 		Keypad::Key key = (Keypad::Key)i;
 		if (keypad.is_pressed(key)) {
 			cpu.registers[(std::uint8_t)instruction.x] = (std::byte)i;
-			return;
+			return Trap::None;
 		}
 	}
 	// if no key is pressed, decrement the program counter
 	cpu.pc -= 2;
+	return Trap::KeyWait;
 }
 
-void LD_DT_VX(Instruction instruction, CPU &cpu, Memory &, Screen &, Keypad &) {
+template <typename MemoryT>
+Trap LD_DT_VX(Instruction instruction, BasicCPU<MemoryT> &cpu, MemoryT &,
+              Screen &, Keypad &) {
 	cpu.setDelayTimer(cpu.registers[(std::uint8_t)instruction.x]);
+	return Trap::None;
 }
 
-void LD_ST_VX(Instruction instruction, CPU &cpu, Memory &, Screen &, Keypad &) {
+template <typename MemoryT>
+Trap LD_ST_VX(Instruction instruction, BasicCPU<MemoryT> &cpu, MemoryT &,
+              Screen &, Keypad &) {
 	cpu.setSoundTimer(cpu.registers[(std::uint8_t)instruction.x]);
+	return Trap::None;
 }
 
-void ADD_I_VX(Instruction instruction, CPU &cpu, Memory &, Screen &, Keypad &) {
+template <typename MemoryT>
+Trap ADD_I_VX(Instruction instruction, BasicCPU<MemoryT> &cpu, MemoryT &,
+              Screen &, Keypad &) {
 	cpu.index += (std::uint16_t)cpu.registers[(std::uint8_t)instruction.x];
+	return Trap::None;
 }
 
-void LD_F_VX(Instruction instruction, CPU &cpu, Memory &, Screen &, Keypad &) {
-	cpu.index = (std::uint16_t)cpu.registers[(std::uint8_t)instruction.x] * 5;
+template <typename MemoryT>
+Trap LD_F_VX(Instruction instruction, BasicCPU<MemoryT> &cpu, MemoryT &,
+             Screen &, Keypad &) {
+	cpu.index =
+	    MemoryT::FONT_OFFSET +
+	    (std::uint16_t)cpu.registers[(std::uint8_t)instruction.x] * 5;
+	return Trap::None;
 }
 
-void LD_B_VX(Instruction instruction, CPU &cpu, Memory &memory, Screen &,
-             Keypad &) {
+template <typename MemoryT>
+Trap LD_HF_VX(Instruction instruction, BasicCPU<MemoryT> &cpu, MemoryT &,
+              Screen &, Keypad &) {
+	std::uint8_t digit =
+	    (std::uint8_t)cpu.registers[(std::uint8_t)instruction.x] & 0xF;
+	cpu.index = MemoryT::BIG_FONT_OFFSET + digit * 10;
+	return Trap::None;
+}
+
+template <typename MemoryT>
+Trap LD_B_VX(Instruction instruction, BasicCPU<MemoryT> &cpu, MemoryT &memory,
+             Screen &, Keypad &) {
 	std::uint8_t value =
 	    (std::uint8_t)cpu.registers[(std::uint8_t)instruction.x];
 	memory.set_byte(cpu.index, (std::byte)(value / 100));
 	memory.set_byte(cpu.index + 1, (std::byte)((value / 10) % 10));
 	memory.set_byte(cpu.index + 2, (std::byte)((value % 100) % 10));
+	return Trap::None;
 }
 
-void LD_I_VX(Instruction instruction, CPU &cpu, Memory &memory, Screen &,
-             Keypad &) {
+template <typename MemoryT>
+Trap LD_I_VX(Instruction instruction, BasicCPU<MemoryT> &cpu, MemoryT &memory,
+             Screen &, Keypad &) {
 	for (std::uint8_t i = 0; i <= (std::uint8_t)instruction.x; i++) {
 		memory.set_byte((cpu.index + i), cpu.registers[i]);
 	}
@@ -311,10 +385,12 @@ void LD_I_VX(Instruction instruction, CPU &cpu, Memory &memory, Screen &,
 	if (cpu.quirks[(size_t)CPU::Quirk::ModifyIndexloadStore]) {
 		cpu.index += (std::uint8_t)instruction.x + 1;
 	}
+	return Trap::None;
 }
 
-void LD_VX_I(Instruction instruction, CPU &cpu, Memory &memory, Screen &,
-             Keypad &) {
+template <typename MemoryT>
+Trap LD_VX_I(Instruction instruction, BasicCPU<MemoryT> &cpu, MemoryT &memory,
+             Screen &, Keypad &) {
 	for (std::uint8_t i = 0; i <= (std::uint8_t)instruction.x; i++) {
 		cpu.registers[i] = memory.get_byte(cpu.index + i);
 	}
@@ -323,89 +399,195 @@ void LD_VX_I(Instruction instruction, CPU &cpu, Memory &memory, Screen &,
 	if (cpu.quirks[(size_t)CPU::Quirk::ModifyIndexloadStore]) {
 		cpu.index += (std::uint8_t)instruction.x + 1;
 	}
+	return Trap::None;
+}
+
+template <typename MemoryT>
+Trap SCD_N(Instruction instruction, BasicCPU<MemoryT> &, MemoryT &,
+           Screen &screen, Keypad &) {
+	screen.scrollDown((std::uint8_t)instruction.n);
+	return Trap::None;
+}
+
+template <typename MemoryT>
+Trap SCR(Instruction, BasicCPU<MemoryT> &, MemoryT &, Screen &screen,
+         Keypad &) {
+	screen.scrollRight(4);
+	return Trap::None;
+}
+
+template <typename MemoryT>
+Trap SCL(Instruction, BasicCPU<MemoryT> &, MemoryT &, Screen &screen,
+         Keypad &) {
+	screen.scrollLeft(4);
+	return Trap::None;
+}
+
+template <typename MemoryT>
+Trap EXIT(Instruction, BasicCPU<MemoryT> &, MemoryT &, Screen &, Keypad &) {
+	return Trap::Exit;
+}
+
+// the mode switches clear the screen, the grid keeps its buffers
+template <typename MemoryT>
+Trap LOW(Instruction, BasicCPU<MemoryT> &, MemoryT &, Screen &screen,
+         Keypad &) {
+	if (!screen.setResolution(CPU::SCREEN_WIDTH, CPU::SCREEN_HEIGHT)) {
+		return Trap::NotImplemented;
+	}
+	return Trap::None;
+}
+
+template <typename MemoryT>
+Trap HIGH(Instruction, BasicCPU<MemoryT> &, MemoryT &, Screen &screen,
+          Keypad &) {
+	// the screen was not set up for the hi-res mode
+	if (!screen.setResolution(CPU::HIRES_WIDTH, CPU::HIRES_HEIGHT)) {
+		return Trap::NotImplemented;
+	}
+	return Trap::None;
+}
+
+template <typename MemoryT>
+Trap LD_R_VX(Instruction instruction, BasicCPU<MemoryT> &cpu, MemoryT &,
+             Screen &, Keypad &) {
+	for (std::uint8_t i = 0; i <= (std::uint8_t)instruction.x; i++) {
+		cpu.rpl_flags[i] = cpu.registers[i];
+	}
+	return Trap::None;
+}
+
+template <typename MemoryT>
+Trap LD_VX_R(Instruction instruction, BasicCPU<MemoryT> &cpu, MemoryT &,
+             Screen &, Keypad &) {
+	for (std::uint8_t i = 0; i <= (std::uint8_t)instruction.x; i++) {
+		cpu.registers[i] = cpu.rpl_flags[i];
+	}
+	return Trap::None;
+}
+
+template <typename MemoryT>
+Trap LD_I_LONG(Instruction, BasicCPU<MemoryT> &cpu, MemoryT &memory, Screen &,
+               Keypad &) {
+	// the 4 KiB address space has no use for it
+	if constexpr (MemoryT::RAM_SIZE <= 0x1000) {
+		return Trap::InvalidOpcode;
+	} else {
+		// the address is the next word of the instruction stream
+		cpu.index = memory.fetch_word(cpu.pc);
+		cpu.pc = (cpu.pc + 2) & MemoryT::ADDRESS_MASK;
+		return Trap::None;
+	}
 }
 
 } // namespace instructions
 
-std::span<InstructionCallback> getInstructionList() {
+template <typename MemoryT>
+std::span<BasicInstructionCallback<MemoryT>> getInstructionList() {
 	// map all the instructions to the callback functions
 	// if the instruction is not implemented, use the notImplemented function
-	static std::array<InstructionCallback, (size_t)InstructionEnum::COUNT>
+	static std::array<BasicInstructionCallback<MemoryT>,
+	                  (size_t)InstructionEnum::COUNT>
 	    instructionList{
 	        // Invalid instruction
-	        instructions::invalid,
+	        instructions::invalid<MemoryT>,
 	        // sys
-	        instructions::noop,
+	        instructions::noop<MemoryT>,
 	        // cls
-	        instructions::CLS,
+	        instructions::CLS<MemoryT>,
 	        // ret
-	        instructions::RET,
+	        instructions::RET<MemoryT>,
 	        // JMP_NNN
-	        instructions::JMP_NNN,
+	        instructions::JMP_NNN<MemoryT>,
 	        // CALL_NNN
-	        instructions::CALL_NNN,
+	        instructions::CALL_NNN<MemoryT>,
 	        // SE_VX_NN
-	        instructions::SE_VX_NN,
+	        instructions::SE_VX_NN<MemoryT>,
 	        // SNE_VX_NN
-	        instructions::SNE_VX_NN,
+	        instructions::SNE_VX_NN<MemoryT>,
 	        // SE_VX_VY
-	        instructions::SE_VX_VY,
+	        instructions::SE_VX_VY<MemoryT>,
 	        // LD_VX_NN
-	        instructions::LD_VX_NN,
+	        instructions::LD_VX_NN<MemoryT>,
 	        // ADD_VX_NN
-	        instructions::ADD_VX_NN,
+	        instructions::ADD_VX_NN<MemoryT>,
 	        // LD_VX_VY
-	        instructions::LD_VX_VY,
+	        instructions::LD_VX_VY<MemoryT>,
 	        // OR_VX_VY
-	        instructions::OR_VX_VY,
+	        instructions::OR_VX_VY<MemoryT>,
 	        // AND_VX_VY
-	        instructions::AND_VX_VY,
+	        instructions::AND_VX_VY<MemoryT>,
 	        // XOR_VX_VY
-	        instructions::XOR_VX_VY,
+	        instructions::XOR_VX_VY<MemoryT>,
 	        // ADD_VX_VY
-	        instructions::ADD_VX_VY,
+	        instructions::ADD_VX_VY<MemoryT>,
 	        // SUB_VX_VY
-	        instructions::SUB_VX_VY,
+	        instructions::SUB_VX_VY<MemoryT>,
 	        // SHR_VX_VY
-	        instructions::SHR_VX_VY,
+	        instructions::SHR_VX_VY<MemoryT>,
 	        // SUBN_VX_VY
-	        instructions::SUBN_VX_VY,
+	        instructions::SUBN_VX_VY<MemoryT>,
 	        // SHL_VX_VY
-	        instructions::SHL_VX_VY,
+	        instructions::SHL_VX_VY<MemoryT>,
 	        // SNE_VX_VY
-	        instructions::SNE_VX_VY,
+	        instructions::SNE_VX_VY<MemoryT>,
 	        // LD_I_NNN
-	        instructions::LD_I_NNN,
+	        instructions::LD_I_NNN<MemoryT>,
 	        // JMP_V0_NNN
-	        instructions::JMP_V0_NNN,
+	        instructions::JMP_V0_NNN<MemoryT>,
 	        // RND_VX_NN
-	        instructions::RND_VX_NN,
+	        instructions::RND_VX_NN<MemoryT>,
 	        // DRW_VX_VY_N
-	        instructions::DRW_VX_VY_N,
+	        instructions::DRW_VX_VY_N<MemoryT>,
 	        // SKP_VX
-	        instructions::SKP_VX,
+	        instructions::SKP_VX<MemoryT>,
 	        // SKNP_VX
-	        instructions::SKNP_VX,
+	        instructions::SKNP_VX<MemoryT>,
 	        // LD_VX_DT
-	        instructions::LD_VX_DT,
+	        instructions::LD_VX_DT<MemoryT>,
 	        // LD_VX_K
-	        instructions::LD_VX_K,
+	        instructions::LD_VX_K<MemoryT>,
 	        // LD_DT_VX
-	        instructions::LD_DT_VX,
+	        instructions::LD_DT_VX<MemoryT>,
 	        // LD_ST_VX
-	        instructions::LD_ST_VX,
+	        instructions::LD_ST_VX<MemoryT>,
 	        // ADD_I_VX
-	        instructions::ADD_I_VX,
+	        instructions::ADD_I_VX<MemoryT>,
 	        // LD_F_VX
-	        instructions::LD_F_VX,
+	        instructions::LD_F_VX<MemoryT>,
 	        // LD_B_VX
-	        instructions::LD_B_VX,
+	        instructions::LD_B_VX<MemoryT>,
 	        // LD_I_VX
-	        instructions::LD_I_VX,
+	        instructions::LD_I_VX<MemoryT>,
 	        // LD_VX_I
-	        instructions::LD_VX_I,
+	        instructions::LD_VX_I<MemoryT>,
+	        // SCD_N
+	        instructions::SCD_N<MemoryT>,
+	        // SCR
+	        instructions::SCR<MemoryT>,
+	        // SCL
+	        instructions::SCL<MemoryT>,
+	        // EXIT
+	        instructions::EXIT<MemoryT>,
+	        // LOW
+	        instructions::LOW<MemoryT>,
+	        // HIGH
+	        instructions::HIGH<MemoryT>,
+	        // LD_HF_VX
+	        instructions::LD_HF_VX<MemoryT>,
+	        // LD_R_VX
+	        instructions::LD_R_VX<MemoryT>,
+	        // LD_VX_R
+	        instructions::LD_VX_R<MemoryT>,
+	        // LD_I_LONG
+	        instructions::LD_I_LONG<MemoryT>,
 	    };
 
 	return instructionList;
 }
+
+template std::span<BasicInstructionCallback<Memory>>
+getInstructionList<Memory>();
+template std::span<BasicInstructionCallback<XoChipMemory>>
+getInstructionList<XoChipMemory>();
 } // namespace chip8pp
@@ -1,14 +1,90 @@
 #include <chip8pp/keypad.hpp>
 
 namespace chip8pp {
-bool Keypad::is_pressed(Key key) const {
-	return m_keys[static_cast<std::size_t>(key)];
-}
-void Keypad::press(Key key) { m_keys[static_cast<std::size_t>(key)] = true; }
-void Keypad::release(Key key) { m_keys[static_cast<std::size_t>(key)] = false; }
-void Keypad::clear() { m_keys.fill(false); }
-void Keypad::set(Key key, bool pressed) {
-	m_keys[static_cast<std::size_t>(key)] = pressed;
+
+Keypad::Keypad(std::size_t eventCapacity)
+    : m_events(eventCapacity), m_readLatencies(eventCapacity) {}
+
+bool Keypad::is_pressed(Key key) {
+	drainEvents();
+	auto &press = m_unreadPress[static_cast<std::size_t>(key)];
+	if (press) [[unlikely]] {
+		// first read since the key was pressed, a full queue drops the sample
+		auto latency = clock::now() - *press;
+		m_readLatencies.push(
+		    (std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+		        latency)
+		        .count());
+		press.reset();
+	}
+	std::uint16_t state = m_state.load(std::memory_order_acquire) |
+	                      m_held.load(std::memory_order_relaxed);
+	// a tap is reported once, whether the key is still down or not
+	std::uint16_t latched =
+	    m_latched.load(std::memory_order_relaxed) & bit(key);
+	if (latched) {
+		m_latched.fetch_and((std::uint16_t)~bit(key),
+		                    std::memory_order_relaxed);
+	}
+	return ((state | latched) & bit(key)) != 0;
+}
+
+void Keypad::press(Key key, clock::time_point time) {
+	m_latched.fetch_or(bit(key), std::memory_order_relaxed);
+	m_recentTaps |= bit(key);
+	m_state.fetch_or(bit(key), std::memory_order_release);
+	queue(key, true, time);
+}
+
+void Keypad::release(Key key, clock::time_point time) {
+	m_state.fetch_and((std::uint16_t)~bit(key), std::memory_order_release);
+	queue(key, false, time);
+}
+
+void Keypad::set(Key key, bool pressed, clock::time_point time) {
+	if (pressed) {
+		press(key, time);
+	} else {
+		release(key, time);
+	}
+}
+
+void Keypad::clear() {
+	m_state.store(0, std::memory_order_release);
+	m_latched.store(0, std::memory_order_relaxed);
+	m_recentTaps = 0;
+}
+
+void Keypad::hold(std::uint16_t mask) {
+	m_held.store(mask, std::memory_order_relaxed);
+}
+
+void Keypad::expireTaps() {
+	m_latched.fetch_and(m_recentTaps, std::memory_order_relaxed);
+	m_recentTaps = 0;
+}
+
+std::uint16_t Keypad::getState() const {
+	return m_state.load(std::memory_order_acquire) |
+	       m_held.load(std::memory_order_relaxed);
+}
+
+void Keypad::queue(Key key, bool pressed, clock::time_point time) {
+	// the state is already up to date, a full queue only loses the
+	// latency sample
+	m_events.push(Event{time, key, pressed});
+}
+
+void Keypad::drainEvents() {
+	m_events.consume([this](std::span<const Event> events) {
+		for (auto &event : events) {
+			auto &press = m_unreadPress[static_cast<std::size_t>(event.key)];
+			// keep the oldest press that was not read yet
+			if (event.pressed && !press) {
+				press = event.time;
+			}
+		}
+	});
 }
 
 } // namespace chip8pp
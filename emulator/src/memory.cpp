@@ -1,40 +1,48 @@
 #include <chip8pp/memory.hpp>
+#include <chip8pp/memoryTracker.hpp>
 #include <stdexcept>
 
-Memory::Memory() { reset(); }
+template <typename AccessPolicy, std::size_t Size>
+BasicMemory<AccessPolicy, Size>::BasicMemory() {
+	reset();
+}
 
-void Memory::load_rom(const std::byte *rom, std::size_t size,
-                      std::uint16_t offset) {
-	if (offset + size > 4096) {
+template <typename AccessPolicy, std::size_t Size>
+void BasicMemory<AccessPolicy, Size>::load_rom(const std::byte *rom,
+                                               std::size_t size,
+                                               std::uint16_t offset) {
+	if (offset + size > RAM_SIZE) {
 		throw std::runtime_error("ROM too large");
 	}
 	std::copy(rom, rom + size, memory.begin() + offset);
 }
 
-void Memory::load_rom(std::istream &rom, std::size_t size,
-                      std::uint16_t offset) {
-	if (offset + size > 4096) {
+template <typename AccessPolicy, std::size_t Size>
+void BasicMemory<AccessPolicy, Size>::load_rom(std::istream &rom,
+                                               std::size_t size,
+                                               std::uint16_t offset) {
+	if (offset + size > RAM_SIZE) {
 		throw std::runtime_error("ROM too large");
 	}
 	rom.read(reinterpret_cast<char *>(memory.data() + offset), size);
 }
 
-std::byte *Memory::get_memory() { return memory.data(); }
-
-std::uint16_t *Memory::get_stack() { return stack.data(); }
-
-std::byte Memory::get_byte(std::uint16_t address) { return memory[address]; }
-
-std::uint16_t Memory::get_word(std::uint16_t address) {
-	return (static_cast<std::uint16_t>(memory[address]) << 8) |
-	       static_cast<std::uint16_t>(memory[address + 1]);
+template <typename AccessPolicy, std::size_t Size>
+std::byte *BasicMemory<AccessPolicy, Size>::get_memory() {
+	return memory.data();
 }
 
-void Memory::set_byte(std::uint16_t address, std::byte value) {
-	memory[address] = value;
+template <typename AccessPolicy, std::size_t Size>
+std::uint16_t *BasicMemory<AccessPolicy, Size>::get_stack() {
+	return stack.data();
 }
 
-void Memory::reset() {
+template <typename AccessPolicy, std::size_t Size>
+void BasicMemory<AccessPolicy, Size>::reset() {
 	std::fill(memory.begin(), memory.end(), std::byte(0));
 	std::fill(stack.begin(), stack.end(), std::uint16_t(0));
 }
+
+template class BasicMemory<NoAccessTracking>;
+template class BasicMemory<chip8pp::MemoryTracker>;
+template class BasicMemory<NoAccessTracking, 0x10000>;
@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <bit>
+#include <chip8pp/memoryTracker.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+// check if format is available
+#if __has_include(<format>)
+#include <format>
+using std::format;
+// if not, use fmt
+#elif __has_include(<fmt/format.h>)
+#include <fmt/format.h>
+using fmt::format;
+#else
+#error "No <format> or <fmt/format.h> found"
+#endif
+
+namespace chip8pp {
+
+namespace {
+// addresses per heatmap row
+constexpr std::size_t HEATMAP_WIDTH = 64;
+
+// map a counter to 0-255 using a log2 scale relative to the maximum
+std::uint8_t intensity(std::uint32_t value, std::uint32_t max) {
+	if (value == 0 || max == 0) {
+		return 0;
+	}
+	// +1 so a single access is still visible
+	unsigned bits = std::bit_width(value) + 1;
+	unsigned maxBits = std::bit_width(max) + 1;
+	return (std::uint8_t)(bits * 255 / maxBits);
+}
+} // namespace
+
+void MemoryTracker::addWatch(std::uint16_t begin, std::uint16_t end,
+                             std::uint8_t access) {
+	end = std::min<std::uint16_t>(end, SIZE - 1);
+	for (std::size_t address = begin; address <= end; address++) {
+		m_watch[address] |= access;
+	}
+}
+
+void MemoryTracker::clearWatches() { m_watch.fill(0); }
+
+void MemoryTracker::setWatchCallback(WatchCallback callback) {
+	m_callback = std::move(callback);
+}
+
+void MemoryTracker::notify(std::uint16_t address, Access access,
+                           std::byte value) {
+	if (m_callback) {
+		m_callback(WatchHit{address, access, value});
+	}
+}
+
+std::uint32_t MemoryTracker::getReads(std::uint16_t address) const {
+	return m_reads[address & (SIZE - 1)];
+}
+
+std::uint32_t MemoryTracker::getWrites(std::uint16_t address) const {
+	return m_writes[address & (SIZE - 1)];
+}
+
+std::uint32_t MemoryTracker::getExecutes(std::uint16_t address) const {
+	return m_executes[address & (SIZE - 1)];
+}
+
+void MemoryTracker::reset() {
+	m_reads.fill(0);
+	m_writes.fill(0);
+	m_executes.fill(0);
+}
+
+void MemoryTracker::writeCsv(std::ostream &output) const {
+	output << "address,reads,writes,executes\n";
+	for (std::size_t address = 0; address < SIZE; address++) {
+		output << format("{:#05x},{},{},{}\n", address, m_reads[address],
+		                 m_writes[address], m_executes[address]);
+	}
+}
+
+void MemoryTracker::writeHeatmap(std::ostream &output,
+                                 std::size_t scale) const {
+	scale = std::max<std::size_t>(scale, 1);
+	std::uint32_t maxReads = *std::max_element(m_reads.begin(), m_reads.end());
+	std::uint32_t maxWrites =
+	    *std::max_element(m_writes.begin(), m_writes.end());
+	std::uint32_t maxExecutes =
+	    *std::max_element(m_executes.begin(), m_executes.end());
+
+	std::size_t width = HEATMAP_WIDTH * scale;
+	std::size_t height = (SIZE / HEATMAP_WIDTH) * scale;
+	output << format("P6\n{} {}\n255\n", width, height);
+	std::vector<char> row(width * 3);
+	for (std::size_t y = 0; y < height; y++) {
+		for (std::size_t x = 0; x < width; x++) {
+			std::size_t address = (y / scale) * HEATMAP_WIDTH + x / scale;
+			row[x * 3 + 0] = (char)intensity(m_writes[address], maxWrites);
+			row[x * 3 + 1] = (char)intensity(m_reads[address], maxReads);
+			row[x * 3 + 2] =
+			    (char)intensity(m_executes[address], maxExecutes);
+		}
+		output.write(row.data(), (std::streamsize)row.size());
+	}
+}
+
+} // namespace chip8pp
@@ -0,0 +1,38 @@
+#include <chip8pp/predecodedCore.hpp>
+#include <cstddef>
+#include <cstdint>
+
+namespace chip8pp {
+
+// the entries start as the decoded 0000, which is right for any zero opcode
+template <typename MemoryT>
+BasicPredecodedCore<MemoryT>::BasicPredecodedCore()
+    : m_decoded(MemoryT::RAM_SIZE, CPUState::decode(0x0000)) {}
+
+template <typename MemoryT>
+Trap BasicPredecodedCore<MemoryT>::step(BasicSession<MemoryT> &session) {
+	auto &cpu = session.cpu;
+	std::uint16_t address = cpu.pc & MemoryT::ADDRESS_MASK;
+	std::uint16_t opcode = cpu.fetch(session.memory);
+	Instruction &instruction = m_decoded[address];
+	if (instruction.opcode != opcode) [[unlikely]] {
+		instruction = CPUState::decode(opcode);
+	}
+	static const auto handlers = getInstructionList<MemoryT>();
+	Trap result = Trap::InvalidOpcode;
+	if (instruction.instruction < InstructionEnum::COUNT) [[likely]] {
+		result = handlers[static_cast<std::size_t>(instruction.instruction)](
+		    instruction, cpu, session.memory, session.screen, session.keypad);
+	}
+	if (result != Trap::None) [[unlikely]] {
+		cpu.trap = result;
+		cpu.trap_pc = cpu.instruction_pc;
+		cpu.trap_opcode = instruction.opcode;
+	}
+	return result;
+}
+
+template class BasicPredecodedCore<Memory>;
+template class BasicPredecodedCore<XoChipMemory>;
+
+} // namespace chip8pp
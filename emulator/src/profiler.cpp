@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <chip8pp/cpu.hpp>
+#include <chip8pp/disassembler.hpp>
+#include <chip8pp/profiler.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <set>
+// check if format is available
+#if __has_include(<format>)
+#include <format>
+using std::format;
+// if not, use fmt
+#elif __has_include(<fmt/format.h>)
+#include <fmt/format.h>
+using fmt::format;
+#else
+#error "No <format> or <fmt/format.h> found"
+#endif
+
+namespace chip8pp {
+
+namespace {
+// number of entries shown in the hotspot table
+constexpr std::size_t HOTSPOT_COUNT = 20;
+
+double percent(std::uint64_t value, std::uint64_t total) {
+	return total == 0 ? 0.0 : 100.0 * (double)value / (double)total;
+}
+
+// read from the raw bytes, get_word would count as a rom read in the memory
+// tracking build and trigger its watches
+std::uint16_t opcodeAt(const std::byte *memory, std::uint16_t address) {
+	return (std::uint16_t)(((std::uint16_t)memory[address] << 8) |
+	                       (std::uint16_t)memory[(address + 1) &
+	                                             (Memory::RAM_SIZE - 1)]);
+}
+} // namespace
+
+Profiler::Profiler(std::uint32_t interval)
+    : m_interval(std::max<std::uint32_t>(interval, 1)),
+      m_countdown(m_interval) {}
+
+std::uint64_t Profiler::getSampleCount() const { return m_samples; }
+
+std::uint16_t Profiler::routineAt(std::size_t depth) const {
+	// depth 0 is the program entry point
+	if (depth == 0) {
+		return Memory::ROM_START;
+	}
+	return m_routines[depth - 1];
+}
+
+void Profiler::recordCall(const CPU &cpu) {
+	// the call already executed, so sp points past the return address and
+	// pc holds the callee entry point
+	if (cpu.sp == 0 || cpu.sp > CPU::STACK_SIZE) {
+		return;
+	}
+	m_routines[cpu.sp - 1] = cpu.pc;
+	m_calls[{routineAt(cpu.sp - 1), cpu.pc}]++;
+}
+
+void Profiler::sample(const CPU &cpu) {
+	m_samples++;
+	m_hits[cpu.pc & (Memory::RAM_SIZE - 1)]++;
+	std::size_t depth = std::min(cpu.sp, CPU::STACK_SIZE);
+	std::vector<std::uint16_t> chain;
+	chain.reserve(depth + 1);
+	for (std::size_t i = 0; i <= depth; i++) {
+		chain.push_back(routineAt(i));
+	}
+	m_stacks[std::move(chain)]++;
+}
+
+void Profiler::writeFoldedStacks(std::ostream &output) const {
+	for (auto &[chain, count] : m_stacks) {
+		std::string line;
+		for (std::size_t i = 0; i < chain.size(); i++) {
+			if (i != 0) {
+				line += ';';
+			}
+			line += format("sub_{:03x}", chain[i]);
+		}
+		output << format("{} {}\n", line, count);
+	}
+}
+
+void Profiler::writeListing(std::ostream &output, Memory &memory) const {
+	output << format("; {} samples, 1 every {} instructions\n", m_samples,
+	                 m_interval);
+	const std::byte *bytes = memory.get_memory();
+
+	// hotspot table, sorted by hit count
+	std::vector<std::uint16_t> hot;
+	for (std::size_t address = 0; address < m_hits.size(); address++) {
+		if (m_hits[address] != 0) {
+			hot.push_back((std::uint16_t)address);
+		}
+	}
+	std::vector<std::uint16_t> ranked = hot;
+	std::sort(ranked.begin(), ranked.end(),
+	          [this](std::uint16_t a, std::uint16_t b) {
+		          return m_hits[a] > m_hits[b];
+	          });
+	ranked.resize(std::min(ranked.size(), HOTSPOT_COUNT));
+	output << ";\n; hotspots\n";
+	for (auto address : ranked) {
+		Instruction instruction = CPU::decode(opcodeAt(bytes, address));
+		output << format(";   {:#05x} {:>10} {:6.2f}%  {}\n", address,
+		                 m_hits[address], percent(m_hits[address], m_samples),
+		                 disassemble(instruction));
+	}
+
+	// call graph
+	output << ";\n; call graph (caller -> callee: calls)\n";
+	std::set<std::uint16_t> routines;
+	for (auto &[edge, count] : m_calls) {
+		output << format(";   sub_{:03x} -> sub_{:03x}: {}\n", edge.first,
+		                 edge.second, count);
+		routines.insert(edge.second);
+	}
+
+	// annotated listing of the sampled addresses
+	output << ";\n";
+	std::uint16_t next = 0;
+	for (auto address : hot) {
+		if (address != next && next != 0) {
+			output << "        ...\n";
+		}
+		if (routines.contains(address)) {
+			output << format("sub_{:03x}:\n", address);
+		}
+		std::uint16_t opcode = opcodeAt(bytes, address);
+		output << format("  {:03x}  {:04x}  {:<20} ; {:>10} {:6.2f}%\n",
+		                 address, opcode, disassemble(CPU::decode(opcode)),
+		                 m_hits[address], percent(m_hits[address], m_samples));
+		next = address + 2;
+	}
+}
+
+} // namespace chip8pp
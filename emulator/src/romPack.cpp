@@ -0,0 +1,338 @@
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <chip8pp/hash.hpp>
+#include <chip8pp/romPack.hpp>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+// check if format is available
+#if __has_include(<format>)
+#include <format>
+using std::format;
+// if not, use fmt
+#elif __has_include(<fmt/format.h>)
+#include <fmt/format.h>
+using fmt::format;
+#else
+#error "No <format> or <fmt/format.h> found"
+#endif
+
+#if __has_include(<sys/mman.h>)
+#define CHIP8PP_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace chip8pp {
+
+void RomPack::Rom::configure(CPUState &cpu) const {
+	for (std::size_t i = 0; i < cpu.quirks.size(); i++) {
+		cpu.quirks[i] = (quirks >> i) & 1;
+	}
+}
+
+RomPack::RomPack(std::filesystem::path const &path) {
+#ifdef CHIP8PP_HAS_MMAP
+	int fd = ::open(path.c_str(), O_RDONLY);
+	struct stat info {};
+	if (fd >= 0 && fstat(fd, &info) == 0 && info.st_size > 0) {
+		void *data =
+		    mmap(nullptr, (std::size_t)info.st_size, PROT_READ, MAP_PRIVATE,
+		         fd, 0);
+		if (data != MAP_FAILED) {
+			m_data = static_cast<const std::byte *>(data);
+			m_size = (std::size_t)info.st_size;
+			m_mapped = true;
+		}
+	}
+	if (fd >= 0) {
+		::close(fd);
+	}
+#endif
+	if (!m_mapped) {
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file.is_open()) {
+			throw std::runtime_error(
+			    format("Could not open rom pack {}", path.string()));
+		}
+		m_buffer.resize((std::size_t)file.tellg());
+		file.seekg(0);
+		file.read(reinterpret_cast<char *>(m_buffer.data()),
+		          (std::streamsize)m_buffer.size());
+		m_data = m_buffer.data();
+		m_size = m_buffer.size();
+	}
+
+	// check every offset once, the lookups trust them afterwards
+	auto invalid = [&](std::string_view reason) {
+		release();
+		return std::runtime_error(
+		    format("Invalid rom pack {}: {}", path.string(), reason));
+	};
+	if (m_size < sizeof(RomPackHeader) ||
+	    header().magic != RomPackHeader::MAGIC) {
+		throw invalid("not a rom pack");
+	}
+	auto &head = header();
+	if (head.version != RomPackHeader::VERSION ||
+	    head.entrySize != sizeof(RomPackEntry)) {
+		throw invalid(format("unsupported version {}", head.version));
+	}
+	if (head.totalSize != m_size) {
+		throw invalid("truncated");
+	}
+	// offset and size are compared without adding them, a crafted offset
+	// could wrap the sum around
+	auto outside = [&](std::uint64_t offset, std::uint64_t size) {
+		return offset > m_size || size > m_size - offset;
+	};
+	// romCount is 32 bits, the sizes cannot overflow
+	std::uint64_t entriesEnd =
+	    sizeof(RomPackHeader) +
+	    (std::uint64_t)head.romCount * sizeof(RomPackEntry);
+	if (entriesEnd > m_size || head.nameIndexOffset % 4 != 0 ||
+	    head.nameIndexOffset < entriesEnd ||
+	    outside(head.nameIndexOffset, (std::uint64_t)head.romCount * 4)) {
+		throw invalid("index out of bounds");
+	}
+	for (std::size_t i = 0; i < head.romCount; i++) {
+		auto &current = entry(i);
+		if (outside(current.dataOffset, current.size) ||
+		    outside(current.nameOffset, current.nameLength) ||
+		    nameIndex(i) >= head.romCount) {
+			throw invalid(format("entry {} out of bounds", i));
+		}
+	}
+}
+
+RomPack::RomPack(RomPack &&other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr)),
+      m_size(std::exchange(other.m_size, 0)),
+      m_mapped(std::exchange(other.m_mapped, false)),
+      m_buffer(std::move(other.m_buffer)) {}
+
+RomPack &RomPack::operator=(RomPack &&other) noexcept {
+	if (this != &other) {
+		release();
+		m_data = std::exchange(other.m_data, nullptr);
+		m_size = std::exchange(other.m_size, 0);
+		m_mapped = std::exchange(other.m_mapped, false);
+		m_buffer = std::move(other.m_buffer);
+	}
+	return *this;
+}
+
+RomPack::~RomPack() { release(); }
+
+void RomPack::release() {
+#ifdef CHIP8PP_HAS_MMAP
+	if (m_mapped) {
+		munmap(const_cast<std::byte *>(m_data), m_size);
+	}
+#endif
+	m_data = nullptr;
+	m_size = 0;
+	m_mapped = false;
+	m_buffer.clear();
+}
+
+std::uint64_t RomPack::hash(std::span<const std::byte> rom) {
+	return xxh64(rom.data(), rom.size());
+}
+
+RomPackHeader const &RomPack::header() const {
+	return *reinterpret_cast<const RomPackHeader *>(m_data);
+}
+
+RomPackEntry const &RomPack::entry(std::size_t index) const {
+	return reinterpret_cast<const RomPackEntry *>(
+	    m_data + sizeof(RomPackHeader))[index];
+}
+
+std::string_view RomPack::nameOf(RomPackEntry const &entry) const {
+	return {reinterpret_cast<const char *>(m_data + entry.nameOffset),
+	        entry.nameLength};
+}
+
+std::uint32_t RomPack::nameIndex(std::size_t position) const {
+	return reinterpret_cast<const std::uint32_t *>(
+	    m_data + header().nameIndexOffset)[position];
+}
+
+std::size_t RomPack::size() const { return m_data ? header().romCount : 0; }
+
+RomPack::Rom RomPack::at(std::size_t index) const {
+	auto &current = entry(index);
+	return {nameOf(current),
+	        current.hash,
+	        {m_data + current.dataOffset, current.size},
+	        current.origin,
+	        current.quirks,
+	        current.cyclesPerFrame};
+}
+
+std::optional<RomPack::Rom> RomPack::findHash(std::uint64_t hash) const {
+	std::size_t first = 0;
+	std::size_t count = size();
+	// lower bound over the entries
+	while (count > 0) {
+		std::size_t step = count / 2;
+		if (entry(first + step).hash < hash) {
+			first += step + 1;
+			count -= step + 1;
+		} else {
+			count = step;
+		}
+	}
+	if (first == size() || entry(first).hash != hash) {
+		return std::nullopt;
+	}
+	return at(first);
+}
+
+std::optional<RomPack::Rom> RomPack::findName(std::string_view name) const {
+	std::size_t first = 0;
+	std::size_t count = size();
+	while (count > 0) {
+		std::size_t step = count / 2;
+		if (nameOf(entry(nameIndex(first + step))) < name) {
+			first += step + 1;
+			count -= step + 1;
+		} else {
+			count = step;
+		}
+	}
+	if (first == size() || nameOf(entry(nameIndex(first))) != name) {
+		return std::nullopt;
+	}
+	return at(nameIndex(first));
+}
+
+std::optional<RomPack::Rom> RomPack::find(std::string_view key) const {
+	if (auto rom = findName(key)) {
+		return rom;
+	}
+	std::uint64_t hash = 0;
+	auto [end, error] =
+	    std::from_chars(key.data(), key.data() + key.size(), hash, 16);
+	if (key.size() != 16 || error != std::errc{} ||
+	    end != key.data() + key.size()) {
+		return std::nullopt;
+	}
+	return findHash(hash);
+}
+
+void RomPackBuilder::add(std::string name, std::span<const std::byte> rom,
+                         std::uint16_t quirks, std::uint16_t cyclesPerFrame,
+                         std::uint16_t origin) {
+	if (name.size() > 0xFFFF) {
+		throw std::runtime_error("Rom name too long");
+	}
+	Input &input = m_roms.emplace_back();
+	input.name = std::move(name);
+	input.data.assign(rom.begin(), rom.end());
+	input.entry.hash = RomPack::hash(rom);
+	input.entry.size = (std::uint32_t)rom.size();
+	input.entry.nameLength = (std::uint16_t)input.name.size();
+	input.entry.origin = origin;
+	input.entry.quirks = quirks;
+	input.entry.cyclesPerFrame = cyclesPerFrame;
+}
+
+void RomPackBuilder::write(std::filesystem::path const &path) const {
+	std::vector<std::size_t> order(m_roms.size());
+	for (std::size_t i = 0; i < order.size(); i++) {
+		order[i] = i;
+	}
+	std::sort(order.begin(), order.end(), [&](auto left, auto right) {
+		auto &a = m_roms[left];
+		auto &b = m_roms[right];
+		return std::tie(a.entry.hash, a.name) < std::tie(b.entry.hash, b.name);
+	});
+	RomPackHeader header;
+	header.entrySize = sizeof(RomPackEntry);
+	header.romCount = (std::uint32_t)m_roms.size();
+	header.nameIndexOffset =
+	    sizeof(RomPackHeader) + m_roms.size() * sizeof(RomPackEntry);
+
+	// lay out the names, then the contents of the different roms
+	std::vector<RomPackEntry> entries;
+	std::uint64_t offset = header.nameIndexOffset + m_roms.size() * 4;
+	for (auto index : order) {
+		auto &rom = m_roms[index];
+		entries.push_back(rom.entry);
+		entries.back().nameOffset = (std::uint32_t)offset;
+		offset += rom.name.size();
+	}
+	if (offset > 0xFFFFFFFF) {
+		throw std::runtime_error("Rom names too long");
+	}
+	// the same content is stored once, with the offset of its first copy
+	std::vector<std::pair<const Input *, std::uint64_t>> contents;
+	for (std::size_t i = 0; i < order.size(); i++) {
+		auto &rom = m_roms[order[i]];
+		// the roms are in hash order, only the last contents can match
+		auto same = std::find_if(
+		    contents.rbegin(), contents.rend(), [&](auto const &stored) {
+			    return stored.first->entry.hash != rom.entry.hash ||
+			           stored.first->data == rom.data;
+		    });
+		if (same != contents.rend() &&
+		    same->first->entry.hash == rom.entry.hash) {
+			entries[i].dataOffset = same->second;
+			continue;
+		}
+		contents.emplace_back(&rom, offset);
+		entries[i].dataOffset = offset;
+		offset += rom.data.size();
+	}
+	header.totalSize = offset;
+
+	// entry numbers in name order
+	std::vector<std::uint32_t> names(entries.size());
+	for (std::size_t i = 0; i < names.size(); i++) {
+		names[i] = (std::uint32_t)i;
+	}
+	std::sort(names.begin(), names.end(), [&](auto left, auto right) {
+		return m_roms[order[left]].name < m_roms[order[right]].name;
+	});
+	for (std::size_t i = 1; i < names.size(); i++) {
+		auto &name = m_roms[order[names[i]]].name;
+		if (name == m_roms[order[names[i - 1]]].name) {
+			throw std::runtime_error(
+			    format("Rom {} is in the pack twice", name));
+		}
+	}
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		throw std::runtime_error(
+		    format("Could not create rom pack {}", path.string()));
+	}
+	file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char *>(entries.data()),
+	           (std::streamsize)(entries.size() * sizeof(RomPackEntry)));
+	file.write(reinterpret_cast<const char *>(names.data()),
+	           (std::streamsize)(names.size() * sizeof(std::uint32_t)));
+	for (auto index : order) {
+		file.write(m_roms[index].name.data(),
+		           (std::streamsize)m_roms[index].name.size());
+	}
+	for (auto &[rom, _] : contents) {
+		file.write(reinterpret_cast<const char *>(rom->data.data()),
+		           (std::streamsize)rom->data.size());
+	}
+	if (!file) {
+		throw std::runtime_error(
+		    format("Could not write rom pack {}", path.string()));
+	}
+}
+
+std::size_t RomPackBuilder::size() const { return m_roms.size(); }
+
+} // namespace chip8pp
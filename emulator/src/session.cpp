@@ -0,0 +1,122 @@
+#include <algorithm>
+#include <chip8pp/hash.hpp>
+#include <chip8pp/session.hpp>
+#include <chip8pp/utils.hpp>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+// check if format is available
+#if __has_include(<format>)
+#include <format>
+using std::format;
+// if not, use fmt
+#elif __has_include(<fmt/format.h>)
+#include <fmt/format.h>
+using fmt::format;
+#else
+#error "No <format> or <fmt/format.h> found"
+#endif
+
+namespace chip8pp {
+
+InputMovie InputMovie::load(std::filesystem::path const &path) {
+	std::ifstream file(path);
+	if (!file.is_open()) {
+		throw std::runtime_error(
+		    format("Could not open input movie {}", path.string()));
+	}
+	InputMovie movie;
+	std::string line;
+	for (std::size_t number = 1; std::getline(file, line); number++) {
+		std::istringstream fields(line);
+		std::string frame;
+		std::string mask;
+		if (!(fields >> frame) || frame.starts_with('#')) {
+			continue;
+		}
+		try {
+			if (!(fields >> mask)) {
+				throw std::invalid_argument("missing key mask");
+			}
+			movie.m_changes.emplace_back(std::stoull(frame),
+			                             utils::parse_number(mask));
+		} catch (const std::exception &) {
+			throw std::runtime_error(format("{}:{}: expected <frame> <mask>",
+			                                path.string(), number));
+		}
+	}
+	std::stable_sort(
+	    movie.m_changes.begin(), movie.m_changes.end(),
+	    [](auto &left, auto &right) { return left.first < right.first; });
+	return movie;
+}
+
+std::uint16_t InputMovie::keysAt(std::uint64_t frame) const {
+	// last change made at or before the frame
+	auto next = std::upper_bound(
+	    m_changes.begin(), m_changes.end(), frame,
+	    [](std::uint64_t value, auto &change) { return value < change.first; });
+	return next == m_changes.begin() ? 0 : std::prev(next)->second;
+}
+
+template <typename MemoryT>
+BasicSession<MemoryT>::BasicSession(std::span<const std::byte> rom,
+                                    std::uint32_t seed,
+                                    std::size_t cyclesPerFrame)
+    : screen(0, 0), cyclesPerFrame(cyclesPerFrame) {
+	// store the fonts as the emulator does
+	memory.load_rom(font, sizeof(font), MemoryT::FONT_OFFSET);
+	memory.load_rom(bigFont, sizeof(bigFont), MemoryT::BIG_FONT_OFFSET);
+	memory.load_rom(rom.data(), rom.size());
+	cpu.seedRandom(seed);
+	screen.initHeadless(WIDTH, HEIGHT, MAX_WIDTH, MAX_HEIGHT);
+}
+
+template <typename MemoryT>
+void BasicSession<MemoryT>::setKeys(std::uint16_t mask) {
+	std::uint16_t changed = keypad.getState() ^ mask;
+	for (std::size_t key = 0; key < 16; key++) {
+		if (changed & (1 << key)) {
+			keypad.set(static_cast<Keypad::Key>(key), mask & (1 << key));
+		}
+	}
+}
+
+template <typename MemoryT>
+std::optional<Trap> BasicSession<MemoryT>::runFrame() {
+	for (std::size_t cycle = 0; cycle < cyclesPerFrame && !halted; cycle++) {
+		std::uint16_t opcode = cpu.fetch(memory);
+		Trap trap = cpu.execute(cpu.decode(opcode), memory, screen, keypad);
+		if (trap != Trap::None &&
+		    cpu.getTrapPolicy(trap) == TrapPolicy::Halt) {
+			halted = trap;
+		}
+	}
+	cpu.timerTick();
+	// the frame is the input period of a session
+	keypad.expireTaps();
+	frame++;
+	return halted;
+}
+
+template <typename MemoryT>
+Grid::FrameView BasicSession<MemoryT>::getFrame() {
+	// the cpu drew on this thread
+	screen.flush();
+	screen.update();
+	return screen.getFrame();
+}
+
+template <typename MemoryT>
+std::uint64_t BasicSession<MemoryT>::frameHash() {
+	auto view = getFrame();
+	return xxh64(view.rows,
+	             view.wordsPerRow * view.height * sizeof(std::uint64_t),
+	             (std::uint64_t)view.width << 32 | view.height);
+}
+
+template struct BasicSession<Memory>;
+template struct BasicSession<XoChipMemory>;
+
+} // namespace chip8pp
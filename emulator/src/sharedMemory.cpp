@@ -0,0 +1,160 @@
+#include <cerrno>
+#include <chip8pp/sharedMemory.hpp>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <utility>
+// check if format is available
+#if __has_include(<format>)
+#include <format>
+using std::format;
+// if not, use fmt
+#elif __has_include(<fmt/format.h>)
+#include <fmt/format.h>
+using fmt::format;
+#else
+#error "No <format> or <fmt/format.h> found"
+#endif
+
+#if __has_include(<sys/mman.h>)
+#define CHIP8PP_HAS_SHM 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#if __has_include(<unistd.h>)
+#include <unistd.h>
+#endif
+
+namespace chip8pp {
+
+std::uint32_t SharedMemory::processId() {
+#if __has_include(<unistd.h>)
+	return (std::uint32_t)getpid();
+#else
+	return 0;
+#endif
+}
+
+SharedMemory::SharedMemory(std::string name, void *data, std::size_t size,
+                           bool owner)
+    : m_name(std::move(name)), m_data(data), m_size(size), m_owner(owner) {}
+
+SharedMemory::SharedMemory(SharedMemory &&other) noexcept
+    : m_name(std::move(other.m_name)),
+      m_data(std::exchange(other.m_data, nullptr)),
+      m_size(std::exchange(other.m_size, 0)),
+      m_owner(std::exchange(other.m_owner, false)) {}
+
+SharedMemory &SharedMemory::operator=(SharedMemory &&other) noexcept {
+	if (this != &other) {
+		release();
+		m_name = std::move(other.m_name);
+		m_data = std::exchange(other.m_data, nullptr);
+		m_size = std::exchange(other.m_size, 0);
+		m_owner = std::exchange(other.m_owner, false);
+	}
+	return *this;
+}
+
+SharedMemory::~SharedMemory() { release(); }
+
+void *SharedMemory::data() const { return m_data; }
+
+std::size_t SharedMemory::size() const { return m_size; }
+
+std::string const &SharedMemory::name() const { return m_name; }
+
+#ifdef CHIP8PP_HAS_SHM
+
+SharedMemory SharedMemory::create(std::string const &name, std::size_t size) {
+	std::string path = "/" + name;
+	// remove a leftover segment of a crashed process with the same name
+	shm_unlink(path.c_str());
+	int fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+	if (fd < 0) {
+		throw std::runtime_error(format("Could not create shared memory {}: {}",
+		                                name, std::strerror(errno)));
+	}
+	if (ftruncate(fd, (off_t)size) != 0) {
+		int error = errno;
+		close(fd);
+		shm_unlink(path.c_str());
+		throw std::runtime_error(format("Could not resize shared memory {}: {}",
+		                                name, std::strerror(error)));
+	}
+	void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) {
+		shm_unlink(path.c_str());
+		throw std::runtime_error(
+		    format("Could not map shared memory {}", name));
+	}
+	return SharedMemory(name, data, size, true);
+}
+
+SharedMemory SharedMemory::open(std::string const &name) {
+	std::string path = "/" + name;
+	int fd = shm_open(path.c_str(), O_RDONLY, 0);
+	if (fd < 0) {
+		throw std::runtime_error(format("Could not open shared memory {}: {}",
+		                                name, std::strerror(errno)));
+	}
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+		close(fd);
+		throw std::runtime_error(format("Shared memory {} is empty", name));
+	}
+	auto size = (std::size_t)info.st_size;
+	void *data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) {
+		throw std::runtime_error(
+		    format("Could not map shared memory {}", name));
+	}
+	return SharedMemory(name, data, size, false);
+}
+
+std::vector<std::string> SharedMemory::list(std::string const &prefix) {
+	// linux exposes the segments in /dev/shm
+	std::vector<std::string> names;
+	std::error_code error;
+	for (auto &entry :
+	     std::filesystem::directory_iterator("/dev/shm", error)) {
+		std::string name = entry.path().filename().string();
+		if (name.starts_with(prefix)) {
+			names.push_back(name);
+		}
+	}
+	return names;
+}
+
+void SharedMemory::release() {
+	if (m_data) {
+		munmap(m_data, m_size);
+		m_data = nullptr;
+	}
+	if (m_owner) {
+		shm_unlink(("/" + m_name).c_str());
+		m_owner = false;
+	}
+}
+
+#else
+
+SharedMemory SharedMemory::create(std::string const &, std::size_t) {
+	throw std::runtime_error("Shared memory is not supported on this platform");
+}
+
+SharedMemory SharedMemory::open(std::string const &) {
+	throw std::runtime_error("Shared memory is not supported on this platform");
+}
+
+std::vector<std::string> SharedMemory::list(std::string const &) { return {}; }
+
+void SharedMemory::release() {}
+
+#endif
+
+} // namespace chip8pp
@@ -1,10 +1,16 @@
 #define SDL_MAIN_HANDLED
 
+#include <algorithm>
 #include <chrono>
 #include <format>
+#include <fstream>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include <SDL3/SDL.h>
 #include <SDL3/SDL_events.h>
@@ -14,33 +20,130 @@
 
 #include <libcanvas/screen.hpp>
 
+#include <chip8pp/beeper.hpp>
+#include <chip8pp/controlServer.hpp>
 #include <chip8pp/cpu.hpp>
+#include <chip8pp/debugConsole.hpp>
+#include <chip8pp/debugger.hpp>
+#include <chip8pp/framePacer.hpp>
+#include <chip8pp/framebufferExport.hpp>
+#include <chip8pp/frameStream.hpp>
 #include <chip8pp/instructions.hpp>
 #include <chip8pp/keypad.hpp>
 #include <chip8pp/memory.hpp>
+#include <chip8pp/profiler.hpp>
+#include <chip8pp/romPack.hpp>
+#include <chip8pp/stats.hpp>
+#include <chip8pp/trace.hpp>
 #include <chip8pp/utils.hpp>
 
 void cpu_thread_fn(std::stop_token stop_token, chip8pp::CPU &cpu,
-                   Memory &memory, Screen &screen, chip8pp::Keypad &keypad) {
+                   Memory &memory, Screen &screen, chip8pp::Keypad &keypad,
+                   chip8pp::Profiler *profiler, chip8pp::TraceWriter *tracer,
+                   chip8pp::StatsCounters &counters) {
+	// the instruction counter is published once every 1024 instructions
+	constexpr std::uint64_t stats_batch_mask = 1024 - 1;
 	try {
+		std::uint64_t cycle = 0;
+		// the debugger resumed in front of an instruction that must not be
+		// intercepted again
+		bool resumed = false;
+		auto execute = [&](chip8pp::Instruction instruction) {
+			if (resumed) [[unlikely]] {
+				resumed = false;
+				return cpu.debugger->executeResumed(instruction, screen,
+				                                    keypad);
+			}
+			return cpu.execute(instruction, memory, screen, keypad);
+		};
 		while (!stop_token.stop_requested()) {
-			// std::this_thread::sleep_for(std::chrono::milliseconds(100));
 			std::uint16_t opcode = cpu.fetch(memory);
-			// print the program counter and the opcode
-			// std::cout << format("PC: {:#04x} | Opcode: {:#06x}\n",
-			//                    (std::uint16_t)cpu.pc, opcode);
 			chip8pp::Instruction instruction = cpu.decode(opcode);
-			cpu.execute(instruction, memory, screen, keypad);
+			chip8pp::Trap trap;
+			if (tracer) {
+				// record the pc, opcode and changed register of the instruction
+				auto registers = cpu.registers;
+				trap = execute(instruction);
+				// an instruction the debugger stopped in front of runs later
+				if (trap != chip8pp::Trap::Breakpoint || !cpu.debugger ||
+				    !cpu.debugger->hasPendingInstruction()) {
+					tracer->record(cycle, cpu.instruction_pc, opcode, cpu,
+					               registers);
+				}
+			} else {
+				trap = execute(instruction);
+			}
+			if (trap == chip8pp::Trap::Breakpoint && cpu.debugger)
+			    [[unlikely]] {
+				std::cout << std::format("debugger: {}\n",
+				                         cpu.debugger->getStopReason())
+				          << std::flush;
+				// show the screen as it is at the stop
+				screen.flush();
+				if (!cpu.debugger->waitWhilePaused(stop_token)) {
+					break;
+				}
+				// run the instruction the cpu stopped in front of through
+				// the loop, so it is traced, profiled and counted
+				resumed = cpu.debugger->hasPendingInstruction();
+				if (resumed) {
+					continue;
+				}
+				trap = chip8pp::Trap::None;
+			}
+			if (trap != chip8pp::Trap::None) [[unlikely]] {
+				chip8pp::TrapPolicy policy = cpu.getTrapPolicy(trap);
+				if (policy != chip8pp::TrapPolicy::Skip) {
+					std::cerr << std::format(
+					    "{}: {} at {:#05x} (opcode {:#06x})\n",
+					    policy == chip8pp::TrapPolicy::Halt ? "cpu halted"
+					                                        : "trap",
+					    chip8pp::getTrapName(trap), cpu.trap_pc,
+					    cpu.trap_opcode);
+				}
+				if (policy == chip8pp::TrapPolicy::Halt) {
+					screen.flush();
+					// keep the instructions that led to the fault
+					if (tracer) {
+						tracer->snapshot();
+					}
+					break;
+				}
+			}
+			if (profiler) {
+				profiler->observe(instruction, cpu);
+			}
+			if ((++cycle & stats_batch_mask) == 0) {
+				counters.instructions.store(cycle, std::memory_order_relaxed);
+				// hand over the drawing when the main thread took the last
+				// frame
+				screen.poll();
+			}
 		}
 	} catch (std::exception &e) {
 		std::cerr << e.what() << std::endl;
 	}
 }
 
-void timer_thread_fn(std::stop_token stop_token, chip8pp::CPU &cpu) {
+// ticks the timers when no beeper does it on the audio clock
+void timer_thread_fn(std::stop_token stop_token, chip8pp::CPU &cpu,
+                     chip8pp::StatsCounters &counters) {
+	// 60Hz deadlines, a late wake up does not delay the next ticks
+	const auto tick_period =
+	    std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+	        std::chrono::duration<double>(1.0 / 60.0));
 	try {
+		auto next_tick = std::chrono::steady_clock::now() + tick_period;
 		while (!stop_token.stop_requested()) {
-			std::this_thread::sleep_for(std::chrono::milliseconds(16));
+			std::this_thread::sleep_until(next_tick);
+			auto now = std::chrono::steady_clock::now();
+			// woke up at least a full period late, a tick was missed
+			if (now - next_tick >= tick_period) {
+				counters.schedulerOverruns.fetch_add(1,
+				                                     std::memory_order_relaxed);
+				next_tick = now;
+			}
+			next_tick += tick_period;
 			cpu.timerTick();
 		}
 	} catch (std::exception &e) {
@@ -49,7 +152,11 @@ void timer_thread_fn(std::stop_token stop_token, chip8pp::CPU &cpu) {
 }
 
 void main_thread_fn(chip8pp::CPU &, Memory &, Screen &screen,
-                    chip8pp::Keypad &keypad) {
+                    chip8pp::Keypad &keypad, chip8pp::StatsPublisher *stats,
+                    chip8pp::ControlServer *control,
+                    chip8pp::FrameStreamWriter *recorder,
+                    chip8pp::FramebufferExport *framebuffer,
+                    std::size_t screenshot_scale, bool vsync) {
 	// hashmaps to map SDL keys to chip8 keys
 	std::unordered_map<SDL_Keycode, chip8pp::Keypad::Key> keymap = {
 	    // 1 2 3 C | 1 2 3 4
@@ -73,45 +180,126 @@ void main_thread_fn(chip8pp::CPU &, Memory &, Screen &screen,
 	    {SDLK_C, chip8pp::Keypad::Key::KEY_B},
 	    {SDLK_V, chip8pp::Keypad::Key::KEY_F},
 	};
-	// timer to draw each 16.666 ms
-	std::chrono::steady_clock::time_point last_draw =
-	    std::chrono::steady_clock::now();
+	// chip8 programs expect 60 frames per second, with vsync the display
+	// refresh rate is used instead
+	std::chrono::steady_clock::duration period =
+	    std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+	        std::chrono::duration<double>(1.0 / 60.0));
+	if (vsync && !screen.setVSync(true)) {
+		std::cout << "vsync unavailable, presenting on a timer\n";
+		vsync = false;
+	}
+	if (vsync && screen.getRefreshRate() > 0.0f) {
+		period =
+		    std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+		        std::chrono::duration<double>(1.0 / screen.getRefreshRate()));
+	}
+	chip8pp::FramePacer pacer(period, vsync);
+	// time of the oldest key event not presented yet
+	std::optional<std::chrono::steady_clock::time_point> pending_input;
+	std::size_t screenshot_count = 0;
 	bool continue_loop = true;
+	auto handle_event = [&](SDL_Event &event) {
+		switch (event.type) {
+		case SDL_EVENT_KEY_DOWN:
+		case SDL_EVENT_KEY_UP: {
+			// auto repeat does not change the keypad state
+			if (event.key.repeat) {
+				break;
+			}
+			bool down = event.type == SDL_EVENT_KEY_DOWN;
+			// event timestamps are on the SDL_GetTicksNS clock
+			auto age = std::chrono::nanoseconds(
+			    SDL_GetTicksNS() -
+			    std::min<Uint64>(event.key.timestamp, SDL_GetTicksNS()));
+			auto event_time = std::chrono::steady_clock::now() - age;
+			if (down && !pending_input) {
+				pending_input = event_time;
+			}
+			if (down && event.key.key == SDLK_F12) {
+				// save the presented frame next to the emulator
+				std::string name = std::format("chip8pp-screenshot-{}.ppm",
+				                               screenshot_count++);
+				std::ofstream screenshot(name, std::ios::binary);
+				screen.writeScreenshot(screenshot, screenshot_scale);
+				std::cout << std::format("screenshot saved to {}\n", name);
+			}
+			auto mapped = keymap.find(event.key.key);
+			if (mapped != keymap.end()) {
+				keypad.set(mapped->second, down, event_time);
+			}
+			break;
+		}
+		// the key up events go to the focused window
+		case SDL_EVENT_WINDOW_FOCUS_LOST:
+			keypad.clear();
+			break;
+		// the window contents have to be presented again
+		case SDL_EVENT_WINDOW_EXPOSED:
+		case SDL_EVENT_WINDOW_RESIZED:
+			screen.invalidate();
+			break;
+		case SDL_EVENT_QUIT:
+			continue_loop = false;
+			break;
+		}
+	};
 	while (continue_loop) {
-		keypad.clear();
-		// process SDL events
+		if (control) {
+			// keys held by the control clients
+			keypad.hold(control->getInjectedKeys());
+		}
+		// handle the input as it arrives until the next frame is due, key
+		// events reach the cpu through the keypad with the time they happened
 		SDL_Event event;
-		if (SDL_PollEvent(&event)) {
-			switch (event.type) {
-			// key pressed
-			case SDL_EVENT_KEY_DOWN:
-				// check for each mapped key if it was pressed
-				for (auto &[sdl_key, chip8_key] : keymap) {
-					if (event.key.key == sdl_key) {
-						keypad.press(chip8_key);
-					}
-				}
-				break;
-			case SDL_EVENT_QUIT:
-				continue_loop = false;
+		while (continue_loop) {
+			auto timeout =
+			    std::chrono::duration_cast<std::chrono::milliseconds>(
+			        pacer.getSleepTime(std::chrono::steady_clock::now()));
+			if (SDL_WaitEventTimeout(&event, (Sint32)timeout.count())) {
+				handle_event(event);
+			} else if (timeout.count() == 0) {
 				break;
 			}
 		}
-		// get the remaining time to draw
-		auto remaining_time =
-		    std::chrono::duration_cast<std::chrono::milliseconds>(
-		        std::chrono::steady_clock::now() - last_draw)
-		        .count();
-		// if 16.666 ms have passed, draw the screen
-		if (remaining_time >= 16) {
-			screen.update();
-			last_draw = std::chrono::steady_clock::now();
-		} else {
-			// sleep the remaining time
-			std::this_thread::sleep_for(
-			    std::chrono::milliseconds(16 - remaining_time));
+		pacer.finishWait();
+		// the cpu had at least a frame to read the taps of the last one
+		keypad.expireTaps();
+		// the grid always holds the newest frame drawn by the cpu thread
+		auto update_start = std::chrono::steady_clock::now();
+		bool presented = screen.update();
+		auto update_end = std::chrono::steady_clock::now();
+		auto frame = screen.getFrame();
+		pacer.frameDone(presented, frame.published, update_end);
+		if (stats) {
+			// unchanged frames are not presented
+			if (presented) {
+				stats->recordFrame(update_end - update_start);
+			}
+			if (pending_input) {
+				stats->recordInputLatency(update_end - *pending_input);
+			}
+			keypad.consumeReadLatencies([&](std::chrono::nanoseconds latency) {
+				stats->recordInputReadLatency(latency);
+			});
+			stats->setPacing(pacer.getPresentInterval(), pacer.getFrameAge(),
+			                 pacer.getMissedFrames());
+			stats->publish();
+		}
+		if (recorder && presented) {
+			recorder->push(frame, update_end);
 		}
+		if (framebuffer && presented) {
+			framebuffer->publish(frame, screen.getPalette(), update_end);
+		}
+		if (control) {
+			control->publishFrame(
+			    std::span(frame.rows, frame.wordsPerRow * frame.height),
+			    frame.wordsPerRow, frame.width, frame.height);
+		}
+		pending_input.reset();
 	}
+	std::cout << pacer.summary();
 }
 
 int main(int argc, char **argv) {
@@ -121,6 +309,86 @@ int main(int argc, char **argv) {
 	// rom positional parameter
 	std::filesystem::path rom_path;
 	app.add_option("rom", rom_path, "Path to the rom file");
+	std::filesystem::path pack_path;
+	app.add_option("--pack", pack_path,
+	               "Load the rom from a rom pack built with chip8pp-pack, the "
+	               "rom argument is its name or content hash (its origin and "
+	               "quirks are used, the emulator runs unpaced and ignores "
+	               "its instructions per frame)");
+	// profiler output prefix, writes <prefix>.folded and <prefix>.lst
+	std::filesystem::path profile_path;
+	app.add_option("--profile", profile_path,
+	               "Sample the rom execution and write the profile to "
+	               "<prefix>.folded and <prefix>.lst");
+	std::uint32_t profile_interval = 101;
+	app.add_option("--profile-interval", profile_interval,
+	               "Number of instructions between profiler samples");
+	// binary execution trace
+	std::filesystem::path trace_path;
+	app.add_option("--trace", trace_path,
+	               "Record an execution trace to the given file (read it with "
+	               "chip8pp-trace)");
+	std::size_t trace_depth = 1 << 20;
+	app.add_option("--trace-depth", trace_depth,
+	               "Number of most recent instructions kept in the trace file");
+	std::vector<std::string> trap_policies;
+	app.add_option("--trap-policy", trap_policies,
+	               "How to handle a trap: <trap>=<halt|skip|report>, traps are "
+	               "invalid-opcode, not-implemented, stack-overflow, "
+	               "stack-underflow, breakpoint and key-wait");
+	bool debug = false;
+	app.add_flag("--debug", debug,
+	             "Read debugger commands from the standard input (type help)");
+	std::vector<std::string> breakpoints;
+	app.add_option("--break", breakpoints,
+	               "Stop before executing the instruction at the address");
+	PresentMode present_mode = PresentMode::Streaming;
+	app.add_option("--present-mode", present_mode,
+	               "How frames are uploaded to the GPU")
+	    ->transform(CLI::CheckedTransformer(
+	        std::map<std::string, PresentMode>{
+	            {"static", PresentMode::Static},
+	            {"streaming", PresentMode::Streaming}},
+	        CLI::ignore_case));
+	std::size_t phosphor_frames = 1;
+	app.add_option("--phosphor", phosphor_frames,
+	               "Blend the last frames (up to 8) to hide sprite flicker");
+	bool mute = false;
+	app.add_flag("--mute", mute, "Do not play the sound timer beep");
+	float beep_frequency = 440.0f;
+	app.add_option("--beep-frequency", beep_frequency,
+	               "Pitch of the beep in Hz");
+	bool vsync = true;
+	app.add_flag("--vsync,!--no-vsync", vsync,
+	             "Present in sync with the display refresh (default), or on "
+	             "a 60Hz timer");
+	std::filesystem::path record_path;
+	app.add_option("--record", record_path,
+	               "Write the presented frames as a delta encoded stream to "
+	               "the file or pipe (play it with chip8pp-play)");
+	std::uint16_t keyframe_interval = 600;
+	app.add_option("--keyframe-interval", keyframe_interval,
+	               "Recorded frames between two keyframes");
+	bool export_framebuffer = false;
+	app.add_flag("--export-framebuffer", export_framebuffer,
+	             "Publish the presented frames in shared memory (watch them "
+	             "with chip8pp-play --attach)");
+	std::filesystem::path control_path;
+	app.add_option("--control", control_path,
+	               "Serve the control protocol on the given unix socket");
+	bool no_stats = false;
+	app.add_flag("--no-stats", no_stats,
+	             "Do not publish live statistics for chip8pp-top");
+#ifdef CHIP8PP_MEMORY_TRACKING
+	// memory access tracking
+	std::filesystem::path heatmap_path;
+	app.add_option("--memory-heatmap", heatmap_path,
+	               "Write the memory access counters to <prefix>.csv and "
+	               "<prefix>.ppm");
+	std::vector<std::string> watches;
+	app.add_option("--watch", watches,
+	               "Report accesses to an address or range (e.g. 0x300-0x3ff)");
+#endif
 	CLI11_PARSE(app, argc, argv);
 
 	try {
@@ -128,39 +396,215 @@ int main(int argc, char **argv) {
 			std::cout << "must provide a rom file\n";
 			return 0;
 		}
-		auto [rom, rom_size] = chip8pp::utils::load_file(rom_path);
 		Memory memory;
 		// load fontset into ram
-		// store the font in 0x50 to 0x9F
-		memory.load_rom(font, sizeof(font), 0x50);
+		// store the font in 0x50 to 0x9F and the hi-res one in 0xA0 to 0x13F
+		memory.load_rom(font, sizeof(font), Memory::FONT_OFFSET);
+		memory.load_rom(bigFont, sizeof(bigFont), Memory::BIG_FONT_OFFSET);
 		// load rom into ram
-		memory.load_rom(rom.get(), rom_size, 0x200);
+		std::optional<chip8pp::RomPack> pack;
+		std::optional<chip8pp::RomPack::Rom> packed;
+		if (!pack_path.empty()) {
+			pack.emplace(pack_path);
+			packed = pack->find(rom_path.string());
+			if (!packed) {
+				throw std::runtime_error(std::format(
+				    "{} is not in {}", rom_path.string(), pack_path.string()));
+			}
+			// copied straight from the mapped pack
+			packed->load(memory);
+		} else {
+			auto [rom, rom_size] = chip8pp::utils::load_file(rom_path);
+			memory.load_rom(rom.get(), rom_size, 0x200);
+		}
+#ifdef CHIP8PP_MEMORY_TRACKING
+		// only count accesses made by the rom
+		auto &tracker = memory.get_access_policy();
+		tracker.reset();
+		for (auto &watch : watches) {
+			auto separator = watch.find('-');
+			auto begin = (std::uint16_t)std::stoul(watch, nullptr, 0);
+			auto end = separator == std::string::npos
+			               ? begin
+			               : (std::uint16_t)std::stoul(
+			                     watch.substr(separator + 1), nullptr, 0);
+			tracker.addWatch(begin, end,
+			                 chip8pp::MemoryTracker::READ |
+			                     chip8pp::MemoryTracker::WRITE |
+			                     chip8pp::MemoryTracker::EXECUTE);
+		}
+		tracker.setWatchCallback(
+		    [](const chip8pp::MemoryTracker::WatchHit &hit) {
+			    constexpr const char *access_names[] = {"", "read", "write",
+			                                            "", "execute"};
+			    std::cerr << std::format("watch: {} {:#05x} = {:#04x}\n",
+			                             access_names[hit.access], hit.address,
+			                             (std::uint8_t)hit.value);
+		    });
+#endif
 
 		// Keypad keypad;
 		chip8pp::Keypad keypad;
 		// define the cpu
 		chip8pp::CPU cpu;
+		if (packed) {
+			// the cpu thread is not paced, cyclesPerFrame only applies to the
+			// headless sessions
+			packed->configure(cpu);
+			cpu.pc = packed->origin;
+		}
+		for (auto &setting : trap_policies) {
+			auto separator = setting.find('=');
+			auto trap = chip8pp::parseTrap(setting.substr(0, separator));
+			auto policy =
+			    separator == std::string::npos
+			        ? std::nullopt
+			        : chip8pp::parseTrapPolicy(setting.substr(separator + 1));
+			if (!trap || !policy) {
+				throw std::runtime_error(
+				    std::format("Invalid trap policy {}", setting));
+			}
+			cpu.trap_policies[static_cast<std::size_t>(*trap)] = *policy;
+		}
 
-		// define the screen 64x32
+		// define the screen 64x32, switched to 128x64 by the SUPER-CHIP
+		// instructions
 		// screen constants (Width, Height)
-		constexpr std::size_t screen_width = 64;
-		constexpr std::size_t screen_height = 32;
+		constexpr std::size_t screen_width = chip8pp::CPU::SCREEN_WIDTH;
+		constexpr std::size_t screen_height = chip8pp::CPU::SCREEN_HEIGHT;
 		constexpr std::size_t screen_scale = 10;
 		Screen screen(screen_width * screen_scale,
-		              screen_height * screen_scale);
+		              screen_height * screen_scale, present_mode);
 
-		if (!screen.init("Chip8 Emulator", screen_width, screen_height)) {
+		if (!screen.init("Chip8 Emulator", screen_width, screen_height,
+		                 chip8pp::CPU::HIRES_WIDTH,
+		                 chip8pp::CPU::HIRES_HEIGHT)) {
 			return -1;
 		}
+		screen.setPhosphor(phosphor_frames);
+		// destroyed before the screen shuts SDL down
+		std::unique_ptr<chip8pp::Beeper> beeper;
+		if (!mute) {
+			beeper = std::make_unique<chip8pp::Beeper>(cpu, beep_frequency);
+			if (!beeper->init()) {
+				// sound is optional, keep running without it
+				std::cerr << "audio disabled\n";
+				beeper.reset();
+			}
+		}
+		chip8pp::StatsCounters counters;
+		std::unique_ptr<chip8pp::StatsPublisher> stats;
+		if (!no_stats) {
+			try {
+				stats = std::make_unique<chip8pp::StatsPublisher>(counters);
+			} catch (const std::exception &e) {
+				// statistics are optional, keep running without them
+				std::cerr << std::format("stats disabled: {}\n", e.what());
+			}
+		}
+		std::unique_ptr<chip8pp::Profiler> profiler;
+		if (!profile_path.empty()) {
+			profiler = std::make_unique<chip8pp::Profiler>(profile_interval);
+		}
+		std::unique_ptr<chip8pp::TraceWriter> tracer;
+		if (!trace_path.empty()) {
+			tracer =
+			    std::make_unique<chip8pp::TraceWriter>(trace_path, trace_depth);
+		}
+		std::unique_ptr<chip8pp::FrameStreamWriter> recorder;
+		if (!record_path.empty()) {
+			recorder = std::make_unique<chip8pp::FrameStreamWriter>(
+			    record_path, keyframe_interval);
+		}
+		std::unique_ptr<chip8pp::FramebufferExport> framebuffer;
+		if (export_framebuffer) {
+			framebuffer = std::make_unique<chip8pp::FramebufferExport>();
+		}
+		std::unique_ptr<chip8pp::Debugger> debugger;
+		std::unique_ptr<chip8pp::DebugConsole> console;
+		if (debug || !breakpoints.empty() || !control_path.empty()) {
+			debugger = std::make_unique<chip8pp::Debugger>(cpu, memory);
+			for (auto &address : breakpoints) {
+				debugger->addBreakpoint(chip8pp::utils::parse_number(address));
+			}
+		}
+		if (debug) {
+			console = std::make_unique<chip8pp::DebugConsole>(*debugger, cpu,
+			                                                  memory);
+		}
+		std::unique_ptr<chip8pp::ControlServer> control;
+		if (!control_path.empty()) {
+			control = std::make_unique<chip8pp::ControlServer>(
+			    control_path, *debugger, cpu, memory, counters, stats.get());
+		}
+		std::jthread console_thread;
+		if (console) {
+			console_thread = std::jthread([&console](std::stop_token token) {
+				console->run(token);
+			});
+		}
 		// launch the cpu thread
 		std::jthread cpu_thread(cpu_thread_fn, std::ref(cpu), std::ref(memory),
-		                        std::ref(screen), std::ref(keypad));
-		// launch the timer thread
-		std::jthread timer_thread(timer_thread_fn, std::ref(cpu));
+		                        std::ref(screen), std::ref(keypad),
+		                        profiler.get(), tracer.get(),
+		                        std::ref(counters));
+		// launch the timer thread, the beeper ticks the timers itself
+		std::jthread timer_thread;
+		if (!beeper) {
+			timer_thread = std::jthread(timer_thread_fn, std::ref(cpu),
+			                            std::ref(counters));
+		}
 
 		// launch the main thread
 		main_thread_fn(std::ref(cpu), std::ref(memory), std::ref(screen),
-		               std::ref(keypad));
+		               std::ref(keypad), stats.get(), control.get(),
+		               recorder.get(), framebuffer.get(), screen_scale, vsync);
+
+		// stop the cpu before reading the collected data
+		cpu_thread.request_stop();
+		cpu_thread.join();
+		if (console_thread.joinable()) {
+			console_thread.request_stop();
+			console_thread.join();
+		}
+
+		if (recorder) {
+			// encode the queued frames before reporting
+			auto dropped = recorder->getDropped();
+			recorder.reset();
+			if (verbose || dropped) {
+				std::cout << std::format(
+				    "record: {} frames dropped while writing {}\n", dropped,
+				    record_path.string());
+			}
+		}
+		if (profiler) {
+			std::filesystem::path folded_path = profile_path;
+			folded_path += ".folded";
+			std::ofstream folded(folded_path);
+			profiler->writeFoldedStacks(folded);
+			std::filesystem::path listing_path = profile_path;
+			listing_path += ".lst";
+			std::ofstream listing(listing_path);
+			profiler->writeListing(listing, memory);
+			if (verbose) {
+				std::cout << std::format("profile: {} samples written to {}\n",
+				                         profiler->getSampleCount(),
+				                         profile_path.string());
+			}
+		}
+#ifdef CHIP8PP_MEMORY_TRACKING
+		if (!heatmap_path.empty()) {
+			std::filesystem::path csv_path = heatmap_path;
+			csv_path += ".csv";
+			std::ofstream csv(csv_path);
+			tracker.writeCsv(csv);
+			std::filesystem::path image_path = heatmap_path;
+			image_path += ".ppm";
+			std::ofstream image(image_path, std::ios::binary);
+			tracker.writeHeatmap(image);
+		}
+#endif
 
 		screen.close();
 	} catch (const std::exception &e) {
@@ -0,0 +1,77 @@
+#include <chip8pp/stats.hpp>
+#include <new>
+#include <string>
+
+namespace chip8pp {
+
+namespace {
+// how often the instructions per second are recomputed
+constexpr std::chrono::milliseconds RATE_INTERVAL{500};
+} // namespace
+
+StatsPublisher::StatsPublisher(StatsCounters const &counters)
+    : m_counters(counters),
+      m_memory(SharedMemory::create(
+          STATS_PREFIX + std::to_string(SharedMemory::processId()),
+          sizeof(StatsPage))),
+      m_page(new (m_memory.data()) StatsPage()),
+      m_lastRate(std::chrono::steady_clock::now()) {
+	m_page->pid = SharedMemory::processId();
+}
+
+void StatsPublisher::recordFrame(std::chrono::nanoseconds updateTime) {
+	m_snapshot.framesPresented++;
+	m_snapshot.screenUpdate.record(updateTime);
+}
+
+void StatsPublisher::setPacing(Histogram const &presentInterval,
+                               Histogram const &frameAge,
+                               std::uint64_t missedFrames) {
+	m_snapshot.frameTime = presentInterval;
+	m_snapshot.frameAge = frameAge;
+	m_snapshot.missedFrames = missedFrames;
+}
+
+void StatsPublisher::recordInputLatency(std::chrono::nanoseconds latency) {
+	m_snapshot.inputLatency.record(latency);
+}
+
+void StatsPublisher::recordInputReadLatency(std::chrono::nanoseconds latency) {
+	m_snapshot.inputReadLatency.record(latency);
+}
+
+void StatsPublisher::publish() {
+	auto now = std::chrono::steady_clock::now();
+	m_snapshot.timestampNs =
+	    (std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+	        now.time_since_epoch())
+	        .count();
+	m_snapshot.instructions =
+	    m_counters.instructions.load(std::memory_order_relaxed);
+	m_snapshot.schedulerOverruns =
+	    m_counters.schedulerOverruns.load(std::memory_order_relaxed);
+	auto elapsed = now - m_lastRate;
+	if (elapsed >= RATE_INTERVAL) {
+		auto ns =
+		    std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+		        .count();
+		m_snapshot.instructionsPerSecond =
+		    (m_snapshot.instructions - m_lastInstructions) * 1'000'000'000 /
+		    (std::uint64_t)ns;
+		m_lastInstructions = m_snapshot.instructions;
+		m_lastRate = now;
+	}
+
+	m_page->snapshot.write(
+	    [this](StatsSnapshot &snapshot) { snapshot = m_snapshot; });
+}
+
+StatsSnapshot const &StatsPublisher::getSnapshot() const { return m_snapshot; }
+
+StatsPage const &StatsPublisher::getPage() const { return *m_page; }
+
+bool readStatsPage(StatsPage const &page, StatsSnapshot &snapshot) {
+	return page.snapshot.read(snapshot);
+}
+
+} // namespace chip8pp
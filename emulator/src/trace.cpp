@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <chip8pp/trace.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+// check if format is available
+#if __has_include(<format>)
+#include <format>
+using std::format;
+// if not, use fmt
+#elif __has_include(<fmt/format.h>)
+#include <fmt/format.h>
+using fmt::format;
+#else
+#error "No <format> or <fmt/format.h> found"
+#endif
+
+namespace chip8pp {
+
+TraceWriter::TraceWriter(std::filesystem::path const &path, std::size_t depth)
+    : m_ring(depth) {
+	if (depth == 0) {
+		throw std::runtime_error("Trace depth must not be 0");
+	}
+	m_file.open(path, std::ios::binary | std::ios::trunc);
+	if (!m_file.is_open()) {
+		throw std::runtime_error(
+		    format("Could not open trace file {}", path.string()));
+	}
+	m_header.capacity = depth;
+	m_file.write(reinterpret_cast<const char *>(&m_header), sizeof(m_header));
+	m_file.flush();
+}
+
+TraceWriter::~TraceWriter() {
+	if (m_header.written != m_snapshot) {
+		snapshot();
+	}
+}
+
+void TraceWriter::snapshot() {
+	// the ring is in the file layout, the slots past written are still
+	// unused
+	std::uint64_t used =
+	    std::min<std::uint64_t>(m_header.written, m_header.capacity);
+	m_file.seekp(0);
+	m_file.write(reinterpret_cast<const char *>(&m_header), sizeof(m_header));
+	m_file.write(reinterpret_cast<const char *>(m_ring.data()),
+	             (std::streamsize)(used * sizeof(TraceRecord)));
+	m_file.flush();
+	m_snapshot = m_header.written;
+}
+
+std::vector<TraceRecord> readTraceFile(std::filesystem::path const &path,
+                                       TraceFileHeader &header) {
+	std::ifstream file(path, std::ios::binary);
+	if (!file.is_open()) {
+		throw std::runtime_error(
+		    format("Could not open trace file {}", path.string()));
+	}
+	file.read(reinterpret_cast<char *>(&header), sizeof(header));
+	if (!file || header.magic != TraceFileHeader::MAGIC) {
+		throw std::runtime_error(
+		    format("{} is not a trace file", path.string()));
+	}
+	if (header.version != TraceFileHeader::VERSION ||
+	    header.recordSize != sizeof(TraceRecord) || header.capacity == 0) {
+		throw std::runtime_error(
+		    format("Unsupported trace file version {}", header.version));
+	}
+	// the oldest record is the one after the last written slot
+	std::uint64_t count = std::min(header.written, header.capacity);
+	std::uint64_t first = header.written - count;
+	std::vector<TraceRecord> records(count);
+	// the ring is read in at most two contiguous chunks
+	std::uint64_t read = 0;
+	while (read < count) {
+		std::uint64_t slot = (first + read) % header.capacity;
+		std::uint64_t chunk = std::min(count - read, header.capacity - slot);
+		file.seekg(sizeof(TraceFileHeader) + slot * sizeof(TraceRecord));
+		file.read(reinterpret_cast<char *>(records.data() + read),
+		          chunk * sizeof(TraceRecord));
+		read += chunk;
+	}
+	if (!file) {
+		throw std::runtime_error(
+		    format("Trace file {} is truncated", path.string()));
+	}
+	return records;
+}
+
+} // namespace chip8pp
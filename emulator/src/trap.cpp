@@ -0,0 +1,55 @@
+#include <chip8pp/trap.hpp>
+#include <cstddef>
+
+namespace chip8pp {
+
+namespace {
+constexpr std::array<std::string_view, static_cast<std::size_t>(Trap::COUNT)>
+    trapNames{
+        "none",
+        "invalid-opcode",
+        "not-implemented",
+        "stack-overflow",
+        "stack-underflow",
+        "breakpoint",
+        "key-wait",
+        "exit",
+    };
+constexpr std::array<std::string_view, 3> policyNames{"halt", "skip",
+                                                      "report"};
+} // namespace
+
+TrapPolicies defaultTrapPolicies() {
+	TrapPolicies policies;
+	policies.fill(TrapPolicy::Halt);
+	policies[static_cast<std::size_t>(Trap::None)] = TrapPolicy::Skip;
+	policies[static_cast<std::size_t>(Trap::KeyWait)] = TrapPolicy::Skip;
+	return policies;
+}
+
+std::string_view getTrapName(Trap trap) {
+	if (trap >= Trap::COUNT) {
+		return "unknown";
+	}
+	return trapNames[static_cast<std::size_t>(trap)];
+}
+
+std::optional<Trap> parseTrap(std::string_view name) {
+	for (std::size_t i = 0; i < trapNames.size(); i++) {
+		if (trapNames[i] == name) {
+			return static_cast<Trap>(i);
+		}
+	}
+	return std::nullopt;
+}
+
+std::optional<TrapPolicy> parseTrapPolicy(std::string_view name) {
+	for (std::size_t i = 0; i < policyNames.size(); i++) {
+		if (policyNames[i] == name) {
+			return static_cast<TrapPolicy>(i);
+		}
+	}
+	return std::nullopt;
+}
+
+} // namespace chip8pp
@@ -3,6 +3,7 @@
 #include <cstddef>
 #include <fstream>
 #include <memory>
+#include <stdexcept>
 // check if format is available
 #if __has_include(<format>)
 #include <format>
@@ -18,7 +19,7 @@ using fmt::format;
 namespace chip8pp::utils {
 
 std::tuple<std::unique_ptr<std::byte[]>, std::size_t>
-load_file(const std::filesystem::path &path) {
+load_file(const std::filesystem::path &path, std::size_t max_size) {
 	// check if file exists
 	if (!std::filesystem::exists(path)) {
 		throw std::runtime_error(
@@ -40,7 +41,7 @@ load_file(const std::filesystem::path &path) {
 	auto rom_size = rom.tellg();
 	rom.seekg(0, std::ios::beg);
 	// check file size
-	if (rom_size > Memory::RAM_SIZE - Memory::ROM_START) {
+	if ((std::size_t)rom_size > max_size) {
 		throw std::runtime_error("Rom too big");
 	}
 
@@ -50,4 +51,18 @@ load_file(const std::filesystem::path &path) {
 	return {std::move(buffer), rom_size};
 }
 
+std::uint16_t parse_number(std::string const &text) {
+	std::size_t end = 0;
+	unsigned long value = 0;
+	try {
+		value = std::stoul(text, &end, 0);
+	} catch (const std::logic_error &) {
+		end = 0;
+	}
+	if (end == 0 || end != text.size() || value > 0xFFFF) {
+		throw std::invalid_argument(format("invalid number {}", text));
+	}
+	return (std::uint16_t)value;
+}
+
 } // namespace chip8pp::utils
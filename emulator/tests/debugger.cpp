@@ -0,0 +1,74 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include <chip8pp/debugger.hpp>
+#include <chip8pp/session.hpp>
+
+namespace {
+
+int failures = 0;
+
+void expect(bool condition, const char *what) {
+	if (!condition) {
+		std::fprintf(stderr, "debugger: %s\n", what);
+		failures++;
+	}
+}
+
+void wrappedJump() {
+	// 200: LD V0, 0x44
+	// 202: JP V0, 0xFFE    pc = 0x1042, fetched from 0x042
+	const std::byte rom[] = {std::byte{0x60}, std::byte{0x44},
+	                         std::byte{0xBF}, std::byte{0xFE}};
+	// 042: LD V1, 0x07
+	const std::byte code[] = {std::byte{0x61}, std::byte{0x07}};
+	chip8pp::Session session(rom);
+	session.memory.load_rom(code, sizeof(code), 0x042);
+	chip8pp::Debugger debugger(session.cpu, session.memory);
+	debugger.addBreakpoint(0x042);
+
+	session.runFrame();
+	expect(debugger.isPaused(), "breakpoint past the wrap was not hit");
+	expect(debugger.getStopReason() == "breakpoint at 0x042",
+	       "wrong stop reason past the wrap");
+	expect(session.cpu.registers[1] == std::byte{0},
+	       "the instruction at the breakpoint ran before the stop");
+}
+
+void overwrittenLowByte() {
+	// 200: LD I, 0x301
+	// 202: LD V0, 0x14
+	// 204: LD [I], V0      300: LD V0, V1 becomes ADD V0, V1
+	// 206: JP 0x300
+	const std::byte rom[] = {std::byte{0xA3}, std::byte{0x01},
+	                         std::byte{0x60}, std::byte{0x14},
+	                         std::byte{0xF0}, std::byte{0x55},
+	                         std::byte{0x13}, std::byte{0x00}};
+	const std::byte code[] = {std::byte{0x80}, std::byte{0x10}};
+	chip8pp::Session session(rom);
+	session.memory.load_rom(code, sizeof(code), 0x300);
+	chip8pp::Debugger debugger(session.cpu, session.memory);
+	debugger.addBreakpoint(0x300);
+
+	session.runFrame();
+	expect(debugger.isPaused(), "overwritten breakpoint was not hit");
+	expect(debugger.getStopReason() == "breakpoint at 0x300",
+	       "wrong stop reason after the overwrite");
+	// only the kind written under the breakpoint was added
+	auto kind = static_cast<std::size_t>(chip8pp::InstructionEnum::LD_I_NNN);
+	expect(session.cpu.dispatch[kind].load() ==
+	           chip8pp::getInstructionList()[kind],
+	       "the overwrite intercepted unrelated instructions");
+}
+
+} // namespace
+
+// runs the cpu of a headless session under the debugger, the intercepting
+// handlers stop it on the calling thread
+int main() {
+	wrappedJump();
+	overwrittenLowByte();
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,48 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <chip8pp/hash.hpp>
+
+// known answers of the reference xxHash implementation, covering the short
+// input tails and the 32 byte stripe loop
+int main() {
+	struct Vector {
+		std::string_view input;
+		std::uint64_t seed;
+		std::uint64_t expected;
+	};
+	std::vector<Vector> vectors{
+	    {"", 0, 0xEF46DB3751D8E999ULL},
+	    {"a", 0, 0xD24EC4F1A98C6E5BULL},
+	    {"abc", 0, 0x44BC2CF5AD770999ULL},
+	    {"Nobody inspects the spammish repetition", 0,
+	     0xFBCEA83C8A378BF1ULL},
+	};
+	// the bytes 0 to 99, with and without a seed
+	std::string bytes;
+	for (int i = 0; i < 100; i++) {
+		bytes.push_back((char)i);
+	}
+	vectors.push_back({bytes, 0, 0x6AC1E58032166597ULL});
+	vectors.push_back({bytes, 0x9E3779B1, 0x8832442A88284F11ULL});
+
+	int failures = 0;
+	for (auto &vector : vectors) {
+		std::uint64_t hash = chip8pp::xxh64(
+		    vector.input.data(), vector.input.size(), vector.seed);
+		if (hash != vector.expected) {
+			std::fprintf(stderr,
+			             "xxh64 of %zu bytes, seed %llx: expected %016llx, "
+			             "got %016llx\n",
+			             vector.input.size(), (unsigned long long)vector.seed,
+			             (unsigned long long)vector.expected,
+			             (unsigned long long)hash);
+			failures++;
+		}
+	}
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <CLI/App.hpp>
+#include <CLI/CLI.hpp>
+
+#include <chip8pp/analyzer.hpp>
+#include <chip8pp/disassembler.hpp>
+#include <chip8pp/utils.hpp>
+
+namespace {
+
+void printList(std::ostream &out, std::string_view name,
+               std::vector<std::uint16_t> const &addresses) {
+	if (addresses.empty()) {
+		return;
+	}
+	std::string line;
+	for (auto address : addresses) {
+		line += std::format(" {:03x}", address);
+	}
+	out << std::format("; {}:{}\n", name, line);
+}
+
+// disassembly of the code regions and hex dump of the others
+void writeListing(std::ostream &out, chip8pp::Analysis const &analysis,
+                  std::span<const std::byte> rom) {
+	out << std::format("; {} bytes at {:03x}, {} blocks, {} subroutines, "
+	                   "{}\n",
+	                   analysis.size, analysis.origin, analysis.blocks.size(),
+	                   analysis.callTargets.size(),
+	                   analysis.isStatic() ? "static"
+	                                       : "not statically translatable");
+	printList(out, "computed jumps", analysis.computedJumps);
+	printList(out, "self modifying stores", analysis.selfModifyingStores);
+	printList(out, "stores with an unknown index", analysis.unknownStores);
+	printList(out, "invalid instructions", analysis.invalidInstructions);
+	printList(out, "targets outside of the rom", analysis.externalTargets);
+	// blocks entered at each address
+	std::map<std::uint16_t, chip8pp::Analysis::Block const *> blocks;
+	for (auto &block : analysis.blocks) {
+		blocks[block.start] = &block;
+	}
+	for (auto &region : analysis.regions) {
+		out << std::format("\n; {:03x}-{:03x} {}\n", region.start,
+		                   region.end - 1,
+		                   chip8pp::getRegionKindName(region.kind));
+		if (region.kind != chip8pp::Analysis::RegionKind::Code) {
+			for (std::uint16_t line = region.start; line < region.end;
+			     line += 8) {
+				std::string bytes;
+				for (std::uint16_t address = line;
+				     address < region.end && address < line + 8; address++) {
+					bytes += std::format(
+					    " {:02x}", (unsigned)rom[address - analysis.origin]);
+				}
+				out << std::format("{:03x}:{}\n", line, bytes);
+			}
+			continue;
+		}
+		for (auto it = blocks.lower_bound(region.start);
+		     it != blocks.end() && it->first < region.end; it++) {
+			auto &block = *it->second;
+			out << std::format("{}b{:03x}:\n",
+			                   std::binary_search(analysis.callTargets.begin(),
+			                                      analysis.callTargets.end(),
+			                                      block.start)
+			                       ? "; subroutine\n"
+			                       : "",
+			                   block.start);
+			std::uint16_t pc = block.start;
+			for (auto &instruction : block.instructions) {
+				out << std::format("{:03x}:  {:04x}  {}\n", pc,
+				                   instruction.opcode,
+				                   chip8pp::disassemble(instruction));
+				pc += 2;
+			}
+		}
+	}
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	CLI::App app{"Recover the control flow graph of a Chip8 rom",
+	             "chip8pp-analyze"};
+	std::filesystem::path rom_path;
+	app.add_option("rom", rom_path, "Path to the rom")->required();
+	std::string output_format = "text";
+	app.add_option("-f,--format", output_format, "Output format")
+	    ->check(CLI::IsMember({"text", "json", "dot"}));
+	std::filesystem::path output_path;
+	app.add_option("-o,--output", output_path,
+	               "Write to this file instead of the standard output");
+	bool modify_index = false;
+	app.add_flag("--modify-index", modify_index,
+	             "FX55 and FX65 increment the index register, as the "
+	             "ModifyIndexloadStore quirk");
+	CLI11_PARSE(app, argc, argv);
+
+	try {
+		auto [rom, size] = chip8pp::utils::load_file(rom_path);
+		std::span<const std::byte> bytes(rom.get(), size);
+		auto analysis =
+		    chip8pp::analyze(bytes, Memory::ROM_OFFSET, modify_index);
+		std::ofstream file;
+		if (!output_path.empty()) {
+			file.open(output_path);
+			if (!file.is_open()) {
+				throw std::runtime_error(std::format(
+				    "Could not open {}", output_path.string()));
+			}
+		}
+		std::ostream &out = output_path.empty() ? std::cout : file;
+		if (output_format == "json") {
+			chip8pp::writeJson(out, analysis);
+		} else if (output_format == "dot") {
+			chip8pp::writeDot(out, analysis);
+		} else {
+			writeListing(out, analysis, bytes);
+		}
+	} catch (const std::exception &e) {
+		std::cerr << std::format("{}\n", e.what());
+		return 1;
+	}
+}
@@ -0,0 +1,288 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <CLI/App.hpp>
+#include <CLI/CLI.hpp>
+
+#include <libcanvas/scaler.hpp>
+
+#include <chip8pp/romPack.hpp>
+#include <chip8pp/session.hpp>
+#include <chip8pp/trap.hpp>
+#include <chip8pp/utils.hpp>
+
+namespace {
+
+struct Options {
+	std::filesystem::path dumpDir{"."};
+	std::uint32_t seed{0};
+	std::size_t cyclesPerFrame{chip8pp::Session::DEFAULT_CYCLES_PER_FRAME};
+	bool update{false};
+	bool verbose{false};
+	// run the roms in the 64 KiB XO-CHIP address space
+	bool xoChip{false};
+	// the manifest roms are names or hashes in this pack when set
+	const chip8pp::RomPack *pack{nullptr};
+};
+
+struct Checkpoint {
+	std::uint64_t frame;
+	std::uint64_t hash;
+};
+
+// every checkpoint of a rom and input movie pair, run in a single session
+struct Job {
+	// as written in the manifest, paths are relative to the manifest
+	std::string romText;
+	std::string movieText;
+	std::filesystem::path rom;
+	std::optional<std::filesystem::path> movie;
+	std::vector<Checkpoint> checkpoints;
+	// filled by runJob
+	std::vector<std::string> report;
+	std::size_t failures{0};
+};
+
+// manifest lines are "<rom> <movie|-> <frame> <hash>", empty lines and lines
+// starting with '#' are ignored
+void parseManifest(std::filesystem::path const &path, std::vector<Job> &jobs) {
+	std::ifstream file(path);
+	if (!file.is_open()) {
+		throw std::runtime_error(
+		    std::format("Could not open manifest {}", path.string()));
+	}
+	auto base = path.parent_path();
+	std::size_t first = jobs.size();
+	std::string line;
+	for (std::size_t number = 1; std::getline(file, line); number++) {
+		std::istringstream fields(line);
+		std::string rom;
+		std::string movie;
+		std::string frame;
+		std::string hash;
+		if (!(fields >> rom) || rom.starts_with('#')) {
+			continue;
+		}
+		Checkpoint checkpoint;
+		try {
+			if (!(fields >> movie >> frame >> hash)) {
+				throw std::invalid_argument("missing field");
+			}
+			checkpoint = {std::stoull(frame), std::stoull(hash, nullptr, 16)};
+		} catch (const std::exception &) {
+			throw std::runtime_error(
+			    std::format("{}:{}: expected <rom> <movie|-> <frame> <hash>",
+			                path.string(), number));
+		}
+		// group the checkpoints of the same run
+		auto job = std::find_if(
+		    jobs.begin() + first, jobs.end(), [&](Job const &job) {
+			    return job.romText == rom && job.movieText == movie;
+		    });
+		if (job == jobs.end()) {
+			Job &added = jobs.emplace_back();
+			added.romText = rom;
+			added.movieText = movie;
+			added.rom = base / rom;
+			if (movie != "-") {
+				added.movie = base / movie;
+			}
+			job = jobs.end() - 1;
+		}
+		job->checkpoints.push_back(checkpoint);
+	}
+}
+
+void dumpFrame(std::filesystem::path const &path, Grid::FrameView frame) {
+	constexpr std::size_t scale = 8;
+	Scaler scaler;
+	scaler.push(frame);
+	std::size_t width = frame.width * scale;
+	std::size_t height = frame.height * scale;
+	std::vector<pixelRGBA_t> pixels(width * height);
+	scaler.scaleRows(0, frame.height, scale,
+	                 reinterpret_cast<std::uint8_t *>(pixels.data()),
+	                 width * sizeof(pixelRGBA_t));
+	std::ofstream out(path, std::ios::binary);
+	Scaler::writePpm(out, pixels.data(), width, height);
+}
+
+template <typename SessionT>
+void runCheckpoints(Job &job, Options const &options,
+                    std::span<const std::byte> rom,
+                    std::optional<chip8pp::RomPack::Rom> const &packed) {
+	// packed roms are loaded at their own origin
+	SessionT session(packed ? std::span<const std::byte>() : rom, options.seed,
+	                 packed && packed->cyclesPerFrame ? packed->cyclesPerFrame
+	                                                  : options.cyclesPerFrame);
+	if (packed) {
+		packed->load(session.memory);
+		packed->configure(session.cpu);
+		session.cpu.pc = packed->origin;
+	}
+	chip8pp::InputMovie movie;
+	if (job.movie) {
+		movie = chip8pp::InputMovie::load(*job.movie);
+	}
+	std::stable_sort(
+	    job.checkpoints.begin(), job.checkpoints.end(),
+	    [](auto &left, auto &right) { return left.frame < right.frame; });
+	for (auto &checkpoint : job.checkpoints) {
+		while (session.frame < checkpoint.frame) {
+			session.setKeys(movie.keysAt(session.frame));
+			session.runFrame();
+		}
+		std::uint64_t hash = session.frameHash();
+		std::string name = std::format("{} {} {}", job.romText,
+		                               job.movieText, checkpoint.frame);
+		if (options.update) {
+			job.report.push_back(std::format("{} {:016x}", name, hash));
+			continue;
+		}
+		if (hash == checkpoint.hash) {
+			if (options.verbose) {
+				job.report.push_back(std::format("PASS {}", name));
+			}
+			continue;
+		}
+		job.failures++;
+		std::string stem = job.rom.stem().string();
+		if (job.movie) {
+			stem += "-" + job.movie->stem().string();
+		}
+		auto dump = options.dumpDir /
+		            std::format("{}-{}.ppm", stem, checkpoint.frame);
+		dumpFrame(dump, session.getFrame());
+		job.report.push_back(std::format(
+		    "FAIL {}: expected {:016x}, got {:016x}{} (frame in {})", name,
+		    checkpoint.hash, hash,
+		    session.halted ? std::format(", cpu halted by {}",
+		                                 chip8pp::getTrapName(*session.halted))
+		                   : "",
+		    dump.string()));
+	}
+}
+
+void runJob(Job &job, Options const &options) {
+	std::unique_ptr<std::byte[]> file;
+	std::span<const std::byte> rom;
+	std::optional<chip8pp::RomPack::Rom> packed;
+	if (options.pack) {
+		packed = options.pack->find(job.romText);
+		if (!packed) {
+			throw std::runtime_error("not in the rom pack");
+		}
+		rom = packed->data;
+	} else {
+		auto [data, size] = chip8pp::utils::load_file(
+		    job.rom, options.xoChip
+		                 ? XoChipMemory::RAM_SIZE - XoChipMemory::ROM_START
+		                 : Memory::RAM_SIZE - Memory::ROM_START);
+		file = std::move(data);
+		rom = std::span(file.get(), size);
+	}
+	if (options.xoChip) {
+		runCheckpoints<chip8pp::XoChipSession>(job, options, rom, packed);
+	} else {
+		runCheckpoints<chip8pp::Session>(job, options, rom, packed);
+	}
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	CLI::App app{"Check the framebuffer hashes of roms against golden "
+	             "manifests",
+	             "chip8pp-golden"};
+	std::vector<std::filesystem::path> manifests;
+	app.add_option("manifest", manifests,
+	               "Manifest files, one '<rom> <movie|-> <frame> <hash>' "
+	               "checkpoint per line")
+	    ->required();
+	std::size_t jobs = std::max(1u, std::thread::hardware_concurrency());
+	app.add_option("-j,--jobs", jobs, "Sessions run in parallel");
+	Options options;
+	app.add_option("--dump-dir", options.dumpDir,
+	               "Where the PPM images of mismatching frames are written");
+	app.add_option("--seed", options.seed, "Seed of the RND instruction");
+	app.add_option("--cycles-per-frame", options.cyclesPerFrame,
+	               "Instructions executed between two timer ticks");
+	std::filesystem::path pack_path;
+	app.add_option("--pack", pack_path,
+	               "Take the roms from a rom pack, the manifest names them by "
+	               "name or content hash");
+	app.add_flag("--update", options.update,
+	             "Print the manifest lines with the current hashes instead of "
+	             "checking them");
+	app.add_flag("-v,--verbose", options.verbose,
+	             "Also report the matching checkpoints");
+	app.add_flag("--xo-chip", options.xoChip,
+	             "Run the roms with the 64 KiB XO-CHIP address space");
+	CLI11_PARSE(app, argc, argv);
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<Job> all;
+	std::optional<chip8pp::RomPack> pack;
+	try {
+		if (!pack_path.empty()) {
+			pack.emplace(pack_path);
+			options.pack = &*pack;
+		}
+		for (auto &manifest : manifests) {
+			parseManifest(manifest, all);
+		}
+	} catch (const std::exception &e) {
+		std::cerr << std::format("{}\n", e.what());
+		return 1;
+	}
+
+	// every worker takes the next job until none is left
+	std::atomic<std::size_t> next{0};
+	{
+		std::vector<std::jthread> workers;
+		for (std::size_t i = 0; i < std::min(jobs, all.size()); i++) {
+			workers.emplace_back([&] {
+				for (std::size_t j = next++; j < all.size(); j = next++) {
+					try {
+						runJob(all[j], options);
+					} catch (const std::exception &e) {
+						all[j].failures++;
+						all[j].report.push_back(std::format(
+						    "FAIL {}: {}", all[j].romText, e.what()));
+					}
+				}
+			});
+		}
+	}
+
+	std::size_t checkpoints = 0;
+	std::size_t failures = 0;
+	for (auto &job : all) {
+		for (auto &line : job.report) {
+			std::cout << line << '\n';
+		}
+		checkpoints += job.checkpoints.size();
+		failures += job.failures;
+	}
+	if (!options.update) {
+		auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+		    std::chrono::steady_clock::now() - start);
+		std::cout << std::format(
+		    "{} checkpoints in {} runs, {} failed, {} ms\n", checkpoints,
+		    all.size(), failures, elapsed.count());
+	}
+	return failures == 0 ? 0 : 1;
+}
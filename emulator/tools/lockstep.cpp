@@ -0,0 +1,385 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <CLI/App.hpp>
+#include <CLI/CLI.hpp>
+
+#include <chip8pp/disassembler.hpp>
+#include <chip8pp/predecodedCore.hpp>
+#include <chip8pp/session.hpp>
+#include <chip8pp/trap.hpp>
+#include <chip8pp/utils.hpp>
+
+namespace {
+
+struct Options {
+	std::uint32_t seed{0};
+	std::size_t cyclesPerFrame{chip8pp::Session::DEFAULT_CYCLES_PER_FRAME};
+	std::uint64_t frames{3600};
+	// instructions between two state comparisons
+	std::uint64_t interval{64};
+	std::size_t traceLength{16};
+	// random opcode streams, continue after every trap and press random keys
+	bool fuzz{false};
+	chip8pp::InputMovie movie;
+};
+
+// one instruction of both backends
+struct TraceEntry {
+	std::uint64_t count;
+	std::uint64_t frame;
+	std::uint16_t pc;
+	std::uint16_t opcode;
+	chip8pp::Trap reference;
+	std::uint16_t candidatePc;
+	std::uint16_t candidateOpcode;
+	chip8pp::Trap candidate;
+};
+
+struct Divergence {
+	// instructions run by each backend when the states were compared
+	std::uint64_t count;
+	std::vector<std::string> diff;
+	std::vector<TraceEntry> trace;
+};
+
+// the getInstructionList() interpreter, as BasicSession::runFrame runs it
+template <typename MemoryT>
+chip8pp::Trap referenceStep(chip8pp::BasicSession<MemoryT> &session) {
+	auto &cpu = session.cpu;
+	std::uint16_t opcode = cpu.fetch(session.memory);
+	return cpu.execute(cpu.decode(opcode), session.memory, session.screen,
+	                   session.keypad);
+}
+
+// reads memory without going through the access policy
+template <typename MemoryT>
+std::uint16_t peekOpcode(MemoryT &memory, std::uint16_t address) {
+	auto *bytes = memory.get_memory();
+	return (std::uint16_t)((unsigned)bytes[address & MemoryT::ADDRESS_MASK]
+	                           << 8 |
+	                       (unsigned)bytes[(address + 1) &
+	                                       MemoryT::ADDRESS_MASK]);
+}
+
+std::string trapText(std::optional<chip8pp::Trap> trap) {
+	return trap ? std::string(chip8pp::getTrapName(*trap)) : "-";
+}
+
+// every field that differs, as "<field> <reference> <candidate>"
+template <typename MemoryT>
+std::vector<std::string> compare(chip8pp::BasicSession<MemoryT> &reference,
+                                 chip8pp::BasicSession<MemoryT> &candidate) {
+	std::vector<std::string> diff;
+	auto field = [&](std::string name, auto left, auto right) {
+		if (left != right) {
+			diff.push_back(std::format("{:<12} {:>10} {:>10}", name,
+			                           std::format("{:x}", left),
+			                           std::format("{:x}", right)));
+		}
+	};
+	auto &left = reference.cpu;
+	auto &right = candidate.cpu;
+	field("pc", left.pc, right.pc);
+	field("index", left.index, right.index);
+	field("sp", left.sp, right.sp);
+	for (std::size_t i = 0; i < left.stack.size(); i++) {
+		if (i < std::max(left.sp, right.sp)) {
+			field(std::format("stack[{}]", i), left.stack[i], right.stack[i]);
+		}
+	}
+	for (std::size_t i = 0; i < left.registers.size(); i++) {
+		field(std::format("V{:X}", i), (unsigned)left.registers[i],
+		      (unsigned)right.registers[i]);
+	}
+	for (std::size_t i = 0; i < left.rpl_flags.size(); i++) {
+		field(std::format("rpl[{}]", i), (unsigned)left.rpl_flags[i],
+		      (unsigned)right.rpl_flags[i]);
+	}
+	field("delay", (unsigned)left.getDelayTimer(),
+	      (unsigned)right.getDelayTimer());
+	field("sound", (unsigned)left.getSoundTimer(),
+	      (unsigned)right.getSoundTimer());
+	if (left.trap != right.trap) {
+		diff.push_back(std::format("{:<12} {:>10} {:>10}", "trap",
+		                           chip8pp::getTrapName(left.trap),
+		                           chip8pp::getTrapName(right.trap)));
+	}
+	field("trap pc", left.trap_pc, right.trap_pc);
+	field("trap opcode", left.trap_opcode, right.trap_opcode);
+	if (reference.halted != candidate.halted) {
+		diff.push_back(std::format("{:<12} {:>10} {:>10}", "halted",
+		                           trapText(reference.halted),
+		                           trapText(candidate.halted)));
+	}
+	if (left.rng != right.rng) {
+		diff.push_back("rng state");
+	}
+	// the first bytes that differ
+	auto *leftBytes = reference.memory.get_memory();
+	auto *rightBytes = candidate.memory.get_memory();
+	std::size_t bytes = 0;
+	for (std::size_t address = 0; address < MemoryT::RAM_SIZE; address++) {
+		if (leftBytes[address] != rightBytes[address] && bytes++ < 8) {
+			field(std::format("[{:04x}]", address),
+			      (unsigned)leftBytes[address], (unsigned)rightBytes[address]);
+		}
+	}
+	if (bytes > 8) {
+		diff.push_back(std::format("{} more bytes", bytes - 8));
+	}
+	auto leftFrame = reference.getFrame();
+	auto rightFrame = candidate.getFrame();
+	if (leftFrame.width != rightFrame.width ||
+	    leftFrame.height != rightFrame.height) {
+		diff.push_back(std::format(
+		    "{:<12} {:>10} {:>10}", "resolution",
+		    std::format("{}x{}", leftFrame.width, leftFrame.height),
+		    std::format("{}x{}", rightFrame.width, rightFrame.height)));
+		return diff;
+	}
+	std::string rows;
+	for (std::size_t row = 0; row < leftFrame.height; row++) {
+		auto *leftRow = leftFrame.rows + row * leftFrame.wordsPerRow;
+		auto *rightRow = rightFrame.rows + row * rightFrame.wordsPerRow;
+		if (!std::equal(leftRow, leftRow + leftFrame.wordsPerRow, rightRow)) {
+			rows += std::format(" {}", row);
+		}
+	}
+	if (!rows.empty()) {
+		diff.push_back(std::format("frame rows  {}", rows));
+	}
+	return diff;
+}
+
+// run the reference interpreter and the predecoded core on their own
+// sessions with the same input, until the states differ after
+// options.interval instructions, or `limit` instructions ran
+template <typename MemoryT>
+std::optional<Divergence> run(std::span<const std::byte> rom,
+                              Options const &options, std::uint64_t interval,
+                              std::uint64_t limit, std::uint64_t &executed) {
+	using SessionT = chip8pp::BasicSession<MemoryT>;
+	SessionT reference(rom, options.seed, options.cyclesPerFrame);
+	SessionT candidate(rom, options.seed, options.cyclesPerFrame);
+	chip8pp::BasicPredecodedCore<MemoryT> core;
+	std::mt19937 keys(options.seed);
+	if (options.fuzz) {
+		chip8pp::TrapPolicies policies;
+		policies.fill(chip8pp::TrapPolicy::Skip);
+		reference.cpu.trap_policies = policies;
+		candidate.cpu.trap_policies = policies;
+	}
+	std::vector<TraceEntry> trace;
+	auto divergence = [&](std::uint64_t count)
+	    -> std::optional<Divergence> {
+		auto diff = compare(reference, candidate);
+		if (diff.empty()) {
+			return std::nullopt;
+		}
+		// oldest entry first
+		std::size_t next = count % std::max<std::size_t>(trace.size(), 1);
+		std::rotate(trace.begin(), trace.begin() + next, trace.end());
+		return Divergence{count, std::move(diff), std::move(trace)};
+	};
+	auto halts = [](SessionT &session, chip8pp::Trap trap) {
+		if (trap != chip8pp::Trap::None &&
+		    session.cpu.getTrapPolicy(trap) == chip8pp::TrapPolicy::Halt) {
+			session.halted = trap;
+		}
+	};
+
+	executed = 0;
+	for (std::uint64_t frame = 0; frame < options.frames; frame++) {
+		std::uint16_t mask = options.fuzz ? (std::uint16_t)keys()
+		                                  : options.movie.keysAt(frame);
+		reference.setKeys(mask);
+		candidate.setKeys(mask);
+		for (std::size_t cycle = 0; cycle < options.cyclesPerFrame; cycle++) {
+			if (executed == limit) {
+				return divergence(executed);
+			}
+			if (reference.halted && candidate.halted) {
+				break;
+			}
+			TraceEntry entry{executed,
+			                 frame,
+			                 reference.cpu.pc,
+			                 peekOpcode(reference.memory, reference.cpu.pc),
+			                 chip8pp::Trap::None,
+			                 candidate.cpu.pc,
+			                 peekOpcode(candidate.memory, candidate.cpu.pc),
+			                 chip8pp::Trap::None};
+			if (!reference.halted) {
+				entry.reference = referenceStep(reference);
+				halts(reference, entry.reference);
+			}
+			if (!candidate.halted) {
+				entry.candidate = core.step(candidate);
+				halts(candidate, entry.candidate);
+			}
+			if (trace.size() < options.traceLength) {
+				trace.push_back(entry);
+			} else if (!trace.empty()) {
+				trace[executed % trace.size()] = entry;
+			}
+			executed++;
+			if (executed % interval == 0) {
+				if (auto found = divergence(executed)) {
+					return found;
+				}
+			}
+		}
+		reference.cpu.timerTick();
+		candidate.cpu.timerTick();
+		reference.frame++;
+		candidate.frame++;
+		if (reference.halted && candidate.halted) {
+			break;
+		}
+	}
+	return divergence(executed);
+}
+
+void printDivergence(Divergence const &divergence) {
+	std::cout << std::format("backends diverged after {} instructions\n",
+	                         divergence.count);
+	std::cout << std::format("{:<12} {:>10} {:>10}\n", "", "reference",
+	                         "predecoded");
+	for (auto &line : divergence.diff) {
+		std::cout << line << '\n';
+	}
+	std::cout << "recent instructions:\n";
+	for (auto &entry : divergence.trace) {
+		std::string candidate;
+		if (entry.candidatePc != entry.pc ||
+		    entry.candidateOpcode != entry.opcode ||
+		    entry.candidate != entry.reference) {
+			candidate = std::format("  predecoded {:03x} {:04x} {}",
+			                        entry.candidatePc, entry.candidateOpcode,
+			                        chip8pp::getTrapName(entry.candidate));
+		}
+		std::cout << std::format(
+		    "{:>10} {:>6} {:03x} {:04x} {:<20} {}{}\n", entry.count,
+		    entry.frame, entry.pc, entry.opcode,
+		    chip8pp::disassemble(chip8pp::CPU::decode(entry.opcode)),
+		    chip8pp::getTrapName(entry.reference), candidate);
+	}
+}
+
+// false when the backends diverged, a mismatch found between two comparisons
+// is run again comparing after every instruction to report the first one
+template <typename MemoryT>
+bool check(std::span<const std::byte> rom, Options const &options,
+           std::uint64_t &total) {
+	std::uint64_t executed = 0;
+	auto divergence =
+	    run<MemoryT>(rom, options, options.interval, UINT64_MAX, executed);
+	total += executed;
+	if (!divergence) {
+		return true;
+	}
+	if (options.interval > 1) {
+		std::uint64_t ignored = 0;
+		if (auto first =
+		        run<MemoryT>(rom, options, 1, divergence->count, ignored)) {
+			divergence = std::move(first);
+		}
+	}
+	printDivergence(*divergence);
+	return false;
+}
+
+template <typename MemoryT> int fuzz(Options options, std::size_t runs) {
+	std::uint64_t total = 0;
+	std::vector<std::byte> rom(MemoryT::RAM_SIZE - MemoryT::ROM_START);
+	for (std::size_t i = 0; i < runs; i++) {
+		std::mt19937 random(options.seed);
+		for (auto &byte : rom) {
+			byte = (std::byte)random();
+		}
+		if (!check<MemoryT>(rom, options, total)) {
+			std::cout << std::format("fuzz run with seed {}, rerun it with "
+			                         "--fuzz 1 --seed {}\n",
+			                         options.seed, options.seed);
+			return 1;
+		}
+		options.seed++;
+	}
+	std::cout << std::format("{} runs, {} instructions, no divergence\n",
+	                         runs, total);
+	return 0;
+}
+
+template <typename MemoryT>
+int replay(std::filesystem::path const &path, Options const &options) {
+	auto [data, size] = chip8pp::utils::load_file(
+	    path, MemoryT::RAM_SIZE - MemoryT::ROM_START);
+	std::uint64_t total = 0;
+	if (!check<MemoryT>(std::span(data.get(), size), options, total)) {
+		return 1;
+	}
+	std::cout << std::format("{} instructions, no divergence\n", total);
+	return 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	CLI::App app{"Run the reference interpreter and the predecoded core in "
+	             "lockstep and report the first state divergence",
+	             "chip8pp-lockstep"};
+	std::filesystem::path rom_path;
+	app.add_option("rom", rom_path, "Path to the rom");
+	Options options;
+	std::filesystem::path movie_path;
+	app.add_option("--movie", movie_path,
+	               "Input movie, '<frame> <key mask>' per line");
+	app.add_option("--seed", options.seed,
+	               "Seed of the RND instruction and of the fuzzer");
+	app.add_option("--cycles-per-frame", options.cyclesPerFrame,
+	               "Instructions executed between two timer ticks");
+	app.add_option("--frames", options.frames, "Frames to run");
+	app.add_option("-k,--interval", options.interval,
+	               "Instructions between two state comparisons")
+	    ->check(CLI::PositiveNumber);
+	app.add_option("--trace", options.traceLength,
+	               "Instructions printed before a divergence");
+	std::size_t fuzz_runs = 0;
+	app.add_option("--fuzz", fuzz_runs,
+	               "Run this many random opcode streams instead of a rom, "
+	               "with random keys and no halting trap");
+	bool xo_chip = false;
+	app.add_flag("--xo-chip", xo_chip,
+	             "Use the 64 KiB XO-CHIP address space");
+	CLI11_PARSE(app, argc, argv);
+
+	try {
+		if (fuzz_runs > 0) {
+			options.fuzz = true;
+			return xo_chip ? fuzz<XoChipMemory>(options, fuzz_runs)
+			               : fuzz<Memory>(options, fuzz_runs);
+		}
+		if (rom_path.empty()) {
+			std::cout << "must provide a rom or --fuzz\n";
+			return 1;
+		}
+		if (!movie_path.empty()) {
+			options.movie = chip8pp::InputMovie::load(movie_path);
+		}
+		return xo_chip ? replay<XoChipMemory>(rom_path, options)
+		               : replay<Memory>(rom_path, options);
+	} catch (const std::exception &e) {
+		std::cerr << std::format("{}\n", e.what());
+		return 1;
+	}
+}
@@ -0,0 +1,154 @@
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <CLI/App.hpp>
+#include <CLI/CLI.hpp>
+
+#include <chip8pp/cpu.hpp>
+#include <chip8pp/romPack.hpp>
+#include <chip8pp/utils.hpp>
+
+namespace {
+
+// comma separated quirk names, "-" for none
+std::uint16_t parseQuirks(std::string const &text) {
+	std::uint16_t mask = 0;
+	std::istringstream names(text == "-" ? "" : text);
+	std::string name;
+	while (std::getline(names, name, ',')) {
+		auto quirk = chip8pp::CPU::parseQuirk(name);
+		if (!quirk) {
+			throw std::runtime_error(std::format("Unknown quirk {}", name));
+		}
+		mask |= (std::uint16_t)(1u << static_cast<unsigned>(*quirk));
+	}
+	return mask;
+}
+
+void addRom(chip8pp::RomPackBuilder &builder,
+            std::filesystem::path const &path, std::uint16_t quirks,
+            std::uint16_t cyclesPerFrame) {
+	auto [rom, size] = chip8pp::utils::load_file(path);
+	builder.add(path.filename().string(), std::span(rom.get(), size), quirks,
+	            cyclesPerFrame);
+}
+
+// list lines are "<rom> [<cycles-per-frame>|-] [<quirk>,...|-]", empty lines
+// and lines starting with '#' are ignored
+void addList(chip8pp::RomPackBuilder &builder,
+             std::filesystem::path const &path) {
+	std::ifstream file(path);
+	if (!file.is_open()) {
+		throw std::runtime_error(
+		    std::format("Could not open rom list {}", path.string()));
+	}
+	std::string line;
+	for (std::size_t number = 1; std::getline(file, line); number++) {
+		std::istringstream fields(line);
+		std::string rom;
+		std::string cycles = "-";
+		std::string quirks = "-";
+		if (!(fields >> rom) || rom.starts_with('#')) {
+			continue;
+		}
+		fields >> cycles >> quirks;
+		std::uint16_t cyclesPerFrame = 0;
+		try {
+			if (cycles != "-") {
+				cyclesPerFrame = chip8pp::utils::parse_number(cycles);
+			}
+		} catch (const std::exception &) {
+			throw std::runtime_error(
+			    std::format("{}:{}: invalid instructions per frame {}",
+			                path.string(), number, cycles));
+		}
+		addRom(builder, path.parent_path() / rom, parseQuirks(quirks),
+		       cyclesPerFrame);
+	}
+}
+
+void printPack(std::filesystem::path const &path) {
+	chip8pp::RomPack pack(path);
+	for (std::size_t i = 0; i < pack.size(); i++) {
+		auto rom = pack.at(i);
+		std::string quirks;
+		for (std::size_t quirk = 0;
+		     quirk < static_cast<std::size_t>(chip8pp::CPU::Quirk::COUNT);
+		     quirk++) {
+			if (rom.quirks & (1u << quirk)) {
+				quirks += std::format(
+				    "{}{}", quirks.empty() ? "" : ",",
+				    chip8pp::CPU::getQuirkName(
+				        static_cast<chip8pp::CPU::Quirk>(quirk)));
+			}
+		}
+		std::cout << std::format(
+		    "{:016x} {:>5} bytes at {:03x}, {} instructions/frame, quirks "
+		    "{}  {}\n",
+		    rom.hash, rom.data.size(), rom.origin,
+		    rom.cyclesPerFrame ? std::to_string(rom.cyclesPerFrame)
+		                       : std::string("default"),
+		    quirks.empty() ? "-" : quirks, rom.name);
+	}
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	CLI::App app{"Build a rom pack, loaded by the emulator with --pack",
+	             "chip8pp-pack"};
+	std::vector<std::filesystem::path> rom_paths;
+	app.add_option("roms", rom_paths, "Roms to add, named by their file name");
+	std::filesystem::path output_path;
+	app.add_option("-o,--output", output_path, "Rom pack to write");
+	std::vector<std::filesystem::path> lists;
+	app.add_option("-l,--list", lists,
+	               "Also add the roms of a list file, one '<rom> "
+	               "[<instructions per frame>|-] [<quirk>,...|-]' per line");
+	std::uint16_t cycles_per_frame = 0;
+	app.add_option("--cycles-per-frame", cycles_per_frame,
+	               "Instructions per frame of the roms given as arguments "
+	               "(default: no preference)");
+	std::vector<std::string> quirks;
+	app.add_option("--quirk", quirks,
+	               "Quirk enabled for the roms given as arguments "
+	               "(modify-index)");
+	std::filesystem::path info_path;
+	app.add_option("--info", info_path, "List the roms of a rom pack");
+	CLI11_PARSE(app, argc, argv);
+
+	try {
+		if (!info_path.empty()) {
+			printPack(info_path);
+			return 0;
+		}
+		if (output_path.empty()) {
+			std::cout << "must provide an output rom pack\n";
+			return 1;
+		}
+		std::uint16_t quirk_mask = 0;
+		for (auto &quirk : quirks) {
+			quirk_mask |= parseQuirks(quirk);
+		}
+		chip8pp::RomPackBuilder builder;
+		for (auto &path : rom_paths) {
+			addRom(builder, path, quirk_mask, cycles_per_frame);
+		}
+		for (auto &list : lists) {
+			addList(builder, list);
+		}
+		builder.write(output_path);
+		std::cout << std::format("{} roms written to {}\n", builder.size(),
+		                         output_path.string());
+	} catch (const std::exception &e) {
+		std::cerr << std::format("{}\n", e.what());
+		return 1;
+	}
+}
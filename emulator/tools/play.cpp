@@ -0,0 +1,213 @@
+#define SDL_MAIN_HANDLED
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <SDL3/SDL.h>
+
+#include <CLI/App.hpp>
+#include <CLI/CLI.hpp>
+
+#include <libcanvas/screen.hpp>
+
+#include <chip8pp/frameStream.hpp>
+#include <chip8pp/framebufferExport.hpp>
+#include <chip8pp/sharedMemory.hpp>
+
+namespace {
+
+void printFrame(chip8pp::FrameStreamReader::Frame const &frame,
+                std::uint64_t index) {
+	std::cout << std::format("frame {} at {:.3f}s{}\n", index,
+	                         (double)frame.timeNs / 1e9,
+	                         frame.keyframe ? " (keyframe)" : "");
+	for (std::size_t y = 0; y < frame.height; y++) {
+		std::string line;
+		for (std::size_t x = 0; x < frame.width; x++) {
+			std::uint64_t word = frame.rows[y * frame.wordsPerRow + x / 64];
+			line += (word >> (63 - x % 64)) & 1 ? '#' : '.';
+		}
+		std::cout << line << '\n';
+	}
+}
+
+// show the frames exported by a running emulator
+int attach(std::uint32_t pid) {
+	auto memory = chip8pp::SharedMemory::open(chip8pp::FRAMEBUFFER_PREFIX +
+	                                          std::to_string(pid));
+	if (memory.size() < sizeof(chip8pp::FramebufferPage)) {
+		throw std::runtime_error("Framebuffer segment is too small");
+	}
+	auto &page =
+	    *reinterpret_cast<const chip8pp::FramebufferPage *>(memory.data());
+	if (page.magic != chip8pp::FramebufferPage::MAGIC ||
+	    page.version != chip8pp::FramebufferPage::VERSION) {
+		throw std::runtime_error(
+		    std::format("Unsupported framebuffer export of {}", pid));
+	}
+	chip8pp::FrameSnapshot frame;
+	if (!chip8pp::readFramebufferPage(page, frame)) {
+		throw std::runtime_error("Could not read the framebuffer");
+	}
+	// nothing presented yet, assume the default resolution
+	std::size_t width = frame.width ? frame.width : 64;
+	std::size_t height = frame.height ? frame.height : 32;
+	constexpr std::size_t scale = 10;
+	Screen screen(width * scale, height * scale);
+	if (!screen.init(std::format("chip8pp-play {}", pid), width, height,
+	                 chip8pp::FrameSnapshot::MAX_WIDTH,
+	                 chip8pp::FrameSnapshot::MAX_HEIGHT)) {
+		return 1;
+	}
+	std::uint32_t seen = 0;
+	bool playing = true;
+	while (playing) {
+		SDL_Event event;
+		if (SDL_WaitEventTimeout(&event, 16)) {
+			if (event.type == SDL_EVENT_QUIT) {
+				playing = false;
+			} else if (event.type == SDL_EVENT_WINDOW_EXPOSED) {
+				screen.invalidate();
+			}
+		}
+		// a new frame was published when the sequence moved
+		auto sequence = page.frame.sequence.load(std::memory_order_acquire);
+		if (sequence == seen || !chip8pp::readFramebufferPage(page, frame)) {
+			screen.update();
+			continue;
+		}
+		seen = sequence;
+		if (frame.width != width || frame.height != height) {
+			// SUPER-CHIP mode switch
+			width = frame.width;
+			height = frame.height;
+			screen.setResolution(width, height);
+		}
+		Palette palette{frame.off, frame.on};
+		if (palette.off != screen.getPalette().off ||
+		    palette.on != screen.getPalette().on) {
+			screen.setPalette(palette);
+		}
+		screen.setRows(std::span(frame.rows.data(),
+		                         frame.wordsPerRow * frame.height));
+		screen.flush();
+		screen.update();
+	}
+	return 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	CLI::App app{"Chip8 frame stream player", "chip8pp-play"};
+	std::filesystem::path stream_path;
+	app.add_option("stream", stream_path,
+	               "Frame stream recorded with the emulator --record option");
+	std::uint32_t attach_pid = 0;
+	app.add_option("--attach", attach_pid,
+	               "Show the live frames of the emulator with this pid "
+	               "(started with --export-framebuffer)");
+	double speed = 1.0;
+	app.add_option("-s,--speed", speed, "Playback speed multiplier");
+	bool ascii = false;
+	app.add_flag("--ascii", ascii,
+	             "Print the frames as text instead of opening a window");
+	bool info = false;
+	app.add_flag("--info", info, "Only print the stream statistics");
+	CLI11_PARSE(app, argc, argv);
+
+	try {
+		if (attach_pid != 0) {
+			return attach(attach_pid);
+		}
+		if (stream_path.empty()) {
+			std::cout << "must provide a frame stream or --attach\n";
+			return 1;
+		}
+		chip8pp::FrameStreamReader reader(stream_path);
+		if (info) {
+			std::uint64_t frames = 0;
+			std::uint64_t keyframes = 0;
+			while (reader.next()) {
+				frames++;
+				keyframes += reader.getFrame().keyframe;
+			}
+			std::cout << std::format(
+			    "{} frames, {} keyframes, {:.3f}s, {} bytes\n", frames,
+			    keyframes, (double)reader.getFrame().timeNs / 1e9,
+			    std::filesystem::file_size(stream_path));
+			return 0;
+		}
+		if (!reader.next()) {
+			std::cout << "empty frame stream\n";
+			return 0;
+		}
+		if (ascii) {
+			std::uint64_t index = 0;
+			do {
+				printFrame(reader.getFrame(), index++);
+			} while (reader.next());
+			return 0;
+		}
+
+		constexpr std::size_t scale = 10;
+		auto &first = reader.getFrame();
+		std::size_t width = first.width;
+		std::size_t height = first.height;
+		Screen screen(width * scale, height * scale);
+		if (!screen.init("chip8pp-play", width, height,
+		                 chip8pp::FrameSnapshot::MAX_WIDTH,
+		                 chip8pp::FrameSnapshot::MAX_HEIGHT)) {
+			return 1;
+		}
+		auto start = std::chrono::steady_clock::now();
+		bool playing = true;
+		do {
+			auto &frame = reader.getFrame();
+			if (frame.width != width || frame.height != height) {
+				// SUPER-CHIP mode switch
+				width = frame.width;
+				height = frame.height;
+				if (!screen.setResolution(width, height)) {
+					std::cerr << std::format("unsupported resolution {}x{}\n",
+					                         width, height);
+					break;
+				}
+			}
+			// wait for the frame time, handling the window events
+			auto due = start + std::chrono::duration_cast<
+			                       std::chrono::steady_clock::duration>(
+			                       std::chrono::duration<double>(
+			                           (double)frame.timeNs / 1e9 / speed));
+			SDL_Event event;
+			while (playing) {
+				auto timeout =
+				    std::chrono::duration_cast<std::chrono::milliseconds>(
+				        due - std::chrono::steady_clock::now());
+				if (SDL_WaitEventTimeout(
+				        &event, (Sint32)std::max<std::int64_t>(
+				                    timeout.count(), 0))) {
+					if (event.type == SDL_EVENT_QUIT) {
+						playing = false;
+					} else if (event.type == SDL_EVENT_WINDOW_EXPOSED) {
+						screen.invalidate();
+					}
+				} else if (timeout.count() <= 0) {
+					break;
+				}
+			}
+			screen.setRows(frame.rows);
+			screen.flush();
+			screen.update();
+		} while (playing && reader.next());
+	} catch (const std::exception &e) {
+		std::cerr << std::format("{}\n", e.what());
+		return 1;
+	}
+}
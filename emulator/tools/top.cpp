@@ -0,0 +1,118 @@
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+
+#include <CLI/App.hpp>
+#include <CLI/CLI.hpp>
+
+#include <chip8pp/sharedMemory.hpp>
+#include <chip8pp/stats.hpp>
+
+#if __has_include(<signal.h>)
+#include <signal.h>
+#endif
+
+namespace {
+
+bool isAlive(std::uint32_t pid) {
+#if __has_include(<signal.h>)
+	return kill((pid_t)pid, 0) == 0 || errno == EPERM;
+#else
+	return pid != 0;
+#endif
+}
+
+double toMs(std::uint64_t us) { return (double)us / 1000.0; }
+
+void printTable(std::map<std::string, chip8pp::StatsSnapshot> &previous) {
+	std::cout << std::format(
+	    "{:>8} {:>10} {:>9} {:>6} {:>14} {:>14} {:>7} {:>10} {:>14} {:>14} "
+	    "{:>9}\n",
+	    "PID", "inst/s", "frames", "fps", "frame p50/p99", "age p50/p99",
+	    "missed", "update", "input p50/max", "read p50/max", "overruns");
+	std::map<std::string, chip8pp::StatsSnapshot> current;
+	for (auto &name : chip8pp::SharedMemory::list(chip8pp::STATS_PREFIX)) {
+		chip8pp::StatsSnapshot snapshot;
+		std::uint32_t pid = 0;
+		try {
+			auto memory = chip8pp::SharedMemory::open(name);
+			if (memory.size() < sizeof(chip8pp::StatsPage)) {
+				continue;
+			}
+			auto &page =
+			    *reinterpret_cast<const chip8pp::StatsPage *>(memory.data());
+			if (page.magic != chip8pp::StatsPage::MAGIC ||
+			    page.version != chip8pp::StatsPage::VERSION ||
+			    !chip8pp::readStatsPage(page, snapshot)) {
+				continue;
+			}
+			pid = page.pid;
+		} catch (const std::exception &) {
+			// the instance exited while we were reading it
+			continue;
+		}
+		if (!isAlive(pid)) {
+			std::cout << std::format("{:>8} (exited without cleanup)\n", pid);
+			continue;
+		}
+
+		// frames per second since the previous refresh
+		double fps = 0.0;
+		auto it = previous.find(name);
+		if (it != previous.end() &&
+		    snapshot.timestampNs > it->second.timestampNs) {
+			fps = (double)(snapshot.framesPresented -
+			               it->second.framesPresented) *
+			      1e9 / (double)(snapshot.timestampNs - it->second.timestampNs);
+		}
+		std::cout << std::format(
+		    "{:>8} {:>10} {:>9} {:>6.1f} {:>6.2f}/{:<6.2f}ms "
+		    "{:>6.2f}/{:<6.2f}ms {:>7} {:>8.1f}us {:>6.2f}/{:<6.2f}ms "
+		    "{:>6.2f}/{:<6.2f}ms {:>9}\n",
+		    pid, snapshot.instructionsPerSecond, snapshot.framesPresented, fps,
+		    toMs(snapshot.frameTime.percentile(50)),
+		    toMs(snapshot.frameTime.percentile(99)),
+		    toMs(snapshot.frameAge.percentile(50)),
+		    toMs(snapshot.frameAge.percentile(99)), snapshot.missedFrames,
+		    (double)snapshot.screenUpdate.meanNs() / 1000.0,
+		    toMs(snapshot.inputLatency.percentile(50)),
+		    (double)snapshot.inputLatency.maxNs / 1e6,
+		    toMs(snapshot.inputReadLatency.percentile(50)),
+		    (double)snapshot.inputReadLatency.maxNs / 1e6,
+		    snapshot.schedulerOverruns);
+		current[name] = snapshot;
+	}
+	previous = std::move(current);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	CLI::App app{"Live statistics of the running chip8pp emulators",
+	             "chip8pp-top"};
+	double interval = 1.0;
+	app.add_option("-d,--delay", interval, "Seconds between refreshes");
+	bool once = false;
+	app.add_flag("-1,--once", once, "Print the statistics once and exit");
+	CLI11_PARSE(app, argc, argv);
+
+	std::map<std::string, chip8pp::StatsSnapshot> previous;
+	while (true) {
+		if (!once) {
+			// clear the terminal
+			std::cout << "\x1b[H\x1b[2J";
+		}
+		printTable(previous);
+		std::cout << std::flush;
+		if (once) {
+			break;
+		}
+		std::this_thread::sleep_for(std::chrono::duration<double>(interval));
+	}
+}
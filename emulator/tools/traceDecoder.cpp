@@ -0,0 +1,49 @@
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <string>
+
+#include <CLI/App.hpp>
+#include <CLI/CLI.hpp>
+
+#include <chip8pp/cpu.hpp>
+#include <chip8pp/disassembler.hpp>
+#include <chip8pp/trace.hpp>
+
+int main(int argc, char **argv) {
+	CLI::App app{"Chip8 execution trace decoder", "chip8pp-trace"};
+	std::filesystem::path trace_path;
+	app.add_option("trace", trace_path, "Path to the trace file")->required();
+	std::size_t last = 0;
+	app.add_option("-n,--last", last,
+	               "Only print the last N records (0 prints all of them)");
+	CLI11_PARSE(app, argc, argv);
+
+	try {
+		chip8pp::TraceFileHeader header;
+		auto records = chip8pp::readTraceFile(trace_path, header);
+		std::cout << std::format("; {} instructions traced, {} kept\n",
+		                         header.written, records.size());
+		std::size_t first = 0;
+		if (last != 0 && last < records.size()) {
+			first = records.size() - last;
+		}
+		for (std::size_t i = first; i < records.size(); i++) {
+			auto &record = records[i];
+			std::string change;
+			if (record.reg != chip8pp::TraceRecord::NO_REGISTER) {
+				change = std::format("V{:X}={:#04x}", record.reg, record.value);
+			}
+			std::cout << std::format(
+			    "{:>12} {:03x}  {:04x}  {:<20} I={:03x} {}\n", record.cycle,
+			    record.pc, record.opcode,
+			    chip8pp::disassemble(chip8pp::CPU::decode(record.opcode)),
+			    record.index, change);
+		}
+	} catch (const std::exception &e) {
+		std::cerr << std::format("{}\n", e.what());
+		return 1;
+	}
+}
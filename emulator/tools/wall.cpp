@@ -0,0 +1,154 @@
+#define SDL_MAIN_HANDLED
+
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <vector>
+
+#include <SDL3/SDL.h>
+
+#include <CLI/App.hpp>
+#include <CLI/CLI.hpp>
+
+#include <libcanvas/mosaic.hpp>
+
+#include <chip8pp/framePacer.hpp>
+#include <chip8pp/session.hpp>
+#include <chip8pp/utils.hpp>
+
+int main(int argc, char **argv) {
+	CLI::App app{"Run many headless sessions and show them in one window",
+	             "chip8pp-wall"};
+	std::vector<std::filesystem::path> rom_paths;
+	app.add_option("roms", rom_paths, "Roms to run")->required();
+	std::size_t instances = 0;
+	app.add_option("-n,--instances", instances,
+	               "Sessions to run, the roms are repeated in order "
+	               "(default: one per rom)");
+	std::uint32_t seed = 0;
+	app.add_option("--seed", seed,
+	               "Seed of the RND instruction of the first session, the "
+	               "next ones use the following seeds");
+	std::size_t cycles_per_frame = chip8pp::Session::DEFAULT_CYCLES_PER_FRAME;
+	app.add_option("--cycles-per-frame", cycles_per_frame,
+	               "Instructions executed between two timer ticks");
+	std::optional<std::filesystem::path> movie_path;
+	app.add_option("--movie", movie_path,
+	               "Input movie replayed by every session");
+	std::size_t columns = 0;
+	app.add_option("--columns", columns,
+	               "Tiles per row (default: the most square layout)");
+	std::size_t tile_scale = 2;
+	app.add_option("--tile-scale", tile_scale,
+	               "Initial window pixels per 64x32 mode pixel");
+	std::uint64_t frames = 0;
+	app.add_option("--frames", frames,
+	               "Stop after this number of frames (default: when the "
+	               "window is closed)");
+	CLI11_PARSE(app, argc, argv);
+
+	if (instances == 0) {
+		instances = rom_paths.size();
+	}
+	std::vector<std::unique_ptr<chip8pp::Session>> sessions;
+	chip8pp::InputMovie movie;
+	try {
+		std::vector<std::tuple<std::unique_ptr<std::byte[]>, std::size_t>>
+		    roms;
+		for (auto &path : rom_paths) {
+			roms.push_back(chip8pp::utils::load_file(path));
+		}
+		for (std::size_t i = 0; i < instances; i++) {
+			auto &[rom, size] = roms[i % roms.size()];
+			sessions.push_back(std::make_unique<chip8pp::Session>(
+			    std::span(rom.get(), size), seed + (std::uint32_t)i,
+			    cycles_per_frame));
+		}
+		if (movie_path) {
+			movie = chip8pp::InputMovie::load(*movie_path);
+		}
+	} catch (const std::exception &e) {
+		std::cerr << std::format("{}\n", e.what());
+		return 1;
+	}
+
+	constexpr std::size_t width = chip8pp::Session::WIDTH;
+	constexpr std::size_t height = chip8pp::Session::HEIGHT;
+	if (columns == 0) {
+		columns = (std::size_t)std::ceil(std::sqrt((double)instances));
+	}
+	std::size_t rows = (instances + columns - 1) / columns;
+	// tiles fit the hi-res mode, 64x32 frames are scaled up in them
+	Mosaic mosaic(columns * (width + Mosaic::GAP) * tile_scale,
+	              rows * (height + Mosaic::GAP) * tile_scale);
+	if (!mosaic.init(std::format("chip8pp-wall ({} sessions)", instances),
+	                 instances, chip8pp::Session::MAX_WIDTH,
+	                 chip8pp::Session::MAX_HEIGHT, columns)) {
+		return 1;
+	}
+
+	auto period =
+	    std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+	        std::chrono::duration<double>(1.0 / 60.0));
+	chip8pp::FramePacer pacer(period, false);
+	std::chrono::steady_clock::duration emulation_time{};
+	std::chrono::steady_clock::duration present_time{};
+	std::uint64_t uploaded_tiles = 0;
+	std::uint64_t frame = 0;
+	bool running = true;
+	while (running && (frames == 0 || frame < frames)) {
+		SDL_Event event;
+		while (running) {
+			auto timeout =
+			    std::chrono::duration_cast<std::chrono::milliseconds>(
+			        pacer.getSleepTime(std::chrono::steady_clock::now()));
+			if (SDL_WaitEventTimeout(&event, (Sint32)timeout.count())) {
+				if (event.type == SDL_EVENT_QUIT) {
+					running = false;
+				} else if (event.type == SDL_EVENT_WINDOW_EXPOSED ||
+				           event.type == SDL_EVENT_WINDOW_RESIZED) {
+					mosaic.invalidate();
+				}
+			} else if (timeout.count() == 0) {
+				break;
+			}
+		}
+		pacer.finishWait();
+		// every session runs one frame on this thread, then only the tiles
+		// that changed are uploaded
+		auto emulation_start = std::chrono::steady_clock::now();
+		for (std::size_t i = 0; i < sessions.size(); i++) {
+			auto &session = *sessions[i];
+			session.setKeys(movie.keysAt(session.frame));
+			session.runFrame();
+			mosaic.setTile(i, session.getFrame());
+		}
+		auto present_start = std::chrono::steady_clock::now();
+		bool presented = mosaic.present();
+		auto present_end = std::chrono::steady_clock::now();
+		emulation_time += present_start - emulation_start;
+		present_time += present_end - present_start;
+		uploaded_tiles += mosaic.getUploadedTiles();
+		pacer.frameDone(presented, emulation_start, present_end);
+		frame++;
+	}
+
+	if (frame > 0) {
+		using us = std::chrono::duration<double, std::micro>;
+		std::cout << std::format(
+		    "{} sessions, {} frames: emulation {:.1f} us/frame, present "
+		    "{:.1f} us/frame, {:.1f} tiles uploaded/frame\n",
+		    sessions.size(), frame, us(emulation_time).count() / frame,
+		    us(present_time).count() / frame,
+		    (double)uploaded_tiles / frame);
+		std::cout << pacer.summary();
+	}
+	return 0;
+}
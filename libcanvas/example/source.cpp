@@ -13,6 +13,8 @@ int main() {
 	if (!screen.init("Grid", 10, 10)) {
 		return -1;
 	}
+	// draw the set pixels in red
+	screen.setPalette({0x00000000, 0xFF0000FF});
 	bool quit = false;
 	SDL_Event event;
 	size_t currentX = 0;
@@ -34,6 +36,7 @@ int main() {
 			}
 		}
 		screen.setPixel(currentX, currentY, 0xFF0000FF);
+		screen.flush();
 		screen.update();
 	}
 
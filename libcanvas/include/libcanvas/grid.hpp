@@ -1,34 +1,148 @@
 #pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <libcanvas/palette.hpp>
 #include <memory>
-#include <mutex>
-#include <vector>
+#include <span>
 
-using pixelRGBA_t = std::uint32_t;
+// how a sprite is combined with the grid
+struct BlitMode {
+	enum class Op {
+		// toggle the pixels, a set pixel that is cleared is a collision
+		Xor,
+		// set the pixels, a pixel that was already set is a collision
+		Or,
+	};
+	enum class Edge {
+		// drop the pixels outside of the grid
+		Clip,
+		// continue on the opposite edge
+		Wrap,
+	};
+	Op op{Op::Xor};
+	Edge edge{Edge::Clip};
+};
 
+// monochrome pixel grid stored as 1 bit per pixel
+// - every row is made of getWordsPerRow() words, bit 63 of the first word is
+//   the leftmost pixel, colours are applied through a Palette when presented
+// - one writer thread draws into a private buffer, a single reader thread
+//   takes the newest published frame with acquireFrame, they exchange the
+//   frames through a lock-free triple buffer
+// - a drawing operation is only copied out when the reader took the last
+//   frame, otherwise it waits for poll or flush, so a writer copies at most
+//   one frame per frame read however often it draws
+// - the buffers are allocated by setScreenSize for its largest size, a
+//   setResolution within it (e.g. a SUPER-CHIP mode switch) never allocates
+// - setScreenSize must not run concurrently with the other methods
 class Grid {
-	// lock
-	mutable std::mutex m_gridMutex;
-	std::size_t width;
-	std::size_t height;
-	std::unique_ptr<pixelRGBA_t[]> buffer;
-
   public:
+	// frame published by the writer, valid until the next acquireFrame
+	struct FrameView {
+		const std::uint64_t *rows;
+		std::size_t width;
+		std::size_t height;
+		std::size_t wordsPerRow;
+		// publication counter of the frame, 0 before the first one
+		std::uint64_t sequence;
+		// when the writer published the frame
+		std::chrono::steady_clock::time_point published;
+		// false when it is the same frame as the previous acquireFrame
+		bool fresh;
+	};
+
 	Grid(std::size_t width, std::size_t height);
-	void setPixel(std::size_t x, std::size_t y, pixelRGBA_t color);
+	// writer
+	void setPixel(std::size_t x, std::size_t y, bool pixel);
+	// draw a sprite with its top left corner at (x, y), width / 8 bytes per
+	// row with the most significant bit on the left
+	// - width is a multiple of 8 up to 64 (8 for CHIP-8, 16 for SUPER-CHIP)
+	// - the whole sprite is published at once
+	// - returns true on collision, see BlitMode
+	bool blitSprite(std::size_t x, std::size_t y,
+	                std::span<const std::byte> sprite, BlitMode mode,
+	                std::size_t width = 8);
 	void clear();
-	void setScreenSize(std::size_t width, std::size_t height);
-	pixelRGBA_t getPixel(std::size_t x, std::size_t y) const;
-	std::vector<pixelRGBA_t> getBuffer() const;
+	// move the whole grid, the pixels that leave it are dropped and the
+	// uncovered ones are cleared
+	// - rows are moved with a single copy and columns by shifting the packed
+	//   words of each row, never pixel by pixel
+	void scrollDown(std::size_t rows);
+	void scrollLeft(std::size_t columns);
+	void scrollRight(std::size_t columns);
+	// replace the whole grid with packed rows, wordsPerRow words per row
+	void setRows(std::span<const std::uint64_t> rows);
+	bool getPixel(std::size_t x, std::size_t y) const;
+	// publish the drawing not published yet once the reader took the last
+	// frame, cheap enough to call between every operation
+	void poll() {
+		if (m_dirty &&
+		    !(m_middle.load(std::memory_order_relaxed) & FRESH)) {
+			publish();
+		}
+	}
+	// publish the drawing not published yet, at the end of a frame or
+	// before the writer stops drawing for a while
+	void flush();
+
+	// reader
+	FrameView acquireFrame();
+
+	// reallocate the buffers for frames up to maxWidth x maxHeight (at least
+	// width x height) and start at width x height
+	void setScreenSize(std::size_t width, std::size_t height,
+	                   std::size_t maxWidth = 0, std::size_t maxHeight = 0);
+	// writer: switch to another size that fits the buffers, the grid is
+	// cleared and published, returns false when it does not fit
+	bool setResolution(std::size_t width, std::size_t height);
 	std::size_t getWidth() const;
 	std::size_t getHeight() const;
+	std::size_t getWordsPerRow() const;
+	std::size_t getMaxWidth() const;
+	std::size_t getMaxHeight() const;
 
   private:
-	void unlocked_setPixel(std::size_t x, std::size_t y, pixelRGBA_t color);
-	void unlocked_clear();
-	void unlocked_setScreenSize(std::size_t width, std::size_t height);
-	pixelRGBA_t unlocked_getPixel(std::size_t x, std::size_t y) const;
-	std::vector<pixelRGBA_t> unlocked_getBuffer() const;
-	std::size_t unlocked_getWidth() const;
-	std::size_t unlocked_getHeight() const;
+	// bit 63 of pattern is the pixel at x
+	bool blitRow(std::size_t x, std::size_t y, std::uint64_t pattern,
+	             BlitMode mode);
+	// a drawing operation completed
+	void changed() {
+		m_dirty = true;
+		poll();
+	}
+	// copy the drawing buffer into the back slot and swap it with the
+	// middle one
+	void publish();
+
+	static constexpr std::uint8_t SLOT_MASK = 0x3;
+	// set in m_middle when it holds a frame the reader has not seen
+	static constexpr std::uint8_t FRESH = 0x4;
+
+	std::size_t width;
+	std::size_t height;
+	std::size_t wordsPerRow;
+	// size the buffers were allocated for
+	std::size_t m_maxWidth{0};
+	std::size_t m_maxHeight{0};
+	// drawing buffer, owned by the writer
+	std::unique_ptr<std::uint64_t[]> buffer;
+	std::array<std::unique_ptr<std::uint64_t[]>, 3> m_slots;
+	std::array<std::uint64_t, 3> m_slotSequence{};
+	std::array<std::chrono::steady_clock::time_point, 3> m_slotTime{};
+	// size of the frame in each slot, the resolution may change while the
+	// reader holds an older frame
+	std::array<std::size_t, 3> m_slotWidth{};
+	std::array<std::size_t, 3> m_slotHeight{};
+	// writer owned
+	std::uint8_t m_back{0};
+	std::uint64_t m_published{0};
+	// the drawing buffer changed since the last publish
+	bool m_dirty{false};
+	// exchanged between both sides
+	alignas(64) std::atomic<std::uint8_t> m_middle{1};
+	// reader owned
+	alignas(64) std::uint8_t m_front{2};
 };
@@ -0,0 +1,88 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <libcanvas/grid.hpp>
+#include <libcanvas/palette.hpp>
+#include <string_view>
+#include <vector>
+
+struct SDL_Window;
+struct SDL_Renderer;
+struct SDL_Texture;
+
+// presents the frames of many grids as tiles of a single window
+// - every tile is a cell of one atlas texture, columns x rows tiles apart by
+//   GAP texels, and the whole atlas is drawn with a single render call
+// - setTile only copies the packed rows, present colours the tiles that
+//   changed and uploads them with one texture update per row of tiles
+// - a frame smaller than the tile is scaled by the largest integer factor
+//   that fits and centered, a larger one is clipped
+// - every method runs on the thread that called init
+class Mosaic {
+  public:
+	// texels between two tiles, drawn with the border colour
+	static constexpr std::size_t GAP = 1;
+
+	Mosaic(std::size_t windowWidth, std::size_t windowHeight);
+	Mosaic(const Mosaic &) = delete;
+	Mosaic &operator=(const Mosaic &) = delete;
+
+	// columns 0 picks the most square layout
+	bool init(std::string_view title, std::size_t tileCount,
+	          std::size_t tileWidth, std::size_t tileHeight,
+	          std::size_t columns = 0);
+
+	// replace the frame of the tile, returns true when it changed
+	bool setTile(std::size_t tile, Grid::FrameView const &frame);
+	void setPalette(std::size_t tile, Palette palette);
+	// colour of the gaps and of the tile area around a smaller frame
+	void setBorder(pixelRGBA_t colour);
+	// upload the changed tiles and present the atlas, returns false without
+	// presenting when no tile changed
+	bool present();
+	// present every tile again, e.g. after the window was exposed
+	void invalidate();
+
+	std::size_t getTileCount() const;
+	std::size_t getColumns() const;
+	std::size_t getRows() const;
+	// tiles uploaded by the last present
+	std::size_t getUploadedTiles() const;
+
+	void close();
+
+	~Mosaic();
+
+  private:
+	struct Tile {
+		std::vector<std::uint64_t> rows;
+		std::size_t width{0};
+		std::size_t height{0};
+		std::size_t wordsPerRow{0};
+		Palette palette;
+		bool dirty{true};
+	};
+
+	// colour the tile into its cell of m_atlas
+	void colourTile(std::size_t index);
+
+	SDL_Window *m_window{nullptr};
+	SDL_Renderer *m_renderer{nullptr};
+	SDL_Texture *m_texture{nullptr};
+	std::size_t m_windowWidth;
+	std::size_t m_windowHeight;
+	std::size_t m_tileWidth{0};
+	std::size_t m_tileHeight{0};
+	std::size_t m_columns{0};
+	std::size_t m_rows{0};
+	std::size_t m_atlasWidth{0};
+	std::size_t m_atlasHeight{0};
+	pixelRGBA_t m_border{0x202020FF};
+	std::vector<Tile> m_tiles;
+	// cpu copy of the texture
+	std::vector<pixelRGBA_t> m_atlas;
+	// palette colours of a frame row before scaling
+	std::vector<pixelRGBA_t> m_line;
+	std::size_t m_uploadedTiles{0};
+	bool m_invalidated{true};
+};
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using pixelRGBA_t = std::uint32_t;
+
+// colours of the 1 bit per pixel grid, applied when the grid is presented
+struct Palette {
+	pixelRGBA_t off{0x00000000};
+	pixelRGBA_t on{0xFFFFFFFF};
+
+	pixelRGBA_t operator()(bool pixel) const { return pixel ? on : off; }
+
+	// expand a packed row (bit 63 of the first word is the leftmost pixel)
+	// into width RGBA pixels
+	// - a set bit selects on through a mask instead of a branch, 4 pixels at
+	//   a time with SSE2
+	void expandRow(const std::uint64_t *row, std::size_t width,
+	               pixelRGBA_t *out) const {
+		std::size_t x = 0;
+#if defined(__SSE2__)
+		// lane 0 is the leftmost pixel, the most significant bit of a nibble
+		const __m128i bits = _mm_set_epi32(1, 2, 4, 8);
+		const __m128i offs = _mm_set1_epi32((int)off);
+		const __m128i diff = _mm_set1_epi32((int)(on ^ off));
+		for (; x + 4 <= width; x += 4) {
+			// x is a multiple of 4, the nibble never crosses two words
+			auto nibble = (int)((row[x / 64] >> (60 - x % 64)) & 0xF);
+			__m128i mask = _mm_cmpeq_epi32(
+			    _mm_and_si128(_mm_set1_epi32(nibble), bits), bits);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(out + x),
+			                 _mm_xor_si128(offs, _mm_and_si128(mask, diff)));
+		}
+#endif
+		for (; x < width; x++) {
+			auto bit = (pixelRGBA_t)(row[x / 64] >> (63 - x % 64)) & 1;
+			out[x] = off ^ ((on ^ off) & (0u - bit));
+		}
+	}
+};
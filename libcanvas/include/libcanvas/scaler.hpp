@@ -0,0 +1,62 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <libcanvas/grid.hpp>
+#include <libcanvas/palette.hpp>
+#include <ostream>
+#include <vector>
+
+// turns packed grid frames into integer scaled RGBA images
+// - keeps the last phosphorFrames frames, a pixel that was lit i frames ago
+//   is drawn with the intensity decay^i so pixels erased and redrawn by XOR
+//   sprites do not flicker, 1 frame disables the blend
+// - the history lookup, palette and scaling run in a single pass per row,
+//   with SSE2 when the compiler targets it: the history of 16 pixels is
+//   gathered at once and the pixels are widened 4 at a time
+class Scaler {
+  public:
+	static constexpr std::size_t MAX_PHOSPHOR_FRAMES = 8;
+
+	explicit Scaler(std::size_t phosphorFrames = 1, float decay = 0.5f);
+
+	void setPalette(Palette palette);
+	void setPhosphor(std::size_t phosphorFrames, float decay);
+	std::size_t getPhosphorFrames() const;
+
+	// make frame the newest one of the history
+	void push(const Grid::FrameView &frame);
+	// write rows [firstRow, firstRow + rowCount) of the newest frame, every
+	// grid pixel becomes scale x scale pixels
+	// - out is the first pixel of grid row firstRow, pitch is in bytes
+	void scaleRows(std::size_t firstRow, std::size_t rowCount,
+	               std::size_t scale, std::uint8_t *out,
+	               std::size_t pitch) const;
+	// dimensions of the frames in the history
+	std::size_t getWidth() const;
+	std::size_t getHeight() const;
+
+	// write RGBA pixels as a binary PPM image
+	static void writePpm(std::ostream &out, const pixelRGBA_t *pixels,
+	                     std::size_t width, std::size_t height);
+
+  private:
+	void rebuildLut();
+	// colour of every grid pixel of the row, blended with the history
+	void colourRow(std::size_t row, pixelRGBA_t *out) const;
+
+	Palette m_palette;
+	std::size_t m_phosphorFrames;
+	float m_decay;
+	// colour for every history pattern, bit i set when the pixel was lit i
+	// frames ago
+	std::array<pixelRGBA_t, 1 << MAX_PHOSPHOR_FRAMES> m_lut{};
+	std::size_t m_width{0};
+	std::size_t m_height{0};
+	std::size_t m_wordsPerRow{0};
+	// m_phosphorFrames frames, m_newest is the index of the newest one
+	std::vector<std::uint64_t> m_history;
+	std::size_t m_newest{0};
+	// grid colours of a row before scaling
+	mutable std::vector<pixelRGBA_t> m_line;
+};
@@ -1,14 +1,26 @@
 #pragma once
 #include <cstddef>
 #include <libcanvas/grid.hpp>
+#include <libcanvas/palette.hpp>
+#include <libcanvas/scaler.hpp>
 #include <memory>
+#include <ostream>
 #include <string>
 #include <string_view>
+#include <vector>
 
 struct SDL_Window;
 struct SDL_Renderer;
 struct SDL_Texture;
 
+// how presented frames reach the texture
+enum class PresentMode {
+	// colour the rows into a buffer and copy it with SDL_UpdateTexture
+	Static,
+	// colour the rows directly into the locked memory of a streaming texture
+	Streaming,
+};
+
 class Screen {
 
 	SDL_Window *m_window;
@@ -17,24 +29,90 @@ class Screen {
 	std::unique_ptr<pixelRGBA_t> m_mainBuffer;
 	std::size_t screenWidth;
 	std::size_t screenHeight;
-	std::size_t pixelWidth;
-	std::size_t pixelHeight;
+	PresentMode m_presentMode;
 	Grid grid;
+	Palette m_palette;
+	// frame shown by the last update
+	Grid::FrameView m_frame{};
+	// colours the presented rows, with the optional phosphor blend
+	Scaler m_scaler;
+	// presents left before the phosphor trails have faded
+	std::size_t m_phosphorPending{0};
+	// rows currently shown in the texture
+	std::vector<std::uint64_t> m_presentedRows;
+	// upload every row and present even if the frame did not change
+	bool m_invalidated{true};
+	bool m_headless{false};
+
+	// copy rows [firstRow, firstRow + rowCount) of m_frame into the texture
+	void uploadStatic(std::size_t firstRow, std::size_t rowCount);
+	void uploadStreaming(std::size_t firstRow, std::size_t rowCount);
 
   public:
-	Screen(std::size_t screenWidth, std::size_t screenHeight);
+	Screen(std::size_t screenWidth, std::size_t screenHeight,
+	       PresentMode presentMode = PresentMode::Static);
 
+	// the texture and the grid buffers are sized for grids up to
+	// maxGridWidth x maxGridHeight, see setResolution
 	bool init(std::string_view title, std::size_t gridWidth,
-	          std::size_t gridHeight);
+	          std::size_t gridHeight, std::size_t maxGridWidth = 0,
+	          std::size_t maxGridHeight = 0);
+	// set up the grid without a window, SDL is never touched and update
+	// only takes the newest frame
+	void initHeadless(std::size_t gridWidth, std::size_t gridHeight,
+	                  std::size_t maxGridWidth = 0,
+	                  std::size_t maxGridHeight = 0);
 
-	void update();
+	// present the newest frame published by the drawing thread
+	// - only the rows that changed are uploaded, returns false without
+	//   presenting when nothing changed (and always when headless)
+	bool update();
+	PresentMode getPresentMode() const;
+	// block every present until the vertical blank, returns false when the
+	// renderer cannot synchronize with the display
+	bool setVSync(bool enabled);
+	// refresh rate in Hz of the display showing the window, 0 when unknown
+	float getRefreshRate() const;
+	// present the next frame in full, e.g. after the window was exposed
+	void invalidate();
+	// blend the last frames to hide XOR flicker, see Scaler
+	void setPhosphor(std::size_t frames, float decay = 0.5f);
+	// write the presented frame as a PPM image, scale x scale pixels per
+	// grid pixel
+	void writeScreenshot(std::ostream &out, std::size_t scale);
+	// frame presented by the last update, only valid on the thread calling
+	// update
+	Grid::FrameView getFrame() const;
 
+	// drawing thread
+	// the grid only stores whether a pixel is set, any colour other than 0
+	// sets it
 	void setPixel(std::size_t x, std::size_t y, pixelRGBA_t color);
+	// palette colour of the pixel
 	pixelRGBA_t getPixel(std::size_t x, std::size_t y);
+	// draw a sprite into the grid, see Grid::blitSprite
+	bool blitSprite(std::size_t x, std::size_t y,
+	                std::span<const std::byte> sprite, BlitMode mode,
+	                std::size_t width = 8);
+	void clear();
+	// see Grid::scrollDown
+	void scrollDown(std::size_t rows);
+	void scrollLeft(std::size_t columns);
+	void scrollRight(std::size_t columns);
+	// switch the grid to another size up to the one given to init, without
+	// any allocation, returns false when it does not fit
+	bool setResolution(std::size_t gridWidth, std::size_t gridHeight);
+	// replace the grid content, see Grid::setRows
+	void setRows(std::span<const std::uint64_t> rows);
+	// hand the drawing to update, see Grid::poll and Grid::flush
+	void poll();
+	void flush();
+
+	void setPalette(Palette palette);
+	Palette getPalette() const;
 	std::size_t getGridWidth();
 	std::size_t getGridHeight();
-
-	void clear();
+	std::size_t getGridWordsPerRow();
 
 	void close();
 
@@ -1,89 +1,245 @@
+#include <algorithm>
 #include <libcanvas/grid.hpp>
 
+namespace {
+std::size_t wordsFor(std::size_t width) { return (width + 63) / 64; }
+} // namespace
+
 Grid::Grid(std::size_t width, std::size_t height)
-    : width(width), height(height), buffer(new pixelRGBA_t[width * height]) {}
+    : width(0), height(0), wordsPerRow(0) {
+	setScreenSize(width, height);
+}
+
+void Grid::setPixel(std::size_t x, std::size_t y, bool pixel) {
+	if (x < width && y < height) {
+		std::uint64_t &word = buffer[y * wordsPerRow + x / 64];
+		std::uint64_t bit = std::uint64_t(1) << (63 - x % 64);
+		word = pixel ? word | bit : word & ~bit;
+		changed();
+	}
+}
 
-void Grid::setPixel(std::size_t x, std::size_t y, pixelRGBA_t color) {
-	// lock the mutex
-	std::lock_guard<std::mutex> lock{m_gridMutex};
-	unlocked_setPixel(x, y, color);
+bool Grid::blitSprite(std::size_t x, std::size_t y,
+                      std::span<const std::byte> sprite, BlitMode mode,
+                      std::size_t width) {
+	std::size_t bytesPerRow = std::clamp<std::size_t>(width / 8, 1, 8);
+	bool collision = false;
+	for (std::size_t row = 0; row < sprite.size() / bytesPerRow; row++) {
+		// the bytes of the row, left aligned in the pattern
+		std::uint64_t pattern = 0;
+		for (std::size_t i = 0; i < bytesPerRow; i++) {
+			pattern |= (std::uint64_t)sprite[row * bytesPerRow + i]
+			           << (56 - 8 * i);
+		}
+		collision |= blitRow(x, y + row, pattern, mode);
+	}
+	changed();
+	return collision;
 }
 
 void Grid::clear() {
-	// lock the mutex
-	std::lock_guard<std::mutex> lock{m_gridMutex};
-	unlocked_clear();
+	// set the array to 0s
+	std::fill(buffer.get(), buffer.get() + wordsPerRow * height, 0);
+	changed();
 }
 
-void Grid::setScreenSize(std::size_t width, std::size_t height) {
-	// lock the mutex
-	std::lock_guard<std::mutex> lock{m_gridMutex};
-	unlocked_setScreenSize(width, height);
+void Grid::scrollDown(std::size_t rows) {
+	rows = std::min(rows, height);
+	std::uint64_t *begin = buffer.get();
+	std::uint64_t *end = begin + wordsPerRow * height;
+	// the ranges overlap, copy from the bottom
+	std::copy_backward(begin, end - rows * wordsPerRow, end);
+	std::fill(begin, begin + rows * wordsPerRow, 0);
+	changed();
 }
 
-pixelRGBA_t Grid::getPixel(std::size_t x, std::size_t y) const {
-	// lock the mutex
-	std::lock_guard<std::mutex> lock{m_gridMutex};
-	return unlocked_getPixel(x, y);
+void Grid::scrollLeft(std::size_t columns) {
+	if (columns >= width) {
+		clear();
+		return;
+	}
+	std::size_t words = columns / 64;
+	std::size_t shift = columns % 64;
+	for (std::size_t y = 0; y < height; y++) {
+		std::uint64_t *row = &buffer[y * wordsPerRow];
+		// every word only reads itself and the words on its right
+		for (std::size_t i = 0; i < wordsPerRow; i++) {
+			std::size_t source = i + words;
+			std::uint64_t word =
+			    source < wordsPerRow ? row[source] << shift : 0;
+			if (shift != 0 && source + 1 < wordsPerRow) {
+				word |= row[source + 1] >> (64 - shift);
+			}
+			row[i] = word;
+		}
+	}
+	changed();
 }
 
-std::vector<pixelRGBA_t> Grid::getBuffer() const {
-	// lock the mutex
-	std::lock_guard<std::mutex> lock{m_gridMutex};
-	return unlocked_getBuffer();
+void Grid::scrollRight(std::size_t columns) {
+	if (columns >= width) {
+		clear();
+		return;
+	}
+	std::size_t words = columns / 64;
+	std::size_t shift = columns % 64;
+	// drops the pixels pushed past the right edge
+	std::uint64_t lastMask =
+	    width % 64 ? ~std::uint64_t(0) << (64 - width % 64) : ~std::uint64_t(0);
+	for (std::size_t y = 0; y < height; y++) {
+		std::uint64_t *row = &buffer[y * wordsPerRow];
+		// every word only reads itself and the words on its left
+		for (std::size_t i = wordsPerRow; i-- > 0;) {
+			std::uint64_t word = i >= words ? row[i - words] >> shift : 0;
+			if (shift != 0 && i > words) {
+				word |= row[i - words - 1] << (64 - shift);
+			}
+			row[i] = word;
+		}
+		row[wordsPerRow - 1] &= lastMask;
+	}
+	changed();
 }
 
-std::size_t Grid::getWidth() const {
-	// lock the mutex
-	std::lock_guard<std::mutex> lock{m_gridMutex};
-	return unlocked_getWidth();
+void Grid::setRows(std::span<const std::uint64_t> rows) {
+	std::size_t count = std::min(rows.size(), wordsPerRow * height);
+	std::copy(rows.begin(), rows.begin() + count, buffer.get());
+	std::fill(buffer.get() + count, buffer.get() + wordsPerRow * height, 0);
+	changed();
 }
 
-std::size_t Grid::getHeight() const {
-	// lock the mutex
-	std::lock_guard<std::mutex> lock{m_gridMutex};
-	return unlocked_getHeight();
+void Grid::flush() {
+	if (m_dirty) {
+		publish();
+	}
 }
 
-void Grid::unlocked_setPixel(std::size_t x, std::size_t y, pixelRGBA_t color) {
+bool Grid::getPixel(std::size_t x, std::size_t y) const {
 	if (x < width && y < height) {
-		buffer[y * width + x] = color;
+		return (buffer[y * wordsPerRow + x / 64] >> (63 - x % 64)) & 1;
 	}
+	return false;
 }
 
-void Grid::unlocked_clear() {
-	// set the array to 0s
-	std::fill(buffer.get(), buffer.get() + width * height, 0);
+Grid::FrameView Grid::acquireFrame() {
+	bool fresh = false;
+	if (m_middle.load(std::memory_order_relaxed) & FRESH) {
+		// take the newest frame and hand the old front back to the writer
+		m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) &
+		          SLOT_MASK;
+		fresh = true;
+	}
+	return {m_slots[m_front].get(),
+	        m_slotWidth[m_front],
+	        m_slotHeight[m_front],
+	        wordsFor(m_slotWidth[m_front]),
+	        m_slotSequence[m_front],
+	        m_slotTime[m_front],
+	        fresh};
 }
 
-void Grid::unlocked_setScreenSize(std::size_t width, std::size_t height) {
+void Grid::setScreenSize(std::size_t width, std::size_t height,
+                         std::size_t maxWidth, std::size_t maxHeight) {
+	maxWidth = std::max(maxWidth, width);
+	maxHeight = std::max(maxHeight, height);
 	// check that the new size is different from the old one
-	if (width == this->width && height == this->height) {
+	if (width == this->width && height == this->height &&
+	    maxWidth == m_maxWidth && maxHeight == m_maxHeight) {
 		return;
 	}
 	this->width = width;
 	this->height = height;
-	// delete the old buffer and create a new one with 0s
-	buffer.reset(new pixelRGBA_t[width * height]);
-	unlocked_clear();
+	wordsPerRow = wordsFor(width);
+	m_maxWidth = maxWidth;
+	m_maxHeight = maxHeight;
+	// delete the old buffers and create new ones with 0s
+	std::size_t capacity = wordsFor(maxWidth) * maxHeight;
+	buffer.reset(new std::uint64_t[capacity]());
+	for (auto &slot : m_slots) {
+		slot.reset(new std::uint64_t[capacity]());
+	}
+	m_slotSequence.fill(0);
+	m_slotTime.fill({});
+	m_slotWidth.fill(width);
+	m_slotHeight.fill(height);
+	m_back = 0;
+	m_middle.store(1);
+	m_front = 2;
+	m_published = 0;
+	m_dirty = false;
 }
 
-std::vector<pixelRGBA_t> Grid::unlocked_getBuffer() const {
-	std::vector<pixelRGBA_t> bufferVector;
-	bufferVector.reserve(width * height);
-	for (std::size_t i = 0; i < width * height; i++) {
-		bufferVector.push_back(buffer[i]);
+bool Grid::setResolution(std::size_t width, std::size_t height) {
+	if (width > m_maxWidth || height > m_maxHeight) {
+		return false;
 	}
-	return bufferVector;
+	if (width != this->width || height != this->height) {
+		// the rows stay packed, only their stride changes
+		this->width = width;
+		this->height = height;
+		wordsPerRow = wordsFor(width);
+	}
+	clear();
+	return true;
 }
 
-pixelRGBA_t Grid::unlocked_getPixel(std::size_t x, std::size_t y) const {
-	if (x < width && y < height) {
-		return buffer[y * width + x];
+std::size_t Grid::getWidth() const { return width; }
+
+std::size_t Grid::getHeight() const { return height; }
+
+std::size_t Grid::getWordsPerRow() const { return wordsPerRow; }
+
+std::size_t Grid::getMaxWidth() const { return m_maxWidth; }
+
+std::size_t Grid::getMaxHeight() const { return m_maxHeight; }
+
+bool Grid::blitRow(std::size_t x, std::size_t y, std::uint64_t pattern,
+                   BlitMode mode) {
+	if (pattern == 0 || width == 0 || height == 0) {
+		return false;
+	}
+	if (mode.edge == BlitMode::Edge::Wrap) {
+		x %= width;
+		y %= height;
+	} else if (x >= width || y >= height) {
+		return false;
+	}
+	bool collision = false;
+	// the pixels past the right edge are dropped or wrapped around
+	std::size_t visible = width - x;
+	if (visible < 64) {
+		if (mode.edge == BlitMode::Edge::Wrap) {
+			collision = blitRow(0, y, pattern << visible, mode);
+		}
+		pattern &= ~std::uint64_t(0) << (64 - visible);
+	}
+	std::uint64_t *row = &buffer[y * wordsPerRow];
+	std::size_t word = x / 64;
+	std::size_t shift = x % 64;
+	std::uint64_t parts[2] = {pattern >> shift, 0};
+	// the pattern may continue in the next word
+	if (shift != 0 && word + 1 < wordsPerRow) {
+		parts[1] = pattern << (64 - shift);
 	}
-	return 0;
+	for (std::size_t i = 0; i < 2 && word + i < wordsPerRow; i++) {
+		collision |= (row[word + i] & parts[i]) != 0;
+		if (mode.op == BlitMode::Op::Xor) {
+			row[word + i] ^= parts[i];
+		} else {
+			row[word + i] |= parts[i];
+		}
+	}
+	return collision;
 }
 
-std::size_t Grid::unlocked_getWidth() const { return width; }
-
-std::size_t Grid::unlocked_getHeight() const { return height; }
+void Grid::publish() {
+	std::copy(buffer.get(), buffer.get() + wordsPerRow * height,
+	          m_slots[m_back].get());
+	m_slotSequence[m_back] = ++m_published;
+	m_slotTime[m_back] = std::chrono::steady_clock::now();
+	m_slotWidth[m_back] = width;
+	m_slotHeight[m_back] = height;
+	m_back = m_middle.exchange(m_back | FRESH, std::memory_order_acq_rel) &
+	         SLOT_MASK;
+	m_dirty = false;
+}
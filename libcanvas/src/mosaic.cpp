@@ -0,0 +1,209 @@
+#include <algorithm>
+#include <assert.h>
+#include <cmath>
+#include <cstddef>
+#include <format>
+#include <iostream>
+#include <string_view>
+
+#include <SDL3/SDL.h>
+#include <SDL3/SDL_error.h>
+
+#include <libcanvas/mosaic.hpp>
+
+Mosaic::Mosaic(std::size_t windowWidth, std::size_t windowHeight)
+    : m_windowWidth(windowWidth), m_windowHeight(windowHeight) {}
+
+[[nodiscard("mosaic initialization check must not be skipped")]]
+bool Mosaic::init(std::string_view title, std::size_t tileCount,
+                  std::size_t tileWidth, std::size_t tileHeight,
+                  std::size_t columns) {
+	assert(tileCount > 0 && tileWidth > 0 && tileHeight > 0);
+	if (!SDL_Init(SDL_INIT_VIDEO)) {
+		std::cout << std::format("Could not initialize SDL graphics:{}\n",
+		                         SDL_GetError());
+		return false;
+	}
+
+	m_window = SDL_CreateWindow(title.data(), m_windowWidth, m_windowHeight,
+	                            SDL_WINDOW_RESIZABLE);
+	if (!m_window) {
+		SDL_Log("Could not create the window: %s", SDL_GetError());
+		SDL_Quit();
+		return false;
+	}
+	m_renderer = SDL_CreateRenderer(m_window, nullptr);
+	if (!m_renderer) {
+		SDL_Log("Could not create the renderer: %s", SDL_GetError());
+		close();
+		return false;
+	}
+
+	m_tileWidth = tileWidth;
+	m_tileHeight = tileHeight;
+	m_columns = columns != 0 ? std::min(columns, tileCount)
+	                         : (std::size_t)std::ceil(
+	                               std::sqrt((double)tileCount));
+	m_rows = (tileCount + m_columns - 1) / m_columns;
+	m_atlasWidth = m_columns * (tileWidth + GAP) - GAP;
+	m_atlasHeight = m_rows * (tileHeight + GAP) - GAP;
+	m_texture = SDL_CreateTexture(m_renderer, SDL_PIXELFORMAT_RGBA8888,
+	                              SDL_TEXTUREACCESS_STATIC, m_atlasWidth,
+	                              m_atlasHeight);
+	if (!m_texture) {
+		SDL_Log("Could not create the atlas texture: %s", SDL_GetError());
+		close();
+		return false;
+	}
+	SDL_SetTextureScaleMode(m_texture, SDL_SCALEMODE_NEAREST);
+	// the renderer scales the atlas to the window, keeping its aspect
+	SDL_SetRenderLogicalPresentation(m_renderer, m_atlasWidth, m_atlasHeight,
+	                                 SDL_LOGICAL_PRESENTATION_LETTERBOX);
+
+	m_tiles.assign(tileCount, Tile{});
+	m_atlas.assign(m_atlasWidth * m_atlasHeight, m_border);
+	m_invalidated = true;
+	return true;
+}
+
+bool Mosaic::setTile(std::size_t tile, Grid::FrameView const &frame) {
+	assert(tile < m_tiles.size());
+	Tile &current = m_tiles[tile];
+	std::size_t words = frame.wordsPerRow * frame.height;
+	if (frame.width == current.width && frame.height == current.height &&
+	    frame.wordsPerRow == current.wordsPerRow &&
+	    std::equal(frame.rows, frame.rows + words, current.rows.begin())) {
+		return false;
+	}
+	current.rows.assign(frame.rows, frame.rows + words);
+	current.width = frame.width;
+	current.height = frame.height;
+	current.wordsPerRow = frame.wordsPerRow;
+	current.dirty = true;
+	return true;
+}
+
+void Mosaic::setPalette(std::size_t tile, Palette palette) {
+	assert(tile < m_tiles.size());
+	Tile &current = m_tiles[tile];
+	if (palette.off != current.palette.off ||
+	    palette.on != current.palette.on) {
+		current.palette = palette;
+		current.dirty = true;
+	}
+}
+
+void Mosaic::setBorder(pixelRGBA_t colour) {
+	m_border = colour;
+	m_invalidated = true;
+}
+
+bool Mosaic::present() {
+	if (m_invalidated) {
+		// the gaps are coloured again too
+		std::fill(m_atlas.begin(), m_atlas.end(), m_border);
+		for (auto &tile : m_tiles) {
+			tile.dirty = true;
+		}
+	}
+	m_uploadedTiles = 0;
+	std::size_t pitch = m_atlasWidth * sizeof(pixelRGBA_t);
+	for (std::size_t row = 0; row < m_rows; row++) {
+		// span of the changed tiles of the row, uploaded at once
+		std::size_t first = m_columns;
+		std::size_t last = 0;
+		for (std::size_t column = 0; column < m_columns; column++) {
+			std::size_t index = row * m_columns + column;
+			if (index >= m_tiles.size() || !m_tiles[index].dirty) {
+				continue;
+			}
+			colourTile(index);
+			m_tiles[index].dirty = false;
+			m_uploadedTiles++;
+			first = std::min(first, column);
+			last = column;
+		}
+		if (first == m_columns || m_invalidated) {
+			continue;
+		}
+		std::size_t x = first * (m_tileWidth + GAP);
+		std::size_t y = row * (m_tileHeight + GAP);
+		SDL_Rect dirty{(int)x, (int)y,
+		               (int)((last - first) * (m_tileWidth + GAP) +
+		                     m_tileWidth),
+		               (int)m_tileHeight};
+		SDL_UpdateTexture(m_texture, &dirty, &m_atlas[y * m_atlasWidth + x],
+		                  pitch);
+	}
+	if (m_invalidated) {
+		SDL_UpdateTexture(m_texture, nullptr, m_atlas.data(), pitch);
+	} else if (m_uploadedTiles == 0) {
+		return false;
+	}
+	m_invalidated = false;
+	// the whole mosaic is a single draw
+	SDL_RenderClear(m_renderer);
+	SDL_RenderTexture(m_renderer, m_texture, nullptr, nullptr);
+	SDL_RenderPresent(m_renderer);
+	return true;
+}
+
+void Mosaic::colourTile(std::size_t index) {
+	Tile &tile = m_tiles[index];
+	pixelRGBA_t *cell =
+	    &m_atlas[(index / m_columns) * (m_tileHeight + GAP) * m_atlasWidth +
+	             (index % m_columns) * (m_tileWidth + GAP)];
+	std::size_t scale = 1;
+	if (tile.width > 0 && tile.height > 0) {
+		scale = std::max<std::size_t>(
+		    1, std::min(m_tileWidth / tile.width, m_tileHeight / tile.height));
+	}
+	std::size_t width = std::min(tile.width * scale, m_tileWidth);
+	std::size_t height = std::min(tile.height * scale, m_tileHeight);
+	if (width < m_tileWidth || height < m_tileHeight) {
+		for (std::size_t y = 0; y < m_tileHeight; y++) {
+			std::fill_n(&cell[y * m_atlasWidth], m_tileWidth, m_border);
+		}
+	}
+	pixelRGBA_t *out = &cell[(m_tileHeight - height) / 2 * m_atlasWidth +
+	                         (m_tileWidth - width) / 2];
+	m_line.resize(tile.width);
+	for (std::size_t y = 0; y < height; y += scale) {
+		tile.palette.expandRow(&tile.rows[y / scale * tile.wordsPerRow],
+		                       tile.width, m_line.data());
+		pixelRGBA_t *line = &out[y * m_atlasWidth];
+		for (std::size_t x = 0; x < width; x++) {
+			line[x] = m_line[x / scale];
+		}
+		// repeat the row for the rest of the scale
+		for (std::size_t copy = 1; copy < scale && y + copy < height;
+		     copy++) {
+			std::copy_n(line, width, &line[copy * m_atlasWidth]);
+		}
+	}
+}
+
+void Mosaic::invalidate() { m_invalidated = true; }
+
+std::size_t Mosaic::getTileCount() const { return m_tiles.size(); }
+
+std::size_t Mosaic::getColumns() const { return m_columns; }
+
+std::size_t Mosaic::getRows() const { return m_rows; }
+
+std::size_t Mosaic::getUploadedTiles() const { return m_uploadedTiles; }
+
+void Mosaic::close() {
+	if (!m_window) {
+		return;
+	}
+	SDL_DestroyTexture(m_texture);
+	SDL_DestroyRenderer(m_renderer);
+	SDL_DestroyWindow(m_window);
+	SDL_Quit();
+	m_texture = nullptr;
+	m_renderer = nullptr;
+	m_window = nullptr;
+}
+
+Mosaic::~Mosaic() { close(); }
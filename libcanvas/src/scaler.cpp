@@ -0,0 +1,193 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <libcanvas/scaler.hpp>
+#include <string>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// fill count pixels with colour, may write up to 3 pixels past count when
+// overrun is true
+void fillPixels(pixelRGBA_t *out, std::size_t count, pixelRGBA_t colour,
+                [[maybe_unused]] bool overrun) {
+	std::size_t i = 0;
+#if defined(__SSE2__)
+	const __m128i wide = _mm_set1_epi32((int)colour);
+	for (; overrun ? i < count : i + 4 <= count; i += 4) {
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), wide);
+	}
+#endif
+	for (; i < count; i++) {
+		out[i] = colour;
+	}
+}
+
+pixelRGBA_t blend(pixelRGBA_t from, pixelRGBA_t to, float amount) {
+	pixelRGBA_t result = 0;
+	for (int shift = 0; shift < 32; shift += 8) {
+		float a = (float)((from >> shift) & 0xFF);
+		float b = (float)((to >> shift) & 0xFF);
+		auto channel = (pixelRGBA_t)std::lround(a + (b - a) * amount);
+		result |= std::min<pixelRGBA_t>(channel, 0xFF) << shift;
+	}
+	return result;
+}
+
+} // namespace
+
+Scaler::Scaler(std::size_t phosphorFrames, float decay)
+    : m_phosphorFrames(0), m_decay(decay) {
+	setPhosphor(phosphorFrames, decay);
+}
+
+void Scaler::setPalette(Palette palette) {
+	m_palette = palette;
+	rebuildLut();
+}
+
+void Scaler::setPhosphor(std::size_t phosphorFrames, float decay) {
+	phosphorFrames = std::clamp<std::size_t>(phosphorFrames, 1,
+	                                         MAX_PHOSPHOR_FRAMES);
+	if (phosphorFrames != m_phosphorFrames) {
+		m_phosphorFrames = phosphorFrames;
+		// start again from an empty history
+		m_history.assign(m_phosphorFrames * m_wordsPerRow * m_height, 0);
+		m_newest = 0;
+	}
+	m_decay = decay;
+	rebuildLut();
+}
+
+std::size_t Scaler::getPhosphorFrames() const { return m_phosphorFrames; }
+
+void Scaler::push(const Grid::FrameView &frame) {
+	std::size_t frameWords = frame.wordsPerRow * frame.height;
+	if (frame.width != m_width || frame.height != m_height ||
+	    frame.wordsPerRow != m_wordsPerRow) {
+		m_width = frame.width;
+		m_height = frame.height;
+		m_wordsPerRow = frame.wordsPerRow;
+		m_history.assign(m_phosphorFrames * frameWords, 0);
+		m_line.resize(m_width);
+		m_newest = 0;
+	}
+	if (frameWords == 0) {
+		return;
+	}
+	m_newest = (m_newest + 1) % m_phosphorFrames;
+	std::copy(frame.rows, frame.rows + frameWords,
+	          &m_history[m_newest * frameWords]);
+}
+
+void Scaler::scaleRows(std::size_t firstRow, std::size_t rowCount,
+                       std::size_t scale, std::uint8_t *out,
+                       std::size_t pitch) const {
+	std::size_t outputWidth = m_width * scale;
+	for (std::size_t row = firstRow;
+	     row < firstRow + rowCount && row < m_height; row++) {
+		auto *target = reinterpret_cast<pixelRGBA_t *>(
+		    out + (row - firstRow) * scale * pitch);
+		if (scale == 1) {
+			colourRow(row, target);
+			continue;
+		}
+		colourRow(row, m_line.data());
+		// widen every pixel, the stores of a pixel may spill into the next
+		// ones which overwrite them, the pixels near the end are exact
+		for (std::size_t x = 0; x < m_width; x++) {
+			fillPixels(target + x * scale, scale, m_line[x],
+			           (x + 1) * scale + 8 <= outputWidth);
+		}
+		// the other lines of the grid row are copies
+		for (std::size_t line = 1; line < scale; line++) {
+			std::memcpy(out + ((row - firstRow) * scale + line) * pitch,
+			            target, outputWidth * sizeof(pixelRGBA_t));
+		}
+	}
+}
+
+std::size_t Scaler::getWidth() const { return m_width; }
+
+std::size_t Scaler::getHeight() const { return m_height; }
+
+void Scaler::writePpm(std::ostream &out, const pixelRGBA_t *pixels,
+                      std::size_t width, std::size_t height) {
+	out << "P6\n" << width << " " << height << "\n255\n";
+	std::string line(width * 3, '\0');
+	for (std::size_t y = 0; y < height; y++) {
+		for (std::size_t x = 0; x < width; x++) {
+			// RGBA8888: red is the most significant byte
+			pixelRGBA_t pixel = pixels[y * width + x];
+			line[x * 3] = (char)(pixel >> 24);
+			line[x * 3 + 1] = (char)(pixel >> 16);
+			line[x * 3 + 2] = (char)(pixel >> 8);
+		}
+		out.write(line.data(), (std::streamsize)line.size());
+	}
+}
+
+void Scaler::rebuildLut() {
+	std::size_t patterns = std::size_t(1) << m_phosphorFrames;
+	m_lut[0] = m_palette.off;
+	for (std::size_t pattern = 1; pattern < patterns; pattern++) {
+		// the most recent frame where the pixel was lit sets its intensity
+		int age = std::countr_zero(pattern);
+		m_lut[pattern] = blend(m_palette.off, m_palette.on,
+		                       std::pow(m_decay, (float)age));
+	}
+}
+
+void Scaler::colourRow(std::size_t row, pixelRGBA_t *out) const {
+	std::size_t frameWords = m_wordsPerRow * m_height;
+	if (m_phosphorFrames == 1) {
+		m_palette.expandRow(&m_history[row * m_wordsPerRow], m_width, out);
+		return;
+	}
+	std::array<const std::uint64_t *, MAX_PHOSPHOR_FRAMES> frames;
+	for (std::size_t age = 0; age < m_phosphorFrames; age++) {
+		std::size_t frame =
+		    (m_newest + m_phosphorFrames - age) % m_phosphorFrames;
+		frames[age] = &m_history[frame * frameWords + row * m_wordsPerRow];
+	}
+	std::size_t x = 0;
+#if defined(__SSE2__)
+	// 16 pixels at a time, byte j holds the history pattern of pixel x + j
+	// - every frame from the oldest doubles the bytes and adds the bit of
+	//   the pixel, so the newest ends in bit 0
+	// - lane j tests bit 7 - j % 8 of the byte of its half
+	const __m128i bits = _mm_set_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4,
+	                                  8, 16, 32, 64, -128);
+	constexpr std::uint64_t BROADCAST = 0x0101010101010101;
+	alignas(16) std::array<std::uint8_t, 16> patterns;
+	for (; x + 16 <= m_width; x += 16) {
+		__m128i pattern = _mm_setzero_si128();
+		for (std::size_t age = m_phosphorFrames; age-- > 0;) {
+			// x is a multiple of 16, the pixels never cross two words
+			std::uint64_t chunk = frames[age][x / 64] >> (48 - x % 64);
+			__m128i bytes =
+			    _mm_set_epi64x((long long)((chunk & 0xFF) * BROADCAST),
+			                   (long long)(((chunk >> 8) & 0xFF) * BROADCAST));
+			__m128i lit = _mm_cmpeq_epi8(_mm_and_si128(bytes, bits), bits);
+			// a lit lane is -1
+			pattern = _mm_sub_epi8(_mm_add_epi8(pattern, pattern), lit);
+		}
+		_mm_store_si128(reinterpret_cast<__m128i *>(patterns.data()),
+		                pattern);
+		for (std::size_t j = 0; j < 16; j++) {
+			out[x + j] = m_lut[patterns[j]];
+		}
+	}
+#endif
+	for (; x < m_width; x++) {
+		std::size_t pattern = 0;
+		for (std::size_t age = 0; age < m_phosphorFrames; age++) {
+			pattern |= ((frames[age][x / 64] >> (63 - x % 64)) & 1) << age;
+		}
+		out[x] = m_lut[pattern];
+	}
+}
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <assert.h>
 #include <cstddef>
 #include <cstring>
@@ -11,18 +12,18 @@
 #include <libcanvas/grid.hpp>
 #include <libcanvas/screen.hpp>
 
-Screen::Screen(std::size_t screenWidth, std::size_t screenHeight)
+Screen::Screen(std::size_t screenWidth, std::size_t screenHeight,
+               PresentMode presentMode)
     : m_window(nullptr), m_renderer(nullptr), m_texture(nullptr),
       m_mainBuffer(nullptr), screenWidth(screenWidth),
-      screenHeight(screenHeight), pixelWidth(screenWidth),
-      pixelHeight(screenHeight), grid(1, 1) {}
+      screenHeight(screenHeight), m_presentMode(presentMode), grid(1, 1) {}
 
 [[nodiscard("screen initialization check must not be skipped")]]
 bool Screen::init(std::string_view title, std::size_t gridWidth,
-                  std::size_t gridHeight) {
-	pixelWidth = screenWidth / gridWidth;
-	pixelHeight = screenHeight / gridHeight;
-
+                  std::size_t gridHeight, std::size_t maxGridWidth,
+                  std::size_t maxGridHeight) {
+	maxGridWidth = std::max(maxGridWidth, gridWidth);
+	maxGridHeight = std::max(maxGridHeight, gridHeight);
 	if (!SDL_Init(SDL_INIT_VIDEO)) {
 		std::cout << std::format("Could not initialize SDL graphics:{}\n",
 		                         SDL_GetError());
@@ -48,9 +49,13 @@ bool Screen::init(std::string_view title, std::size_t gridWidth,
 		return false;
 	}
 
-	m_texture =
-	    SDL_CreateTexture(m_renderer, SDL_PIXELFORMAT_RGBA8888,
-	                      SDL_TEXTUREACCESS_STATIC, screenWidth, screenHeight);
+	// one texel per grid pixel at the largest resolution, the renderer
+	// scales the part used by the current one
+	m_texture = SDL_CreateTexture(m_renderer, SDL_PIXELFORMAT_RGBA8888,
+	                              m_presentMode == PresentMode::Streaming
+	                                  ? SDL_TEXTUREACCESS_STREAMING
+	                                  : SDL_TEXTUREACCESS_STATIC,
+	                              maxGridWidth, maxGridHeight);
 
 	if (!m_texture) {
 		SDL_Log("Could not create the texture. ");
@@ -61,52 +66,202 @@ bool Screen::init(std::string_view title, std::size_t gridWidth,
 		return false;
 	}
 
-	grid.setScreenSize(gridWidth, gridHeight);
-	// initialize the main buffer
-	size_t pixelSize = pixelWidth * pixelHeight;
-	size_t pixelCount = gridWidth * gridHeight;
-	m_mainBuffer.reset(new Uint32[pixelCount * pixelSize]);
+	// keep the pixels square and sharp
+	SDL_SetTextureScaleMode(m_texture, SDL_SCALEMODE_NEAREST);
+
+	grid.setScreenSize(gridWidth, gridHeight, maxGridWidth, maxGridHeight);
+	// initialize the main buffer, one texel per grid pixel
+	if (m_presentMode == PresentMode::Static) {
+		m_mainBuffer.reset(new Uint32[maxGridWidth * maxGridHeight]);
+	}
+	m_presentedRows.assign((maxGridWidth + 63) / 64 * maxGridHeight, 0);
+	m_invalidated = true;
 	return true;
 }
-void Screen::update() {
-	std::vector<pixelRGBA_t> gridBuffer = grid.getBuffer();
-	pixelRGBA_t *mainBuffer = m_mainBuffer.get();
-	assert(mainBuffer);
-	// update the texture with the grid data
-	for (size_t i = 0; i < grid.getWidth(); i++) {
-		for (size_t j = 0; j < grid.getHeight(); j++) {
-			for (size_t k = 0; k < pixelWidth; k++) {
-				for (size_t l = 0; l < pixelHeight; l++) {
-					mainBuffer[(i * pixelWidth + k) +
-					           (j * pixelHeight + l) * screenWidth] =
-					    gridBuffer[i + j * grid.getWidth()];
-				}
-			}
+void Screen::initHeadless(std::size_t gridWidth, std::size_t gridHeight,
+                          std::size_t maxGridWidth,
+                          std::size_t maxGridHeight) {
+	grid.setScreenSize(gridWidth, gridHeight, maxGridWidth, maxGridHeight);
+	m_headless = true;
+}
+
+bool Screen::update() {
+	Grid::FrameView previous = m_frame;
+	m_frame = grid.acquireFrame();
+	if (m_headless) {
+		return false;
+	}
+	if (m_frame.width != previous.width ||
+	    m_frame.height != previous.height) {
+		// the rows changed their stride, nothing shown can be reused
+		m_invalidated = true;
+	}
+	bool phosphor = m_scaler.getPhosphorFrames() > 1;
+	// phosphor trails keep fading for a few presents after the last change
+	bool fading = false;
+	if (m_frame.fresh && phosphor) {
+		m_phosphorPending = m_scaler.getPhosphorFrames() - 1;
+	} else if (!m_frame.fresh && m_phosphorPending > 0) {
+		m_phosphorPending--;
+		fading = true;
+	}
+	if (!m_frame.fresh && !m_invalidated && !fading) {
+		// nothing changed since the last present
+		return false;
+	}
+	m_scaler.push(m_frame);
+	std::size_t wordsPerRow = m_frame.wordsPerRow;
+	// find the rows that changed since the last present
+	std::size_t firstDirty = m_frame.height;
+	std::size_t lastDirty = 0;
+	for (std::size_t j = 0; j < m_frame.height; j++) {
+		const std::uint64_t *row = &m_frame.rows[j * wordsPerRow];
+		std::uint64_t *presented = &m_presentedRows[j * wordsPerRow];
+		if (m_invalidated || phosphor ||
+		    !std::equal(row, row + wordsPerRow, presented)) {
+			std::copy(row, row + wordsPerRow, presented);
+			firstDirty = std::min(firstDirty, j);
+			lastDirty = j;
 		}
 	}
+	if (firstDirty == m_frame.height && !m_invalidated) {
+		// the frame was redrawn with the same content
+		return false;
+	}
+	m_invalidated = false;
 
-	SDL_UpdateTexture(m_texture, nullptr, m_mainBuffer.get(),
-	                  screenWidth * sizeof(Uint32));
+	if (firstDirty < m_frame.height) {
+		if (m_presentMode == PresentMode::Streaming) {
+			uploadStreaming(firstDirty, lastDirty - firstDirty + 1);
+		} else {
+			uploadStatic(firstDirty, lastDirty - firstDirty + 1);
+		}
+	}
+	// only the top left of the texture is used below the largest resolution
+	SDL_FRect source{0, 0, (float)m_frame.width, (float)m_frame.height};
 	SDL_RenderClear(m_renderer);
-	SDL_RenderTexture(m_renderer, m_texture, nullptr, nullptr);
+	SDL_RenderTexture(m_renderer, m_texture, &source, nullptr);
 	SDL_RenderPresent(m_renderer);
+	return true;
+}
+
+void Screen::uploadStatic(std::size_t firstRow, std::size_t rowCount) {
+	// colour the dirty rows through the palette and upload only them
+	pixelRGBA_t *mainBuffer = m_mainBuffer.get();
+	assert(mainBuffer);
+	std::size_t width = m_frame.width;
+	m_scaler.scaleRows(firstRow, rowCount, 1,
+	                   reinterpret_cast<std::uint8_t *>(
+	                       &mainBuffer[firstRow * width]),
+	                   width * sizeof(pixelRGBA_t));
+	SDL_Rect dirty{0, (int)firstRow, (int)width, (int)rowCount};
+	SDL_UpdateTexture(m_texture, &dirty, &mainBuffer[firstRow * width],
+	                  width * sizeof(Uint32));
+}
+
+void Screen::uploadStreaming(std::size_t firstRow, std::size_t rowCount) {
+	SDL_Rect dirty{0, (int)firstRow, (int)m_frame.width, (int)rowCount};
+	void *pixels = nullptr;
+	int pitch = 0;
+	if (!SDL_LockTexture(m_texture, &dirty, &pixels, &pitch)) {
+		SDL_Log("Could not lock the texture: %s", SDL_GetError());
+		return;
+	}
+	// the locked memory is write only, every row of the rect is written
+	m_scaler.scaleRows(firstRow, rowCount, 1,
+	                   static_cast<std::uint8_t *>(pixels), pitch);
+	SDL_UnlockTexture(m_texture);
+}
+
+void Screen::invalidate() { m_invalidated = true; }
+
+void Screen::setPhosphor(std::size_t frames, float decay) {
+	m_scaler.setPhosphor(frames, decay);
+	m_phosphorPending = 0;
+	m_invalidated = true;
+}
+
+void Screen::writeScreenshot(std::ostream &out, std::size_t scale) {
+	std::size_t width = m_scaler.getWidth() * scale;
+	std::size_t height = m_scaler.getHeight() * scale;
+	std::vector<pixelRGBA_t> pixels(width * height);
+	m_scaler.scaleRows(0, m_scaler.getHeight(), scale,
+	                   reinterpret_cast<std::uint8_t *>(pixels.data()),
+	                   width * sizeof(pixelRGBA_t));
+	Scaler::writePpm(out, pixels.data(), width, height);
+}
+
+PresentMode Screen::getPresentMode() const { return m_presentMode; }
+
+bool Screen::setVSync(bool enabled) {
+	if (!SDL_SetRenderVSync(m_renderer, enabled ? 1 : 0)) {
+		SDL_Log("Could not set the vsync: %s", SDL_GetError());
+		return false;
+	}
+	return true;
+}
+
+float Screen::getRefreshRate() const {
+	const SDL_DisplayMode *mode =
+	    SDL_GetCurrentDisplayMode(SDL_GetDisplayForWindow(m_window));
+	return mode ? mode->refresh_rate : 0.0f;
 }
 
 void Screen::setPixel(std::size_t x, std::size_t y, pixelRGBA_t color) {
-	grid.setPixel(x, y, color);
+	grid.setPixel(x, y, color != 0);
 }
 
 pixelRGBA_t Screen::getPixel(std::size_t x, std::size_t y) {
-	return grid.getPixel(x, y);
+	return m_palette(grid.getPixel(x, y));
 }
 
+bool Screen::blitSprite(std::size_t x, std::size_t y,
+                        std::span<const std::byte> sprite, BlitMode mode,
+                        std::size_t width) {
+	return grid.blitSprite(x, y, sprite, mode, width);
+}
+
+void Screen::scrollDown(std::size_t rows) { grid.scrollDown(rows); }
+
+void Screen::scrollLeft(std::size_t columns) { grid.scrollLeft(columns); }
+
+void Screen::scrollRight(std::size_t columns) { grid.scrollRight(columns); }
+
+bool Screen::setResolution(std::size_t gridWidth, std::size_t gridHeight) {
+	return grid.setResolution(gridWidth, gridHeight);
+}
+
+Grid::FrameView Screen::getFrame() const { return m_frame; }
+
+std::size_t Screen::getGridWordsPerRow() { return grid.getWordsPerRow(); }
+
+void Screen::setPalette(Palette palette) {
+	m_palette = palette;
+	m_scaler.setPalette(palette);
+	// every row has to be coloured again
+	m_invalidated = true;
+}
+
+Palette Screen::getPalette() const { return m_palette; }
+
 std::size_t Screen::getGridWidth() { return grid.getWidth(); }
 
 std::size_t Screen::getGridHeight() { return grid.getHeight(); }
 
 void Screen::clear() { grid.clear(); }
 
+void Screen::setRows(std::span<const std::uint64_t> rows) {
+	grid.setRows(rows);
+}
+
+void Screen::poll() { grid.poll(); }
+
+void Screen::flush() { grid.flush(); }
+
 void Screen::close() {
+	if (m_headless) {
+		return;
+	}
 	SDL_DestroyTexture(m_texture);
 	SDL_DestroyRenderer(m_renderer);
 	SDL_DestroyWindow(m_window);